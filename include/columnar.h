@@ -0,0 +1,113 @@
+#ifndef include_columnar_h
+#define include_columnar_h
+
+#include "simd.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/*
+Runs the kernels of simd.h directly on columns in the Apache Arrow layout,
+without copying them into a std::vector: a values buffer, an optional
+validity bitmap, and an offset and a length into both. Arrow arrays reach
+this header through the Arrow C data interface, whose two structs are
+declared below as the Arrow specification gives them, so nothing here
+needs the Arrow libraries. Arrays read from Parquet by Arrow have the same
+layout.
+
+Arrow buffers are 64-byte aligned and padded to a multiple of 64 bytes. The
+kernels need neither, and read no element beyond offset + length.
+*/
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+  const char *format;
+  const char *name;
+  const char *metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema **children;
+  struct ArrowSchema *dictionary;
+  void (*release)(struct ArrowSchema *);
+  void *private_data;
+};
+
+struct ArrowArray {
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void **buffers;
+  struct ArrowArray **children;
+  struct ArrowArray *dictionary;
+  void (*release)(struct ArrowArray *);
+  void *private_data;
+};
+#endif
+
+// Arrow C data interface format string of the element types of the kernels
+template <typename T> struct ArrowFormat;
+template <> struct ArrowFormat<float> {
+  static constexpr const char *value = "f";
+};
+template <> struct ArrowFormat<int> {
+  static constexpr const char *value = "i";
+};
+
+/*
+A column of Arrow primitive type, viewed without copying: "values" points to
+the first element of the column (the values buffer plus the offset), and
+element i is valid when bit validity_offset + i of "validity" is set. A
+null validity means that there are no nulls.
+*/
+template <typename T> struct ColumnView {
+  T const *values = nullptr;
+  uint8_t const *validity = nullptr;
+  size_t validity_offset = 0;
+  size_t length = 0;
+};
+
+/*
+Views the array of the C data interface described by schema. Returns false,
+and leaves view alone, if the array has been released or is not a
+primitive array of T.
+*/
+template <typename T>
+static inline bool columnView(ArrowSchema const &schema,
+                              ArrowArray const &array,
+                              ColumnView<T> *const view) {
+  if (array.release == nullptr || schema.format == nullptr ||
+      std::strcmp(schema.format, ArrowFormat<T>::value) != 0 ||
+      array.n_buffers != 2 || array.length < 0 || array.offset < 0) {
+    return false;
+  }
+  size_t offset = array.offset;
+  view->values = static_cast<T const *>(array.buffers[1]) + offset;
+  // The bitmap may be left out, and may be ignored, when nothing is null
+  view->validity = array.null_count == 0
+                       ? nullptr
+                       : static_cast<uint8_t const *>(array.buffers[0]);
+  view->validity_offset = offset;
+  view->length = array.length;
+  return true;
+}
+
+/*
+Min-max of the valid elements of a float column, with the vector width of
+minMaxAuto; see minMaxMaskedVec for the treatment of nulls and NaNs.
+*/
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxColumn(ColumnView<float> const &column, float *const min,
+                         float *const max, size_t *const nan_count = nullptr) {
+  minMaxMaskedVec<minMaxAutoWidth, policy>(column.values, column.validity,
+                                           column.length, min, max, nan_count,
+                                           column.validity_offset);
+}
+
+#endif
@@ -1,12 +1,26 @@
 #ifndef include_helpers_hpp
 #define include_helpers_hpp
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <random>
+#include <string>
 #include <vector>
 
+#include <unistd.h>
+
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
 #define MAXGENRAND 0x100000000 // 2^32
 
 template <typename T> class Timer {
@@ -64,6 +78,299 @@ std::vector<T> generateSequentialData(const size_t arrSize, T start, T diff) {
   return arr;
 }
 
+// A new empty file in $TMPDIR (or /tmp), its descriptor and path
+inline int makeTempFile(std::string *path) {
+  const char *dir = std::getenv("TMPDIR");
+  *path = std::string(dir != nullptr ? dir : "/tmp") + "/simd.XXXXXX";
+  int fd = mkstemp(&(*path)[0]);
+  if (fd < 0) {
+    std::perror(path->c_str());
+    std::exit(1);
+  }
+  return fd;
+}
+
+/*
+Writes the N elements of arr, followed by extra_bytes filler bytes, to a new
+temporary file and returns its path, for the benchmarks that read files.
+*/
+template <typename T>
+std::string writeTempFile(const T *arr, size_t N, size_t extra_bytes = 0) {
+  std::string path;
+  FILE *file = fdopen(makeTempFile(&path), "wb");
+  std::vector<char> extra(extra_bytes, 1);
+  // fwrite may not be passed the null data of an empty vector
+  bool ok = file != nullptr &&
+            (N == 0 || fwrite(arr, sizeof(T), N, file) == N) &&
+            (extra_bytes == 0 ||
+             fwrite(extra.data(), 1, extra_bytes, file) == extra_bytes);
+  if (file == nullptr || fclose(file) != 0 || !ok) {
+    std::perror(path.c_str());
+    std::exit(1);
+  }
+  return path;
+}
+
+/*
+How two floats are compared by the verification helpers.
+
+Exact    : the bit patterns are equal, so -0 and +0 differ. Any two NaNs are
+           considered equal.
+Ulp      : at most max_ulps representable floats apart. -0 and +0 are 0 ULPs
+           apart, NaN only matches NaN.
+Relative : |expected - actual| <= abs_tol + rel_tol * max(|expected|,
+           |actual|). abs_tol keeps the check meaningful around zero. Equal
+           infinities match, NaN only matches NaN.
+*/
+struct FloatCheck {
+  enum Mode { Exact, Ulp, Relative };
+
+  Mode mode;
+  uint32_t max_ulps;
+  float rel_tol;
+  float abs_tol;
+
+  static FloatCheck exact() { return {Exact, 0, 0.0f, 0.0f}; }
+
+  static FloatCheck ulps(uint32_t max_ulps) {
+    return {Ulp, max_ulps, 0.0f, 0.0f};
+  }
+
+  static FloatCheck relative(float rel_tol, float abs_tol = 0.0f) {
+    return {Relative, 0, rel_tol, abs_tol};
+  }
+};
+
+/*
+Maps a float onto an integer that increases by one from each float to the
+next larger one, with -0 and +0 both mapping to 0.
+*/
+inline int32_t floatOrdinal(float x) {
+  int32_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  return bits < 0 ? INT32_MIN - bits : bits;
+}
+
+// Number of representable floats between two non-NaN floats
+inline uint32_t ulpDistance(float a, float b) {
+  uint32_t ua = static_cast<uint32_t>(floatOrdinal(a));
+  uint32_t ub = static_cast<uint32_t>(floatOrdinal(b));
+  return floatOrdinal(a) > floatOrdinal(b) ? ua - ub : ub - ua;
+}
+
+/*
+Element predicates for each FloatCheck mode. They are written without
+branches (bitwise & and | on bools) so that the block loop in
+scanMismatch vectorizes.
+*/
+struct ExactEqual {
+  bool operator()(float expected, float actual) const {
+    uint32_t e, a;
+    std::memcpy(&e, &expected, sizeof(e));
+    std::memcpy(&a, &actual, sizeof(a));
+    return (e == a) | ((expected != expected) & (actual != actual));
+  }
+  bool operator()(int expected, int actual) const {
+    return expected == actual;
+  }
+};
+
+struct UlpEqual {
+  uint32_t max_ulps;
+
+  bool operator()(float expected, float actual) const {
+    bool e_nan = expected != expected;
+    bool a_nan = actual != actual;
+    return (e_nan & a_nan) |
+           (!e_nan & !a_nan & (ulpDistance(expected, actual) <= max_ulps));
+  }
+};
+
+struct RelativeEqual {
+  float rel_tol;
+  float abs_tol;
+
+  bool operator()(float expected, float actual) const {
+    float diff = std::fabs(expected - actual);
+    float scale = std::max(std::fabs(expected), std::fabs(actual));
+    // With an infinity the difference and the tolerance are both infinite,
+    // so only a finite difference may be within the tolerance
+    return (expected == actual) |
+           ((expected != expected) & (actual != actual)) |
+           ((diff <= std::numeric_limits<float>::max()) &
+            (diff <= abs_tol + rel_tol * scale));
+  }
+};
+
+inline bool floatEqual(float expected, float actual, FloatCheck check) {
+  switch (check.mode) {
+  case FloatCheck::Ulp:
+    return UlpEqual{check.max_ulps}(expected, actual);
+  case FloatCheck::Relative:
+    return RelativeEqual{check.rel_tol, check.abs_tol}(expected, actual);
+  default:
+    return ExactEqual{}(expected, actual);
+  }
+}
+
+/*
+Index of the first i in [begin, end) for which equal(expected[i], actual[i])
+is false, or end when the ranges match.
+The range is checked in blocks: a branch-free pass counts mismatches in a
+block, and only a block with a mismatch is rescanned to locate it. This keeps
+the common all-match case a vectorized streaming loop.
+*/
+template <typename T, typename Equal>
+size_t scanMismatch(const T *expected, const T *actual, size_t begin,
+                    size_t end, Equal equal) {
+  const size_t block = 4096;
+
+  for (size_t block_begin = begin; block_begin < end; block_begin += block) {
+    size_t block_end = std::min(block_begin + block, end);
+
+    unsigned mismatches = 0;
+    for (size_t i = block_begin; i < block_end; i++) {
+      mismatches += !equal(expected[i], actual[i]);
+    }
+
+    if (mismatches != 0) {
+      for (size_t i = block_begin; i < block_end; i++) {
+        if (!equal(expected[i], actual[i])) {
+          return i;
+        }
+      }
+    }
+  }
+  return end;
+}
+
+/*
+memcmp for 32-bit words that reports where the ranges differ: index of the
+first i in [begin, end) with a[i] != b[i], or end. Four vectors are compared
+per iteration and tested with a single branch.
+*/
+inline size_t scanDifferentWord(const uint32_t *a, const uint32_t *b,
+                                size_t begin, size_t end) {
+  size_t i = begin;
+#if defined(__AVX2__)
+  const size_t step = 32;
+  for (; i + step <= end; i += step) {
+    __m256i diff = _mm256_setzero_si256();
+    for (size_t j = 0; j < step; j += 8) {
+      __m256i va =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i + j));
+      __m256i vb =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i + j));
+      diff = _mm256_or_si256(diff, _mm256_xor_si256(va, vb));
+    }
+    if (!_mm256_testz_si256(diff, diff)) {
+      break;
+    }
+  }
+#elif defined(__SSE2__)
+  const size_t step = 16;
+  for (; i + step <= end; i += step) {
+    __m128i diff = _mm_setzero_si128();
+    for (size_t j = 0; j < step; j += 4) {
+      __m128i va =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i + j));
+      __m128i vb =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i + j));
+      diff = _mm_or_si128(diff, _mm_xor_si128(va, vb));
+    }
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(diff, _mm_setzero_si128())) !=
+        0xFFFF) {
+      break;
+    }
+  }
+#endif
+  // Locates the difference within the last group, and handles the remainder
+  for (; i < end; i++) {
+    if (a[i] != b[i]) {
+      return i;
+    }
+  }
+  return end;
+}
+
+/*
+Runs scan(begin, end), which returns the first mismatch in [begin, end) or
+end, over chunks of [0, N) on all threads and returns the smallest mismatch
+found, or N. With a static schedule each thread visits its chunks in order,
+so it stops scanning once it has found a mismatch.
+*/
+template <typename Scan> size_t parallelFirstMismatch(size_t N, Scan scan) {
+  const size_t chunk = 1 << 20;
+  const size_t chunks = (N + chunk - 1) / chunk;
+  size_t first = N;
+
+#pragma omp parallel for schedule(static) reduction(min : first)
+  for (size_t c = 0; c < chunks; c++) {
+    size_t begin = c * chunk;
+    if (first < begin) {
+      continue;
+    }
+    size_t end = std::min(begin + chunk, N);
+    size_t i = scan(begin, end);
+    if (i < end && i < first) {
+      first = i;
+    }
+  }
+  return first;
+}
+
+// Index of the first i with !equal(expected[i], actual[i]), or N
+template <typename T, typename Equal>
+size_t findFirstMismatch(const T *expected, const T *actual, size_t N,
+                         Equal equal) {
+  return parallelFirstMismatch(N, [=](size_t begin, size_t end) {
+    return scanMismatch(expected, actual, begin, end, equal);
+  });
+}
+
+/*
+Exact comparison compares bit patterns with scanDifferentWord and only looks
+at the values where the bits differ, to let two NaNs match.
+*/
+inline size_t findFirstMismatch(const float *expected, const float *actual,
+                                size_t N, ExactEqual equal) {
+  const uint32_t *e = reinterpret_cast<const uint32_t *>(expected);
+  const uint32_t *a = reinterpret_cast<const uint32_t *>(actual);
+
+  return parallelFirstMismatch(N, [=](size_t begin, size_t end) {
+    for (size_t i = scanDifferentWord(e, a, begin, end); i < end;
+         i = scanDifferentWord(e, a, i + 1, end)) {
+      if (!equal(expected[i], actual[i])) {
+        return i;
+      }
+    }
+    return end;
+  });
+}
+
+inline size_t findFirstMismatch(const float *expected, const float *actual,
+                                size_t N, FloatCheck check) {
+  switch (check.mode) {
+  case FloatCheck::Ulp:
+    return findFirstMismatch(expected, actual, N, UlpEqual{check.max_ulps});
+  case FloatCheck::Relative:
+    return findFirstMismatch(expected, actual, N,
+                             RelativeEqual{check.rel_tol, check.abs_tol});
+  default:
+    return findFirstMismatch(expected, actual, N, ExactEqual{});
+  }
+}
+
+inline size_t findFirstMismatch(const int *expected, const int *actual,
+                                size_t N) {
+  const uint32_t *e = reinterpret_cast<const uint32_t *>(expected);
+  const uint32_t *a = reinterpret_cast<const uint32_t *>(actual);
+
+  return parallelFirstMismatch(N, [=](size_t begin, size_t end) {
+    return scanDifferentWord(e, a, begin, end);
+  });
+}
+
 void assertInt(size_t expected, size_t actual, std::string str) {
   if (expected != actual) {
     std::cerr << str << " expected: " << expected << " actual: " << actual
@@ -72,13 +379,45 @@ void assertInt(size_t expected, size_t actual, std::string str) {
   }
 }
 
-void assertFloat(float expected, float actual, std::string str) {
-  float diff = fabs(expected - actual);
-  float loss = (diff / expected) * 100;
-  if (loss > 0.1) {
+void assertInt(int64_t expected, int64_t actual, std::string str) {
+  if (expected != actual) {
     std::cerr << str << " expected: " << expected << " actual: " << actual
-              << " loss: " << loss << std::endl;
-    assert(loss < 0.1);
+              << std::endl;
+    assert(expected == actual);
+  }
+}
+
+// The default check accepts a relative error of 0.1%
+void assertFloat(float expected, float actual, std::string str,
+                 FloatCheck check = FloatCheck::relative(1e-3f)) {
+  if (!floatEqual(expected, actual, check)) {
+    std::cerr << str << " expected: " << expected << " actual: " << actual;
+    if (check.mode == FloatCheck::Ulp) {
+      std::cerr << " ulps: " << ulpDistance(expected, actual);
+    }
+    std::cerr << std::endl;
+    assert(floatEqual(expected, actual, check));
+  }
+}
+
+// Checks that two int arrays of length N are identical
+void assertArray(const int *expected, const int *actual, size_t N,
+                 std::string str) {
+  size_t i = findFirstMismatch(expected, actual, N);
+  if (i != N) {
+    std::cerr << str << " index: " << i << " expected: " << expected[i]
+              << " actual: " << actual[i] << std::endl;
+    assert(i == N);
+  }
+}
+
+// Checks that two float arrays of length N match according to check
+void assertArray(const float *expected, const float *actual, size_t N,
+                 FloatCheck check, std::string str) {
+  size_t i = findFirstMismatch(expected, actual, N, check);
+  if (i != N) {
+    std::cerr << str << " index: " << i;
+    assertFloat(expected[i], actual[i], "", check);
   }
 }
 
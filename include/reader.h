@@ -0,0 +1,587 @@
+#ifndef include_reader_h
+#define include_reader_h
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// io_uring is driven through the raw system calls, so liburing is not needed
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define READER_IO_URING
+#endif
+#endif
+#endif
+
+/*
+How ChunkReader reads the file.
+
+Auto    : IoUring for a regular file where the kernel supports it, else
+          Pread, or Read when the file cannot be seeked (a pipe, stdin).
+IoUring : up to one read per buffer is queued in an io_uring, and a buffer is
+          queued again as soon as the caller is done with its chunk.
+Pread   : a thread fills the free buffers with pread while the caller works
+          on the filled ones.
+Read    : as Pread with read, from the current position of the descriptor.
+
+A method the file or the kernel does not support falls back to the next one.
+*/
+enum class ReadMethod { Auto, IoUring, Pread, Read };
+
+static inline const char *readMethodName(ReadMethod method) {
+  switch (method) {
+  case ReadMethod::IoUring:
+    return "io_uring";
+  case ReadMethod::Pread:
+    return "pread";
+  case ReadMethod::Read:
+    return "read";
+  default:
+    return "auto";
+  }
+}
+
+// Alignment of the buffers and granularity of the chunk size, one page
+static const size_t readerAlignment = 4096;
+
+/*
+Reads "bytes" bytes from fd at offset, or from its current position when
+offset is negative, retrying short reads. Returns the number of bytes read,
+which is less than "bytes" only at the end of the file, or -1 with errno set.
+*/
+static inline ptrdiff_t readFull(int const fd, char *const buffer,
+                                 size_t const bytes, off_t const offset) {
+  size_t done = 0;
+  while (done < bytes) {
+    ssize_t n = offset < 0 ? read(fd, buffer + done, bytes - done)
+                           : pread(fd, buffer + done, bytes - done,
+                                   offset + off_t(done));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      return -1;
+    }
+    if (n == 0) {
+      break;
+    }
+    done += n;
+  }
+  return done;
+}
+
+// Writes "bytes" bytes to fd, retrying short writes
+static inline bool writeAll(int const fd, const void *const data,
+                            size_t bytes) {
+  const char *p = static_cast<const char *>(data);
+  while (bytes > 0) {
+    ssize_t n = write(fd, p, bytes);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      return false;
+    }
+    p += n;
+    bytes -= n;
+  }
+  return true;
+}
+
+/*
+Reads a file front to back in chunks into a ring of "buffers" aligned
+buffers, so that the next chunks are read while the caller processes the
+current one:
+
+  ChunkReader reader(fd, 64 << 20);
+  const char *data;
+  while (size_t bytes = reader.next(&data)) {
+    process(data, bytes);
+  }
+  if (reader.error()) ...
+
+Every chunk but the last holds exactly the chunk size, which is rounded up
+to a multiple of readerAlignment, so a chunk never splits an element of a
+power-of-two size. A chunk stays valid until the next call to next(), which
+hands its buffer back to the reads. With drop_cache the pages of the chunks
+already processed are dropped from the page cache, so that scanning a file
+bigger than RAM does not evict everything else.
+*/
+class ChunkReader {
+  int fd;
+  size_t chunk;
+  ReadMethod method_;
+  bool drop_cache;
+  int error_ = 0;
+
+  std::vector<char *> buffers;
+  std::vector<size_t> lengths;
+  // First offset of the file to read, -1 for Read
+  off_t base = 0;
+  // The chunk next() returns next and the number of chunks, once known
+  size_t next_chunk = 0;
+  size_t chunks = SIZE_MAX;
+  // The buffer of the chunk the caller holds, or -1
+  int held = -1;
+
+  // Pread and Read: the I/O thread and the state of each buffer
+  std::thread io;
+  std::mutex m;
+  std::condition_variable cv;
+  std::vector<bool> filled;
+  bool stop = false;
+
+  void ioLoop() {
+    size_t const n_buffers = buffers.size();
+    for (size_t k = 0;; k++) {
+      size_t slot = k % n_buffers;
+      {
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [&] { return stop || !filled[slot]; });
+        if (stop) {
+          return;
+        }
+      }
+
+      off_t offset = base < 0 ? -1 : base + off_t(k * chunk);
+      ptrdiff_t n = readFull(fd, buffers[slot], chunk, offset);
+
+      std::lock_guard<std::mutex> lock(m);
+      if (n < 0) {
+        error_ = errno;
+        chunks = k;
+      } else {
+        lengths[slot] = n;
+        filled[slot] = n > 0;
+        if (size_t(n) < chunk) {
+          chunks = k + (n > 0);
+        }
+      }
+      cv.notify_all();
+      if (chunks != SIZE_MAX) {
+        return;
+      }
+    }
+  }
+
+  size_t nextThreaded(const char **data) {
+    std::unique_lock<std::mutex> lock(m);
+    if (held >= 0) {
+      filled[held] = false;
+      held = -1;
+      cv.notify_all();
+    }
+    size_t slot = next_chunk % buffers.size();
+    cv.wait(lock, [&] { return filled[slot] || next_chunk >= chunks; });
+    if (!filled[slot]) {
+      return 0;
+    }
+    held = slot;
+    *data = buffers[slot];
+    return lengths[slot];
+  }
+
+#ifdef READER_IO_URING
+  // IoUring: the rings shared with the kernel
+  int ring_fd = -1;
+  void *sq_ring = MAP_FAILED, *cq_ring = MAP_FAILED;
+  size_t sq_ring_bytes = 0, cq_ring_bytes = 0;
+  io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+  size_t sqes_bytes = 0;
+  unsigned *sq_tail, *sq_mask, *sq_array;
+  unsigned *cq_head, *cq_tail, *cq_mask;
+  io_uring_cqe *cqes;
+  std::vector<iovec> iovecs;
+  // The chunks queued so far, and those whose completion is not yet reaped
+  size_t issued = 0;
+  size_t in_flight = 0;
+  // Completion result of each buffer, -1 while its read is queued
+  std::vector<ptrdiff_t> results;
+
+  template <typename T> static T *at(void *ring, unsigned offset) {
+    return reinterpret_cast<T *>(static_cast<char *>(ring) + offset);
+  }
+
+  bool setupRing(off_t size) {
+    io_uring_params p;
+    std::memset(&p, 0, sizeof(p));
+    ring_fd = syscall(__NR_io_uring_setup, unsigned(buffers.size()), &p);
+    if (ring_fd < 0) {
+      return false;
+    }
+
+    sq_ring_bytes = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_ring_bytes = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+      sq_ring_bytes = cq_ring_bytes = std::max(sq_ring_bytes, cq_ring_bytes);
+    }
+    sq_ring = mmap(nullptr, sq_ring_bytes, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) {
+      return false;
+    }
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+      cq_ring = sq_ring;
+    } else {
+      cq_ring = mmap(nullptr, cq_ring_bytes, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+      if (cq_ring == MAP_FAILED) {
+        return false;
+      }
+    }
+    sqes_bytes = p.sq_entries * sizeof(io_uring_sqe);
+    void *sqes_map = mmap(nullptr, sqes_bytes, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+    if (sqes_map == MAP_FAILED) {
+      return false;
+    }
+    sqes = static_cast<io_uring_sqe *>(sqes_map);
+
+    sq_tail = at<unsigned>(sq_ring, p.sq_off.tail);
+    sq_mask = at<unsigned>(sq_ring, p.sq_off.ring_mask);
+    sq_array = at<unsigned>(sq_ring, p.sq_off.array);
+    cq_head = at<unsigned>(cq_ring, p.cq_off.head);
+    cq_tail = at<unsigned>(cq_ring, p.cq_off.tail);
+    cq_mask = at<unsigned>(cq_ring, p.cq_off.ring_mask);
+    cqes = at<io_uring_cqe>(cq_ring, p.cq_off.cqes);
+
+    chunks = (size - base + chunk - 1) / chunk;
+    iovecs.resize(buffers.size());
+    results.assign(buffers.size(), -1);
+    while (issued < std::min(chunks, buffers.size())) {
+      if (!submit(issued % buffers.size())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void teardownRing() {
+    // The kernel may still write to the buffers of the queued reads
+    while (in_flight > 0 && reap()) {
+    }
+    if (sqes != MAP_FAILED) {
+      munmap(sqes, sqes_bytes);
+    }
+    if (cq_ring != MAP_FAILED && cq_ring != sq_ring) {
+      munmap(cq_ring, cq_ring_bytes);
+    }
+    if (sq_ring != MAP_FAILED) {
+      munmap(sq_ring, sq_ring_bytes);
+    }
+    if (ring_fd >= 0) {
+      close(ring_fd);
+    }
+  }
+
+  // Queues the read of chunk "issued" into buffer slot
+  bool submit(size_t slot) {
+    iovecs[slot] = {buffers[slot], chunk};
+    results[slot] = -1;
+
+    unsigned tail = *sq_tail;
+    unsigned index = tail & *sq_mask;
+    io_uring_sqe *sqe = &sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->off = base + issued * chunk;
+    sqe->addr = reinterpret_cast<uintptr_t>(&iovecs[slot]);
+    sqe->len = 1;
+    sqe->user_data = slot;
+    sq_array[index] = index;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    while (syscall(__NR_io_uring_enter, ring_fd, 1, 0, 0, nullptr, 0) < 0) {
+      if (errno != EINTR) {
+        return false;
+      }
+    }
+    issued++;
+    in_flight++;
+    return true;
+  }
+
+  // Waits for one completion and records its result
+  bool reap() {
+    unsigned head = *cq_head;
+    while (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+      if (syscall(__NR_io_uring_enter, ring_fd, 0, 1, IORING_ENTER_GETEVENTS,
+                  nullptr, 0) < 0 &&
+          errno != EINTR) {
+        return false;
+      }
+    }
+    io_uring_cqe *cqe = &cqes[head & *cq_mask];
+    results[cqe->user_data] = cqe->res < 0 ? -1 - ptrdiff_t(-cqe->res)
+                                           : ptrdiff_t(cqe->res);
+    __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+    in_flight--;
+    return true;
+  }
+
+  size_t nextRing(const char **data) {
+    if (held >= 0) {
+      if (issued < chunks && !submit(held)) {
+        error_ = errno;
+        chunks = next_chunk;
+      }
+      held = -1;
+    }
+    if (next_chunk >= chunks) {
+      return 0;
+    }
+
+    size_t slot = next_chunk % buffers.size();
+    while (results[slot] == -1) {
+      if (!reap()) {
+        error_ = errno;
+        chunks = next_chunk;
+        return 0;
+      }
+    }
+    if (results[slot] < -1) {
+      error_ = -1 - results[slot];
+      chunks = next_chunk;
+      return 0;
+    }
+
+    // A read may come back short before the end of the file
+    size_t length = results[slot];
+    off_t offset = base + next_chunk * chunk;
+    if (length < chunk) {
+      ptrdiff_t rest = readFull(fd, buffers[slot] + length, chunk - length,
+                                offset + length);
+      if (rest < 0) {
+        error_ = errno;
+        chunks = next_chunk;
+        return 0;
+      }
+      length += rest;
+    }
+    if (length == 0) {
+      chunks = next_chunk;
+      return 0;
+    }
+    held = slot;
+    *data = buffers[slot];
+    return length;
+  }
+#endif
+
+public:
+  ChunkReader(int const fd, size_t const chunk_bytes, int const n_buffers = 3,
+              ReadMethod const method = ReadMethod::Auto,
+              bool const drop_cache = false)
+      : fd(fd), method_(method), drop_cache(drop_cache) {
+    chunk = std::max(chunk_bytes + readerAlignment - 1, readerAlignment) /
+            readerAlignment * readerAlignment;
+    for (int b = 0; b < std::max(n_buffers, 2); b++) {
+      buffers.push_back(
+          static_cast<char *>(std::aligned_alloc(readerAlignment, chunk)));
+    }
+    lengths.assign(buffers.size(), 0);
+    filled.assign(buffers.size(), false);
+
+    struct stat st;
+    base = lseek(fd, 0, SEEK_CUR);
+    bool regular = fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && base >= 0;
+    if (!regular) {
+      base = -1;
+      method_ = ReadMethod::Read;
+    } else {
+      posix_fadvise(fd, base, 0, POSIX_FADV_SEQUENTIAL);
+      if (method_ == ReadMethod::Auto) {
+        method_ = ReadMethod::IoUring;
+      }
+      if (method_ == ReadMethod::Read) {
+        base = -1;
+      }
+    }
+
+    if (method_ == ReadMethod::IoUring) {
+#ifdef READER_IO_URING
+      if (setupRing(st.st_size)) {
+        return;
+      }
+      teardownRing();
+      ring_fd = -1;
+      sq_ring = cq_ring = MAP_FAILED;
+      sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+      issued = in_flight = 0;
+      chunks = SIZE_MAX;
+#endif
+      method_ = ReadMethod::Pread;
+    }
+    io = std::thread(&ChunkReader::ioLoop, this);
+  }
+
+  ChunkReader(ChunkReader const &) = delete;
+  ChunkReader &operator=(ChunkReader const &) = delete;
+
+  ~ChunkReader() {
+    if (io.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(m);
+        stop = true;
+      }
+      cv.notify_all();
+      io.join();
+    }
+#ifdef READER_IO_URING
+    if (method_ == ReadMethod::IoUring) {
+      teardownRing();
+    }
+#endif
+    for (char *buffer : buffers) {
+      std::free(buffer);
+    }
+  }
+
+  /*
+  Points data at the next chunk and returns its length in bytes, or 0 at the
+  end of the file or on an error.
+  */
+  size_t next(const char **data) {
+    if (held >= 0 && drop_cache && base >= 0) {
+      posix_fadvise(fd, base + (next_chunk - 1) * chunk, chunk,
+                    POSIX_FADV_DONTNEED);
+    }
+    size_t bytes;
+#ifdef READER_IO_URING
+    if (method_ == ReadMethod::IoUring) {
+      bytes = nextRing(data);
+    } else
+#endif
+    {
+      bytes = nextThreaded(data);
+    }
+    next_chunk += bytes > 0;
+    return bytes;
+  }
+
+  // The method in use, after the fallbacks
+  ReadMethod method() const { return method_; }
+
+  size_t chunkBytes() const { return chunk; }
+
+  // errno of the failed read, 0 if none failed
+  int error() const { return error_; }
+};
+
+/*
+A read-only mapping of a whole file, for files that fit in the page cache:
+the kernels run directly on the mapping, without a copy, and start on the
+first pages while the kernel reads ahead the others.
+
+The mapping is advised MADV_SEQUENTIAL, for aggressive read-ahead and early
+reclaim of the pages behind, and MADV_HUGEPAGE, which the kernel honours for
+file mappings only on some filesystems and otherwise ignores. With populate
+the whole file is read in by mmap itself (MAP_POPULATE), so that the kernel
+does not take page faults but the first result waits for the whole read.
+*/
+class MappedFile {
+  void *addr = MAP_FAILED;
+  size_t bytes = 0;
+  int error_ = 0;
+
+public:
+  explicit MappedFile(const char *const path, bool const populate = false) {
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+      error_ = errno;
+      if (fd >= 0) {
+        close(fd);
+      }
+      return;
+    }
+
+    bytes = st.st_size;
+    // mmap refuses an empty length; an empty file maps to no pages
+    if (bytes > 0) {
+      int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+      flags |= populate ? MAP_POPULATE : 0;
+#endif
+      addr = mmap(nullptr, bytes, PROT_READ, flags, fd, 0);
+      if (addr == MAP_FAILED) {
+        error_ = errno;
+        bytes = 0;
+      } else {
+        madvise(addr, bytes, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+        madvise(addr, bytes, MADV_HUGEPAGE);
+#endif
+      }
+    }
+    close(fd);
+  }
+
+  MappedFile(MappedFile const &) = delete;
+  MappedFile &operator=(MappedFile const &) = delete;
+
+  ~MappedFile() {
+    if (addr != MAP_FAILED) {
+      munmap(addr, bytes);
+    }
+  }
+
+  // The contents of the file, null if it is empty
+  const char *data() const {
+    return addr == MAP_FAILED ? nullptr : static_cast<const char *>(addr);
+  }
+
+  size_t size() const { return bytes; }
+
+  // errno of the failed open or mmap, 0 if none failed
+  int error() const { return error_; }
+
+  // Starts reading ahead the pages of [begin, end) without waiting for them
+  void willNeed(size_t const begin, size_t const end) const {
+    size_t first = begin / readerAlignment * readerAlignment;
+    if (addr != MAP_FAILED && first < std::min(end, bytes)) {
+      madvise(static_cast<char *>(addr) + first, std::min(end, bytes) - first,
+              MADV_WILLNEED);
+    }
+  }
+
+  /*
+  Each OpenMP thread reads ahead its equal, contiguous share of the file,
+  which is the share a static "omp for" over the elements gives it, so that
+  all the shares are read in parallel from the start.
+  */
+  void willNeedPerThread() const {
+#pragma omp parallel
+    {
+      size_t thread = 0, threads = 1;
+#ifdef _OPENMP
+      thread = omp_get_thread_num();
+      threads = omp_get_num_threads();
+#endif
+      willNeed(bytes * thread / threads, bytes * (thread + 1) / threads);
+    }
+  }
+};
+
+#endif // include_reader_h
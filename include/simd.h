@@ -1,266 +1,4462 @@
 #ifndef include_simd_h
 #define include_simd_h
 
-#ifdef __x86_64__
-#include <immintrin.h>
-#endif
+#include "vec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
 
-#ifdef __ARM_NEON__
-#include "sse2neon.h"
+/*
+The SVE kernels have not yet been built and run on AArch64, so they are
+compiled only when asked for with -DSIMD_NATIVE_SVE on an SVE target;
+scripts/qemu-aarch64.sh builds them so. SIMD_SVE is defined when they are.
+*/
+#if defined(__ARM_FEATURE_SVE) && defined(SIMD_NATIVE_SVE)
+#define SIMD_SVE 1
+#include <arm_sve.h>
 #endif
 
-static void absSSE(int const *const arr, size_t const N, int *const abs_arr) {
+/*
+How the min/max kernels treat NaN and signed zero.
 
-  const int simd_width = 4;
-  size_t quot = N / simd_width;
-  size_t limit = quot * simd_width;
+Ignore    : NaNs are skipped. When the result is zero its sign is unspecified.
+            This is the cheapest policy and the default.
+Propagate : any NaN in the input makes both results NaN (IEEE 754-2019
+            minimum/maximum). -0 orders below +0.
+MinNum    : NaNs are skipped and -0 orders below +0 (IEEE 754-2019
+            minimumNumber/maximumNumber).
 
-  for (size_t i = 0; i < limit; i += simd_width) {
-    const __m128i temp_arr =
-        _mm_load_si128(reinterpret_cast<const __m128i *>(arr + i));
+Under every policy an input with no numbers in it (all NaN, or N == 0) yields
+NaN for both results.
+*/
+enum class NaNPolicy { Ignore, Propagate, MinNum };
 
-    __m128i arr_r = _mm_abs_epi32(temp_arr);
+// Scalar update of a running minimum with a non-NaN value x.
+template <NaNPolicy policy> static inline void minUpdate(float x, float &min) {
+  if (x < min ||
+      (policy != NaNPolicy::Ignore && x == min && std::signbit(x))) {
+    min = x;
+  }
+}
 
-    _mm_store_si128(reinterpret_cast<__m128i *>(abs_arr + i), arr_r);
+// Scalar update of a running maximum with a non-NaN value x.
+template <NaNPolicy policy> static inline void maxUpdate(float x, float &max) {
+  if (x > max ||
+      (policy != NaNPolicy::Ignore && x == max && !std::signbit(x))) {
+    max = x;
   }
+}
 
-  // abs for the remainder
-  for (size_t i = limit; i < N; i++) {
-    abs_arr[i] = abs(arr[i]);
+// Min-max of the elements [begin, end) that the vector loop did not cover.
+template <NaNPolicy policy>
+static inline void minMaxRemainder(float const *const arr, size_t const begin,
+                                   size_t const end, float &min, float &max,
+                                   size_t &nans) {
+  for (size_t i = begin; i < end; i++) {
+    if (std::isnan(arr[i])) {
+      nans++;
+      continue;
+    }
+    minUpdate<policy>(arr[i], min);
+    maxUpdate<policy>(arr[i], max);
+  }
+}
+
+// Applies the NaN policy to the reduced results and reports the NaN count.
+template <NaNPolicy policy>
+static inline void minMaxFinish(size_t const N, size_t const nans,
+                                float *const min, float *const max,
+                                size_t *const nan_count) {
+  if (nans == N || (policy == NaNPolicy::Propagate && nans > 0)) {
+    *min = *max = std::numeric_limits<float>::quiet_NaN();
+  }
+  if (nan_count != nullptr) {
+    *nan_count = nans;
+  }
+}
+
+/*
+Gives a zero result the sign demanded by the MinNum/Propagate policies. The
+vector loop may have kept either zero, so when min (max) is zero the N
+elements get(i) are scanned for a -0 (+0). Results are rarely exactly zero,
+so this extra pass is almost never taken.
+*/
+template <NaNPolicy policy, typename Get>
+static inline void minMaxZeroSignAt(size_t const N, Get get, float &min,
+                                    float &max) {
+  if (policy == NaNPolicy::Ignore) {
+    return;
   }
+  if (min == 0.0f) {
+    min = 0.0f;
+    for (size_t i = 0; i < N; i++) {
+      if (get(i) == 0.0f && std::signbit(get(i))) {
+        min = -0.0f;
+        break;
+      }
+    }
+  }
+  if (max == 0.0f) {
+    max = -0.0f;
+    for (size_t i = 0; i < N; i++) {
+      if (get(i) == 0.0f && !std::signbit(get(i))) {
+        max = 0.0f;
+        break;
+      }
+    }
+  }
+}
+
+// minMaxZeroSignAt over the N elements arr[i * stride]
+template <NaNPolicy policy>
+static inline void minMaxZeroSign(float const *const arr, size_t const N,
+                                  float &min, float &max,
+                                  size_t const stride = 1) {
+  minMaxZeroSignAt<policy>(
+      N, [=](size_t i) { return arr[i * stride]; }, min, max);
 }
 
-// SSE code operating on 32-bit floats
-static void minMaxSSE(float const *const arr, size_t const N, float *const min,
-                      float *const max) {
+// Element-wise abs of N ints, written once for any Vec<int, W>
+template <typename V>
+static void absVec(int const *const arr, size_t const N, int *const abs_arr) {
 
-  // 4 32-bit floats stored in 128-bit registers
-  const int simd_width = 4;
+  const int simd_width = V::width;
   size_t quot = N / simd_width;
   size_t limit = quot * simd_width;
 
-  __m128 arr_r = _mm_loadu_ps(arr);
-  __m128 max_r = arr_r;
-  __m128 min_r = arr_r;
+  for (size_t i = 0; i < limit; i += simd_width) {
+    V arr_r = V::abs(V::load(arr + i));
 
-  for (size_t i = simd_width; i < limit; i += simd_width) {
-    arr_r = _mm_loadu_ps(arr + i);
+    V::store(abs_arr + i, arr_r);
+  }
 
-    min_r = _mm_min_ps(min_r, arr_r);
-    max_r = _mm_max_ps(max_r, arr_r);
+  // abs for the remainder; INT_MIN is its own abs, as in the vector lanes,
+  // negated as unsigned since abs(INT_MIN) overflows
+  for (size_t i = limit; i < N; i++) {
+    abs_arr[i] = arr[i] < 0 ? int(0u - unsigned(arr[i])) : arr[i];
   }
+}
+
+/*
+Clamps N ints or floats to [lo, hi], written once for any Vec<T, W>.
+out may be arr. If clipped is not null it receives the number of elements
+that were raised to lo or lowered to hi. A float NaN fails both comparisons,
+so it is passed through unchanged and not counted, as with std::clamp.
+Clipped lanes are counted in a Vec<int, W> whose 32-bit lanes cover up to
+2^31 elements per lane.
+*/
+template <int W, typename T>
+static void clampVec(T const *const arr, size_t const N, T const lo,
+                     T const hi, T *const out, size_t *const clipped) {
+  typedef Vec<T, W> V;
+  typedef Vec<int, W> VI;
+
+  const int simd_width = V::width;
+  size_t quot = N / simd_width;
+  size_t limit = quot * simd_width;
 
-  float max_tmp[simd_width];
-  float min_tmp[simd_width];
+  V lo_r = V::set1(lo);
+  V hi_r = V::set1(hi);
 
-  _mm_storeu_ps(min_tmp, min_r);
-  _mm_storeu_ps(max_tmp, max_r);
+  size_t clipped_all = 0;
 
-  *max = max_tmp[0];
-  *min = min_tmp[0];
+  if (clipped == nullptr) {
+    for (size_t i = 0; i < limit; i += simd_width) {
+      V arr_r = V::load(arr + i);
+      arr_r = V::select(V::lt(arr_r, lo_r), lo_r, arr_r);
+      arr_r = V::select(V::gt(arr_r, hi_r), hi_r, arr_r);
 
-  for (int i = 1; i < simd_width; i++) {
-    if (max_tmp[i] > *max) {
-      *max = max_tmp[i];
+      V::store(out + i, arr_r);
     }
-    if (min_tmp[i] < *min) {
-      *min = min_tmp[i];
+  } else {
+    VI clipped_r = VI::zero();
+
+    for (size_t i = 0; i < limit; i += simd_width) {
+      V arr_r = V::load(arr + i);
+      typename V::Mask below = V::lt(arr_r, lo_r);
+      typename V::Mask above = V::gt(arr_r, hi_r);
+      arr_r = V::select(below, lo_r, arr_r);
+      arr_r = V::select(above, hi_r, arr_r);
+      clipped_r = VI::increment(VI::increment(clipped_r, below), above);
+
+      V::store(out + i, arr_r);
     }
+
+    clipped_all = VI::reduceAdd(clipped_r);
   }
 
-  // Calculating min-max for remaining elements
+  // clamp for the remainder
   for (size_t i = limit; i < N; i++) {
-    if (*max < arr[i]) {
-      *max = arr[i];
-    }
-    if (*min > arr[i]) {
-      *min = arr[i];
+    T x = arr[i];
+    if (x < lo) {
+      x = lo;
+      clipped_all++;
+    } else if (x > hi) {
+      x = hi;
+      clipped_all++;
     }
+    out[i] = x;
+  }
+
+  if (clipped != nullptr) {
+    *clipped = clipped_all;
   }
 }
 
-// Multithreaded SSE code operating on 32-bit floats
-static void minMaxSSEOMP(float const *const arr, size_t const N,
-                         float *const min, float *const max) {
+/*
+Min-max of N floats, written once for any Vec<float, W>.
+NaNs and signed zeros are handled according to the policy. If nan_count is
+not null it receives the number of NaNs in arr.
+The accumulators start at +/-inf, and V::min/V::max skip a NaN in their
+second operand, so NaN elements are dropped without extra instructions.
+NaN lanes are counted in a Vec<int, W> whose 32-bit lanes cover up to 2^31
+elements per lane. The loop is the same for every policy: ordering -0 below
++0 in each comparison would lengthen the min/max dependency chain, so
+minMaxZeroSign settles the sign afterwards.
+*/
+template <typename V, NaNPolicy policy>
+static void minMaxVec(float const *const arr, size_t const N,
+                      float *const min, float *const max,
+                      size_t *const nan_count) {
+  typedef Vec<int, V::width> VI;
 
-  // 4 32-bit floats stored in 128-bit registers
-  const int simd_width = 4;
+  const int simd_width = V::width;
   size_t quot = N / simd_width;
   size_t limit = quot * simd_width;
 
-#pragma omp parallel
-  {
-    float min_local = *min;
-    float max_local = *max;
-    __m128 arr_r = _mm_loadu_ps(arr);
-    __m128 max_r = arr_r;
-    __m128 min_r = arr_r;
+  V max_r = V::set1(-INFINITY);
+  V min_r = V::set1(INFINITY);
+  VI nan_r = VI::zero();
 
-#pragma omp for
-    for (size_t i = simd_width; i < limit; i += simd_width) {
-      arr_r = _mm_loadu_ps(arr + i);
+  for (size_t i = 0; i < limit; i += simd_width) {
+    V arr_r = V::load(arr + i);
+
+    min_r = V::min(min_r, arr_r);
+    max_r = V::max(max_r, arr_r);
+    nan_r = VI::increment(nan_r, V::isnan(arr_r));
+  }
 
-      // sleep(1);
+  float max_all = V::reduceMax(max_r);
+  float min_all = V::reduceMin(min_r);
+  size_t nans_all = VI::reduceAdd(nan_r);
 
-      min_r = _mm_min_ps(min_r, arr_r);
-      max_r = _mm_max_ps(max_r, arr_r);
-    }
-    float max_tmp[simd_width];
-    float min_tmp[simd_width];
+  // Calculating min-max for remaining elements
+  minMaxRemainder<policy>(arr, limit, N, min_all, max_all, nans_all);
+  minMaxZeroSign<policy>(arr, N, min_all, max_all);
 
-    _mm_storeu_ps(min_tmp, min_r);
-    _mm_storeu_ps(max_tmp, max_r);
+  *min = min_all;
+  *max = max_all;
+  minMaxFinish<policy>(N, nans_all, min, max, nan_count);
+}
 
-    max_local = max_tmp[0];
-    min_local = min_tmp[0];
+// Multithreaded version of minMaxVec
+template <typename V, NaNPolicy policy>
+static void minMaxVecOMP(float const *const arr, size_t const N,
+                         float *const min, float *const max,
+                         size_t *const nan_count) {
+  typedef Vec<int, V::width> VI;
 
-    for (int i = 1; i < simd_width; i++) {
-      if (max_tmp[i] > max_local) {
-        max_local = max_tmp[i];
-      }
-      if (min_tmp[i] < min_local) {
-        min_local = min_tmp[i];
-      }
+  const int simd_width = V::width;
+  size_t quot = N / simd_width;
+  size_t limit = quot * simd_width;
+
+  float max_all = -INFINITY;
+  float min_all = INFINITY;
+  size_t nans_all = 0;
+
+#pragma omp parallel
+  {
+    V max_r = V::set1(-INFINITY);
+    V min_r = V::set1(INFINITY);
+    VI nan_r = VI::zero();
+
+#pragma omp for nowait
+    for (size_t i = 0; i < limit; i += simd_width) {
+      V arr_r = V::load(arr + i);
+
+      min_r = V::min(min_r, arr_r);
+      max_r = V::max(max_r, arr_r);
+      nan_r = VI::increment(nan_r, V::isnan(arr_r));
     }
+
+    float max_local = V::reduceMax(max_r);
+    float min_local = V::reduceMin(min_r);
+    size_t nans_local = VI::reduceAdd(nan_r);
+
 #pragma omp critical
     {
-      if (max_local > *max) {
-        *max = max_local;
-      }
-      if (min_local < *min) {
-        *min = min_local;
-      }
+      maxUpdate<policy>(max_local, max_all);
+      minUpdate<policy>(min_local, min_all);
+      nans_all += nans_local;
     }
   }
 
   // Calculating min-max for remaining elements
-  for (size_t i = limit; i < N; i++) {
-    if (*max < arr[i]) {
-      *max = arr[i];
-    }
-    if (*min > arr[i]) {
-      *min = arr[i];
-    }
-  }
+  minMaxRemainder<policy>(arr, limit, N, min_all, max_all, nans_all);
+  minMaxZeroSign<policy>(arr, N, min_all, max_all);
+
+  *min = min_all;
+  *max = max_all;
+  minMaxFinish<policy>(N, nans_all, min, max, nan_count);
+}
+
+/*
+128-bit kernels: 4 32-bit lanes. Every kernel family below has such "SSE"
+wrappers over Vec<T, 4>. On AArch64 they run through sse2neon.h, or, with
+-DSIMD_NATIVE_NEON, on the native NEON Vec<T, 4>, when they are the same
+kernels as the "NEON" wrappers of the family.
+*/
+static inline void absSSE(int const *const arr, size_t const N,
+                          int *const abs_arr) {
+  absVec<Vec<int, 4>>(arr, N, abs_arr);
+}
+
+template <typename T>
+static inline void clampSSE(T const *const arr, size_t const N, T const lo,
+                            T const hi, T *const out,
+                            size_t *const clipped = nullptr) {
+  clampVec<4>(arr, N, lo, hi, out, clipped);
+}
+
+template <typename T>
+static inline void clampSSE(T *const arr, size_t const N, T const lo,
+                            T const hi, size_t *const clipped = nullptr) {
+  clampVec<4>(arr, N, lo, hi, arr, clipped);
+}
+
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxSSE(float const *const arr, size_t const N,
+                      float *const min, float *const max,
+                      size_t *const nan_count = nullptr) {
+  minMaxVec<Vec<float, 4>, policy>(arr, N, min, max, nan_count);
+}
+
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxSSEOMP(float const *const arr, size_t const N,
+                         float *const min, float *const max,
+                         size_t *const nan_count = nullptr) {
+  minMaxVecOMP<Vec<float, 4>, policy>(arr, N, min, max, nan_count);
 }
 
 #ifdef __AVX2__
-// AVX code operating on 32-bit floats
-static void minMaxAVX(float const *const arr, size_t const N, float *const min,
-                      float *const max) {
+// AVX2 kernels: 8 32-bit lanes in 256-bit registers
+static inline void absAVX2(int const *const arr, size_t const N,
+                           int *const abs_arr) {
+  absVec<Vec<int, 8>>(arr, N, abs_arr);
+}
 
-  // 8 32-bit floats stored in 256-bit registers
-  const int simd_width = 8;
-  __m256 arr_r = _mm256_loadu_ps(arr);
-  __m256 max_r = arr_r;
-  __m256 min_r = arr_r;
+template <typename T>
+static inline void clampAVX2(T const *const arr, size_t const N, T const lo,
+                             T const hi, T *const out,
+                             size_t *const clipped = nullptr) {
+  clampVec<8>(arr, N, lo, hi, out, clipped);
+}
 
-  size_t quot = N / simd_width;
-  size_t limit = quot * simd_width;
+template <typename T>
+static inline void clampAVX2(T *const arr, size_t const N, T const lo,
+                             T const hi, size_t *const clipped = nullptr) {
+  clampVec<8>(arr, N, lo, hi, arr, clipped);
+}
+
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxAVX(float const *const arr, size_t const N,
+                      float *const min, float *const max,
+                      size_t *const nan_count = nullptr) {
+  minMaxVec<Vec<float, 8>, policy>(arr, N, min, max, nan_count);
+}
+
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxAVXOMP(float const *const arr, size_t const N,
+                         float *const min, float *const max,
+                         size_t *const nan_count = nullptr) {
+  minMaxVecOMP<Vec<float, 8>, policy>(arr, N, min, max, nan_count);
+}
+#endif
+
+#ifdef __AVX512F__
+// AVX-512 kernels: 16 32-bit lanes in 512-bit registers
+static inline void absAVX512(int const *const arr, size_t const N,
+                             int *const abs_arr) {
+  absVec<Vec<int, 16>>(arr, N, abs_arr);
+}
+
+template <typename T>
+static inline void clampAVX512(T const *const arr, size_t const N, T const lo,
+                               T const hi, T *const out,
+                               size_t *const clipped = nullptr) {
+  clampVec<16>(arr, N, lo, hi, out, clipped);
+}
+
+template <typename T>
+static inline void clampAVX512(T *const arr, size_t const N, T const lo,
+                               T const hi, size_t *const clipped = nullptr) {
+  clampVec<16>(arr, N, lo, hi, arr, clipped);
+}
+
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxAVX512(float const *const arr, size_t const N,
+                         float *const min, float *const max,
+                         size_t *const nan_count = nullptr) {
+  minMaxVec<Vec<float, 16>, policy>(arr, N, min, max, nan_count);
+}
+
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxAVX512OMP(float const *const arr, size_t const N,
+                            float *const min, float *const max,
+                            size_t *const nan_count = nullptr) {
+  minMaxVecOMP<Vec<float, 16>, policy>(arr, N, min, max, nan_count);
+}
+#endif
+
+#ifdef SIMD_NEON
+// AArch64 NEON kernels: 4 32-bit lanes in 128-bit registers
+static inline void absNEON(int const *const arr, size_t const N,
+                           int *const abs_arr) {
+  absVec<Vec<int, 4>>(arr, N, abs_arr);
+}
+
+template <typename T>
+static inline void clampNEON(T const *const arr, size_t const N, T const lo,
+                             T const hi, T *const out,
+                             size_t *const clipped = nullptr) {
+  clampVec<4>(arr, N, lo, hi, out, clipped);
+}
+
+template <typename T>
+static inline void clampNEON(T *const arr, size_t const N, T const lo,
+                             T const hi, size_t *const clipped = nullptr) {
+  clampVec<4>(arr, N, lo, hi, arr, clipped);
+}
+
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxNEON(float const *const arr, size_t const N,
+                       float *const min, float *const max,
+                       size_t *const nan_count = nullptr) {
+  minMaxVec<Vec<float, 4>, policy>(arr, N, min, max, nan_count);
+}
+
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxNEONOMP(float const *const arr, size_t const N,
+                          float *const min, float *const max,
+                          size_t *const nan_count = nullptr) {
+  minMaxVecOMP<Vec<float, 4>, policy>(arr, N, min, max, nan_count);
+}
+#endif
+
+#ifdef SIMD_SVE
+/*
+Vector-length-agnostic SVE kernels. The loop covers the whole array: the
+last, partial vector is handled by the svwhilelt predicate instead of a
+scalar remainder loop. As with NEON, FMINNM/FMAXNM give the NaN and signed
+zero semantics directly; NaN lanes are counted with a predicated add.
+*/
+static inline void absSVE(int const *const arr, size_t const N,
+                          int *const abs_arr) {
 
-  for (size_t i = simd_width; i < limit; i += simd_width) {
-    arr_r = _mm256_loadu_ps(arr + i);
+  const uint64_t simd_width = svcntw();
 
-    min_r = _mm256_min_ps(min_r, arr_r);
-    max_r = _mm256_max_ps(max_r, arr_r);
+  for (size_t i = 0; i < N; i += simd_width) {
+    svbool_t pg = svwhilelt_b32_u64(i, N);
+    svint32_t arr_r = svld1_s32(pg, arr + i);
+
+    svst1_s32(pg, abs_arr + i, svabs_s32_x(pg, arr_r));
   }
+}
 
-  float max_tmp[simd_width];
-  float min_tmp[simd_width];
+// SVE code operating on 32-bit floats
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxSVE(float const *const arr, size_t const N,
+                      float *const min, float *const max,
+                      size_t *const nan_count = nullptr) {
 
-  _mm256_storeu_ps(min_tmp, min_r);
+  // svcntw() 32-bit floats per vector, a multiple of 4
+  const uint64_t simd_width = svcntw();
 
-  _mm256_storeu_ps(max_tmp, max_r);
+  svfloat32_t max_r = svdup_n_f32(-INFINITY);
+  svfloat32_t min_r = svdup_n_f32(INFINITY);
+  svuint32_t nan_r = svdup_n_u32(0);
 
-  *max = max_tmp[0];
-  *min = min_tmp[0];
+  for (size_t i = 0; i < N; i += simd_width) {
+    svbool_t pg = svwhilelt_b32_u64(i, N);
+    svfloat32_t arr_r = svld1_f32(pg, arr + i);
 
-  for (int i = 1; i < simd_width; i++) {
-    if (max_tmp[i] > *max) {
-      *max = max_tmp[i];
-    }
-    if (min_tmp[i] < *min) {
-      *min = min_tmp[i];
-    }
+    min_r = svminnm_f32_m(pg, min_r, arr_r);
+    max_r = svmaxnm_f32_m(pg, max_r, arr_r);
+    nan_r = svadd_n_u32_m(svcmpuo_f32(pg, arr_r, arr_r), nan_r, 1);
   }
 
-  // Min max for reminder
-  for (size_t i = limit; i < N; i++) {
-    if (*max < arr[i]) {
-      *max = arr[i];
+  const svbool_t all = svptrue_b32();
+  float max_all = svmaxnmv_f32(all, max_r);
+  float min_all = svminnmv_f32(all, min_r);
+  size_t nans_all = svaddv_u32(all, nan_r);
+
+  *min = min_all;
+  *max = max_all;
+  minMaxFinish<policy>(N, nans_all, min, max, nan_count);
+}
+
+// Multithreaded SVE code operating on 32-bit floats
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxSVEOMP(float const *const arr, size_t const N,
+                         float *const min, float *const max,
+                         size_t *const nan_count = nullptr) {
+
+  const uint64_t simd_width = svcntw();
+
+  float max_all = -INFINITY;
+  float min_all = INFINITY;
+  size_t nans_all = 0;
+
+#pragma omp parallel
+  {
+    svfloat32_t max_r = svdup_n_f32(-INFINITY);
+    svfloat32_t min_r = svdup_n_f32(INFINITY);
+    svuint32_t nan_r = svdup_n_u32(0);
+
+#pragma omp for nowait
+    for (size_t i = 0; i < N; i += simd_width) {
+      svbool_t pg = svwhilelt_b32_u64(i, N);
+      svfloat32_t arr_r = svld1_f32(pg, arr + i);
+
+      min_r = svminnm_f32_m(pg, min_r, arr_r);
+      max_r = svmaxnm_f32_m(pg, max_r, arr_r);
+      nan_r = svadd_n_u32_m(svcmpuo_f32(pg, arr_r, arr_r), nan_r, 1);
     }
-    if (*min > arr[i]) {
-      *min = arr[i];
+
+    const svbool_t all = svptrue_b32();
+    float max_local = svmaxnmv_f32(all, max_r);
+    float min_local = svminnmv_f32(all, min_r);
+    size_t nans_local = svaddv_u32(all, nan_r);
+
+#pragma omp critical
+    {
+      maxUpdate<policy>(max_local, max_all);
+      minUpdate<policy>(min_local, min_all);
+      nans_all += nans_local;
     }
   }
+
+  *min = min_all;
+  *max = max_all;
+  minMaxFinish<policy>(N, nans_all, min, max, nan_count);
 }
 #endif
 
-#ifdef __AVX2__
-// Multithreaded AVX code operating on 32-bit floats
-static void minMaxAVXOMP(float const *const arr, size_t const N,
-                         float *const min, float *const max) {
+/*
+Dispatchers picking the best kernel for the target this file is compiled for
+(see -march in the Makefile), in order of preference SVE, NEON, AVX-512,
+AVX2, SSE.
+*/
+static inline void absAuto(int const *const arr, size_t const N,
+                           int *const abs_arr) {
+#if defined(SIMD_SVE)
+  absSVE(arr, N, abs_arr);
+#elif defined(SIMD_NEON)
+  absNEON(arr, N, abs_arr);
+#elif defined(__AVX512F__)
+  absAVX512(arr, N, abs_arr);
+#elif defined(__AVX2__)
+  absAVX2(arr, N, abs_arr);
+#else
+  absSSE(arr, N, abs_arr);
+#endif
+}
 
-  // 8 32-bit floats stored in 256-bit registers
-  const int simd_width = 8;
-  size_t quot = N / simd_width;
-  size_t limit = quot * simd_width;
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxAuto(float const *const arr, size_t const N,
+                       float *const min, float *const max,
+                       size_t *const nan_count = nullptr) {
+#if defined(SIMD_SVE)
+  minMaxSVE<policy>(arr, N, min, max, nan_count);
+#elif defined(SIMD_NEON)
+  minMaxNEON<policy>(arr, N, min, max, nan_count);
+#elif defined(__AVX512F__)
+  minMaxAVX512<policy>(arr, N, min, max, nan_count);
+#elif defined(__AVX2__)
+  minMaxAVX<policy>(arr, N, min, max, nan_count);
+#else
+  minMaxSSE<policy>(arr, N, min, max, nan_count);
+#endif
+}
 
-#pragma omp parallel
-  {
-    float min_local = *min;
-    float max_local = *max;
-    __m256 arr_r = _mm256_loadu_ps(arr);
-    __m256 max_r = arr_r;
-    __m256 min_r = arr_r;
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxAutoOMP(float const *const arr, size_t const N,
+                          float *const min, float *const max,
+                          size_t *const nan_count = nullptr) {
+#if defined(SIMD_SVE)
+  minMaxSVEOMP<policy>(arr, N, min, max, nan_count);
+#elif defined(SIMD_NEON)
+  minMaxNEONOMP<policy>(arr, N, min, max, nan_count);
+#elif defined(__AVX512F__)
+  minMaxAVX512OMP<policy>(arr, N, min, max, nan_count);
+#elif defined(__AVX2__)
+  minMaxAVXOMP<policy>(arr, N, min, max, nan_count);
+#else
+  minMaxSSEOMP<policy>(arr, N, min, max, nan_count);
+#endif
+}
 
-#pragma omp for
-    for (size_t i = simd_width; i < limit; i += simd_width) {
-      arr_r = _mm256_loadu_ps(arr + i);
+/*
+Streaming min-max: a MinMaxAccumulator keeps the vector accumulators of
+minMaxVec across update(p, n) calls, so a stream arriving in chunks is
+reduced in one pass without buffering it. Chunks may have any length: the
+elements after the last whole vector of a chunk are kept until the next
+chunk completes the vector, and result() runs the last partial vector padded
+with NaNs, which the min/max skip and which are taken off the NaN count.
+merge() folds in an accumulator that saw another part of the stream, e.g.
+on another thread; the result does not depend on how the stream was split.
+
+The zero signs the MinNum and Propagate policies need cannot be settled by
+rescanning the input as in minMaxZeroSign, so under these policies the
+vector loop also counts the zeros and the negative zeros it sees. The lane
+counters are added up every minMaxStreamBlock elements so that they cannot
+overflow however long the stream.
+*/
+static const size_t minMaxStreamBlock = 1 << 20;
+
+// Vector width of the Vec kernels that minMaxAuto prefers
+#ifdef SIMD_NEON
+static const int minMaxAutoWidth = 4;
+#elif defined(__AVX512F__)
+static const int minMaxAutoWidth = 16;
+#elif defined(__AVX2__)
+static const int minMaxAutoWidth = 8;
+#else
+static const int minMaxAutoWidth = 4;
+#endif
+
+template <int W = minMaxAutoWidth, NaNPolicy policy = NaNPolicy::Ignore>
+class MinMaxAccumulator {
+  typedef Vec<float, W> V;
+  typedef Vec<int, W> VI;
 
-      // sleep(1);
+  V min_r = V::set1(INFINITY);
+  V max_r = V::set1(-INFINITY);
+  size_t count = 0, nans = 0, zeros = 0, negative_zeros = 0;
+  // The elements after the last whole vector
+  float pending[W] = {};
+  size_t pending_n = 0;
 
-      min_r = _mm256_min_ps(min_r, arr_r);
-      max_r = _mm256_max_ps(max_r, arr_r);
+  // Folds in n elements, n a multiple of W
+  void add(float const *const p, size_t const n) {
+    for (size_t block = 0; block < n; block += minMaxStreamBlock) {
+      size_t block_end = std::min(n, block + minMaxStreamBlock);
+      VI nan_r = VI::zero(), zero_r = VI::zero(), negative_zero_r = VI::zero();
+
+      for (size_t i = block; i < block_end; i += W) {
+        V arr_r = V::load(p + i);
+
+        min_r = V::min(min_r, arr_r);
+        max_r = V::max(max_r, arr_r);
+        nan_r = VI::increment(nan_r, V::isnan(arr_r));
+        if constexpr (policy != NaNPolicy::Ignore) {
+          typename V::Mask zero = V::eq(arr_r, V::zero());
+          zero_r = VI::increment(zero_r, zero);
+          negative_zero_r = VI::increment(
+              negative_zero_r,
+              V::signbit(V::select(zero, arr_r, V::set1(1.0f))));
+        }
+      }
+
+      nans += VI::reduceAdd(nan_r);
+      zeros += VI::reduceAdd(zero_r);
+      negative_zeros += VI::reduceAdd(negative_zero_r);
+    }
+    count += n;
+  }
+
+public:
+  void update(float const *const p, size_t const n) {
+    size_t i = 0;
+    // Completing the vector left over from the previous chunk
+    if (pending_n > 0) {
+      i = std::min(n, W - pending_n);
+      std::copy(p, p + i, pending + pending_n);
+      pending_n += i;
+      if (pending_n < W) {
+        return;
+      }
+      add(pending, W);
+      pending_n = 0;
     }
-    float max_tmp[simd_width];
-    float min_tmp[simd_width];
 
-    _mm256_storeu_ps(min_tmp, min_r);
-    _mm256_storeu_ps(max_tmp, max_r);
+    size_t limit = i + (n - i) / W * W;
+    add(p + i, limit - i);
+    std::copy(p + limit, p + n, pending);
+    pending_n = n - limit;
+  }
+
+  void merge(MinMaxAccumulator const &other) {
+    min_r = V::min(min_r, other.min_r);
+    max_r = V::max(max_r, other.max_r);
+    count += other.count;
+    nans += other.nans;
+    zeros += other.zeros;
+    negative_zeros += other.negative_zeros;
+    update(other.pending, other.pending_n);
+  }
+
+  // Number of elements seen so far
+  size_t size() const { return count + pending_n; }
 
-    max_local = max_tmp[0];
-    min_local = min_tmp[0];
+  // Min-max of the elements seen so far, as minMaxVec would give for them
+  void result(float *const min, float *const max,
+              size_t *const nan_count = nullptr) const {
+    MinMaxAccumulator last = *this;
+    if (pending_n > 0) {
+      std::fill(last.pending + pending_n, last.pending + W, NAN);
+      last.add(last.pending, W);
+      last.count -= W - pending_n;
+      last.nans -= W - pending_n;
+    }
 
-    for (int i = 1; i < simd_width; i++) {
-      if (max_tmp[i] > max_local) {
-        max_local = max_tmp[i];
+    *min = V::reduceMin(last.min_r);
+    *max = V::reduceMax(last.max_r);
+    if (policy != NaNPolicy::Ignore) {
+      if (*min == 0.0f) {
+        *min = last.negative_zeros > 0 ? -0.0f : 0.0f;
       }
-      if (min_tmp[i] < min_local) {
-        min_local = min_tmp[i];
+      if (*max == 0.0f) {
+        *max = last.zeros > last.negative_zeros ? 0.0f : -0.0f;
       }
     }
-#pragma omp critical
-    {
-      if (max_local > *max) {
-        *max = max_local;
+    minMaxFinish<policy>(last.count, last.nans, min, max, nan_count);
+  }
+};
+
+/*
+Min-max of many columns in one call: min[c], max[c] (and nan_count[c] if
+nan_count is not null) receive the results of minMaxVec on the lengths[c]
+floats of columns[c], under the given policy.
+
+The columns are cut into pieces of at most minMaxBatchChunk elements (256 KiB,
+which fits in L2), and consecutive pieces are grouped into work units of up to
+minMaxBatchChunk elements, so that a large column is spread over all threads
+while many small columns are handled together by one thread. A single
+parallel region hands the units out dynamically, instead of starting one per
+column, and the piece results are combined per column afterwards.
+*/
+static const size_t minMaxBatchChunk = 1 << 16;
+
+template <typename V, NaNPolicy policy>
+static void minMaxBatchVec(float const *const *const columns,
+                           size_t const *const lengths,
+                           size_t const n_columns, float *const min,
+                           float *const max, size_t *const nan_count) {
+  struct Piece {
+    size_t column, begin, end;
+    float min, max;
+    size_t nans;
+  };
+  std::vector<Piece> pieces;
+  // The first piece of each unit, then the number of pieces
+  std::vector<size_t> units;
+  size_t unit_size = 0;
+
+  for (size_t c = 0; c < n_columns; c++) {
+    size_t begin = 0;
+    do {
+      size_t end = std::min(lengths[c], begin + minMaxBatchChunk);
+      if (units.empty() || unit_size + (end - begin) > minMaxBatchChunk) {
+        units.push_back(pieces.size());
+        unit_size = 0;
       }
-      if (min_local < *min) {
-        *min = min_local;
+      pieces.push_back({c, begin, end, 0.0f, 0.0f, 0});
+      unit_size += end - begin;
+      begin = end;
+    } while (begin < lengths[c]);
+  }
+  units.push_back(pieces.size());
+
+#pragma omp parallel for schedule(dynamic, 1)
+  for (size_t u = 0; u < units.size() - 1; u++) {
+    for (size_t p = units[u]; p < units[u + 1]; p++) {
+      Piece &piece = pieces[p];
+      minMaxVec<V, policy>(columns[piece.column] + piece.begin,
+                           piece.end - piece.begin, &piece.min, &piece.max,
+                           &piece.nans);
+    }
+  }
+
+  // A piece without numbers gives NaN, which the policy settles from the
+  // NaN count of the whole column
+  std::vector<size_t> nans(n_columns, 0);
+  std::fill(min, min + n_columns, INFINITY);
+  std::fill(max, max + n_columns, -INFINITY);
+  for (const Piece &piece : pieces) {
+    if (!std::isnan(piece.min)) {
+      minUpdate<policy>(piece.min, min[piece.column]);
+      maxUpdate<policy>(piece.max, max[piece.column]);
+    }
+    nans[piece.column] += piece.nans;
+  }
+  for (size_t c = 0; c < n_columns; c++) {
+    minMaxFinish<policy>(lengths[c], nans[c], &min[c], &max[c],
+                         nan_count != nullptr ? &nan_count[c] : nullptr);
+  }
+}
+
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxBatchSSE(float const *const *const columns,
+                           size_t const *const lengths,
+                           size_t const n_columns, float *const min,
+                           float *const max,
+                           size_t *const nan_count = nullptr) {
+  minMaxBatchVec<Vec<float, 4>, policy>(columns, lengths, n_columns, min, max,
+                                        nan_count);
+}
+
+#ifdef __AVX2__
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxBatchAVX(float const *const *const columns,
+                           size_t const *const lengths,
+                           size_t const n_columns, float *const min,
+                           float *const max,
+                           size_t *const nan_count = nullptr) {
+  minMaxBatchVec<Vec<float, 8>, policy>(columns, lengths, n_columns, min, max,
+                                        nan_count);
+}
+#endif
+
+#ifdef __AVX512F__
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxBatchAVX512(float const *const *const columns,
+                              size_t const *const lengths,
+                              size_t const n_columns, float *const min,
+                              float *const max,
+                              size_t *const nan_count = nullptr) {
+  minMaxBatchVec<Vec<float, 16>, policy>(columns, lengths, n_columns, min,
+                                         max, nan_count);
+}
+#endif
+
+#ifdef SIMD_NEON
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxBatchNEON(float const *const *const columns,
+                            size_t const *const lengths,
+                            size_t const n_columns, float *const min,
+                            float *const max,
+                            size_t *const nan_count = nullptr) {
+  minMaxBatchVec<Vec<float, 4>, policy>(columns, lengths, n_columns, min, max,
+                                        nan_count);
+}
+#endif
+
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxBatchAuto(float const *const *const columns,
+                            size_t const *const lengths,
+                            size_t const n_columns, float *const min,
+                            float *const max,
+                            size_t *const nan_count = nullptr) {
+  minMaxBatchVec<Vec<float, minMaxAutoWidth>, policy>(
+      columns, lengths, n_columns, min, max, nan_count);
+}
+
+/*
+Min-max of every field of n_records records of F floats each, an array of
+structs such as {x, y, z, w}, in one pass and without copying the fields
+out: min[f], max[f] (and nan_count[f] if nan_count is not null) receive what
+minMaxVec gives for field f alone.
+
+The fields need no shuffling into place: F consecutive vectors hold W whole
+records, and lane j of the k-th of them always holds field (k * W + j) % F.
+So F pairs of min/max accumulators, one per vector of the group, keep every
+field in fixed lanes, and the lanes are reduced by field once at the end.
+*/
+template <int W, int F, NaNPolicy policy>
+static void minMaxAoSVec(float const *const records, size_t const n_records,
+                         float *const min, float *const max,
+                         size_t *const nan_count) {
+  static_assert(F >= 1 && F <= 16, "up to 16 fields per record");
+  typedef Vec<float, W> V;
+  typedef Vec<int, W> VI;
+
+  V min_r[F], max_r[F];
+  VI nan_r[F];
+  for (int k = 0; k < F; k++) {
+    min_r[k] = V::set1(INFINITY);
+    max_r[k] = V::set1(-INFINITY);
+    nan_r[k] = VI::zero();
+  }
+
+  size_t limit = n_records / W * W;
+  for (size_t i = 0; i < limit * F; i += F * W) {
+    for (int k = 0; k < F; k++) {
+      V arr_r = V::load(records + i + k * W);
+
+      min_r[k] = V::min(min_r[k], arr_r);
+      max_r[k] = V::max(max_r[k], arr_r);
+      nan_r[k] = VI::increment(nan_r[k], V::isnan(arr_r));
+    }
+  }
+
+  float min_lanes[F * W], max_lanes[F * W];
+  int nan_lanes[F * W];
+  for (int k = 0; k < F; k++) {
+    V::store(min_lanes + k * W, min_r[k]);
+    V::store(max_lanes + k * W, max_r[k]);
+    VI::store(nan_lanes + k * W, nan_r[k]);
+  }
+
+  size_t nans[F] = {};
+  std::fill(min, min + F, INFINITY);
+  std::fill(max, max + F, -INFINITY);
+  for (int j = 0; j < F * W; j++) {
+    minUpdate<policy>(min_lanes[j], min[j % F]);
+    maxUpdate<policy>(max_lanes[j], max[j % F]);
+    nans[j % F] += nan_lanes[j];
+  }
+
+  // Calculating min-max for remaining records
+  for (int f = 0; f < F; f++) {
+    for (size_t i = limit; i < n_records; i++) {
+      float x = records[i * F + f];
+      if (std::isnan(x)) {
+        nans[f]++;
+        continue;
       }
+      minUpdate<policy>(x, min[f]);
+      maxUpdate<policy>(x, max[f]);
     }
+    minMaxZeroSign<policy>(records + f, n_records, min[f], max[f], F);
+    minMaxFinish<policy>(n_records, nans[f], &min[f], &max[f],
+                         nan_count != nullptr ? &nan_count[f] : nullptr);
   }
+}
 
-  // Calculating min-max for remaining elements
-  for (size_t i = limit; i < N; i++) {
-    if (*max < arr[i]) {
-      *max = arr[i];
+/*
+Array of structs to struct of arrays for n records of four floats, and back:
+soa[f][i] is records[4 * i + f]. Vector k of each group of four is loaded
+with record 4 * b + k in its 128-bit block b, so that once the 4x4 blocks are
+transposed in registers vector f holds field f of W consecutive records.
+*/
+template <int W>
+static void aosToSoaVec(float const *const records, size_t const n,
+                        float *const *const soa) {
+  typedef Vec<float, W> V;
+  size_t limit = n / W * W;
+
+  for (size_t i = 0; i < limit; i += W) {
+    float const *p = records + 4 * i;
+    V a = V::loadBlocks(p, 16), b = V::loadBlocks(p + 4, 16);
+    V c = V::loadBlocks(p + 8, 16), d = V::loadBlocks(p + 12, 16);
+    V::transpose4(a, b, c, d);
+    V::store(soa[0] + i, a);
+    V::store(soa[1] + i, b);
+    V::store(soa[2] + i, c);
+    V::store(soa[3] + i, d);
+  }
+
+  for (size_t i = limit; i < n; i++) {
+    for (int f = 0; f < 4; f++) {
+      soa[f][i] = records[4 * i + f];
     }
-    if (*min > arr[i]) {
-      *min = arr[i];
+  }
+}
+
+template <int W>
+static void soaToAosVec(float const *const *const soa, size_t const n,
+                        float *const records) {
+  typedef Vec<float, W> V;
+  size_t limit = n / W * W;
+
+  for (size_t i = 0; i < limit; i += W) {
+    V a = V::load(soa[0] + i), b = V::load(soa[1] + i);
+    V c = V::load(soa[2] + i), d = V::load(soa[3] + i);
+    V::transpose4(a, b, c, d);
+    float *p = records + 4 * i;
+    V::storeBlocks(p, 16, a);
+    V::storeBlocks(p + 4, 16, b);
+    V::storeBlocks(p + 8, 16, c);
+    V::storeBlocks(p + 12, 16, d);
+  }
+
+  for (size_t i = limit; i < n; i++) {
+    for (int f = 0; f < 4; f++) {
+      records[4 * i + f] = soa[f][i];
     }
   }
 }
+
+template <int F, NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxAoSSSE(float const *const records, size_t const n_records,
+                         float *const min, float *const max,
+                         size_t *const nan_count = nullptr) {
+  minMaxAoSVec<4, F, policy>(records, n_records, min, max, nan_count);
+}
+
+static inline void aosToSoaSSE(float const *const records, size_t const n,
+                               float *const *const soa) {
+  aosToSoaVec<4>(records, n, soa);
+}
+
+static inline void soaToAosSSE(float const *const *const soa, size_t const n,
+                               float *const records) {
+  soaToAosVec<4>(soa, n, records);
+}
+
+#ifdef __AVX2__
+template <int F, NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxAoSAVX(float const *const records, size_t const n_records,
+                         float *const min, float *const max,
+                         size_t *const nan_count = nullptr) {
+  minMaxAoSVec<8, F, policy>(records, n_records, min, max, nan_count);
+}
+
+static inline void aosToSoaAVX2(float const *const records, size_t const n,
+                                float *const *const soa) {
+  aosToSoaVec<8>(records, n, soa);
+}
+
+static inline void soaToAosAVX2(float const *const *const soa, size_t const n,
+                                float *const records) {
+  soaToAosVec<8>(soa, n, records);
+}
+#endif
+
+#ifdef __AVX512F__
+template <int F, NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxAoSAVX512(float const *const records,
+                            size_t const n_records, float *const min,
+                            float *const max,
+                            size_t *const nan_count = nullptr) {
+  minMaxAoSVec<16, F, policy>(records, n_records, min, max, nan_count);
+}
+
+static inline void aosToSoaAVX512(float const *const records, size_t const n,
+                                  float *const *const soa) {
+  aosToSoaVec<16>(records, n, soa);
+}
+
+static inline void soaToAosAVX512(float const *const *const soa,
+                                  size_t const n, float *const records) {
+  soaToAosVec<16>(soa, n, records);
+}
+#endif
+
+#ifdef SIMD_NEON
+template <int F, NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxAoSNEON(float const *const records, size_t const n_records,
+                          float *const min, float *const max,
+                          size_t *const nan_count = nullptr) {
+  minMaxAoSVec<4, F, policy>(records, n_records, min, max, nan_count);
+}
+
+static inline void aosToSoaNEON(float const *const records, size_t const n,
+                                float *const *const soa) {
+  aosToSoaVec<4>(records, n, soa);
+}
+
+static inline void soaToAosNEON(float const *const *const soa, size_t const n,
+                                float *const records) {
+  soaToAosVec<4>(soa, n, records);
+}
+#endif
+
+template <int F, NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxAoSAuto(float const *const records, size_t const n_records,
+                          float *const min, float *const max,
+                          size_t *const nan_count = nullptr) {
+  minMaxAoSVec<minMaxAutoWidth, F, policy>(records, n_records, min, max,
+                                           nan_count);
+}
+
+/*
+Min-max of the n elements arr[indices[i]] of a selection of rows, the same
+as minMaxVec gives for a copy of them. The indices may come in any order and
+repeat; they are ints, as the gather instructions take them.
+
+GatherMode::Hardware loads each vector with V::gather, which is a gather
+instruction on AVX2 and AVX-512 and one load per lane elsewhere.
+GatherMode::Prefetch loads the lanes one by one and prefetches the element
+gatherPrefetchDistance indices ahead. It is meant for hosts where the gather
+instructions are slow (AMD before Zen 4, Intel with the Gather Data Sampling
+mitigation), and for random rows of an array much larger than the caches,
+where the loop waits on memory whatever the loads.
+*/
+enum class GatherMode { Hardware, Prefetch };
+
+static const size_t gatherPrefetchDistance = 32;
+
+template <int W, GatherMode mode, NaNPolicy policy>
+static void minMaxGatherVec(float const *const arr, int const *const indices,
+                            size_t const n, float *const min,
+                            float *const max, size_t *const nan_count) {
+  typedef Vec<float, W> V;
+  typedef Vec<int, W> VI;
+
+  size_t limit = n / W * W;
+  size_t prefetch_limit = n > gatherPrefetchDistance
+                              ? n - gatherPrefetchDistance
+                              : 0;
+
+  V max_r = V::set1(-INFINITY);
+  V min_r = V::set1(INFINITY);
+  VI nan_r = VI::zero();
+
+  for (size_t i = 0; i < limit; i += W) {
+    V arr_r;
+    if constexpr (mode == GatherMode::Hardware) {
+      arr_r = V::gather(arr, indices + i);
+    } else {
+      float lanes[W];
+      for (int j = 0; j < W; j++) {
+        if (i + j < prefetch_limit) {
+          __builtin_prefetch(arr + indices[i + j + gatherPrefetchDistance]);
+        }
+        lanes[j] = arr[indices[i + j]];
+      }
+      arr_r = V::load(lanes);
+    }
+
+    min_r = V::min(min_r, arr_r);
+    max_r = V::max(max_r, arr_r);
+    nan_r = VI::increment(nan_r, V::isnan(arr_r));
+  }
+
+  float max_all = V::reduceMax(max_r);
+  float min_all = V::reduceMin(min_r);
+  size_t nans_all = VI::reduceAdd(nan_r);
+
+  // Calculating min-max for remaining elements
+  for (size_t i = limit; i < n; i++) {
+    float x = arr[indices[i]];
+    if (std::isnan(x)) {
+      nans_all++;
+      continue;
+    }
+    minUpdate<policy>(x, min_all);
+    maxUpdate<policy>(x, max_all);
+  }
+  minMaxZeroSignAt<policy>(
+      n, [=](size_t i) { return arr[indices[i]]; }, min_all, max_all);
+
+  *min = min_all;
+  *max = max_all;
+  minMaxFinish<policy>(n, nans_all, min, max, nan_count);
+}
+
+template <GatherMode mode = GatherMode::Hardware,
+          NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxGatherSSE(float const *const arr, int const *const indices,
+                            size_t const n, float *const min,
+                            float *const max,
+                            size_t *const nan_count = nullptr) {
+  minMaxGatherVec<4, mode, policy>(arr, indices, n, min, max, nan_count);
+}
+
+#ifdef __AVX2__
+template <GatherMode mode = GatherMode::Hardware,
+          NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxGatherAVX2(float const *const arr, int const *const indices,
+                             size_t const n, float *const min,
+                             float *const max,
+                             size_t *const nan_count = nullptr) {
+  minMaxGatherVec<8, mode, policy>(arr, indices, n, min, max, nan_count);
+}
+#endif
+
+#ifdef __AVX512F__
+template <GatherMode mode = GatherMode::Hardware,
+          NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxGatherAVX512(float const *const arr,
+                               int const *const indices, size_t const n,
+                               float *const min, float *const max,
+                               size_t *const nan_count = nullptr) {
+  minMaxGatherVec<16, mode, policy>(arr, indices, n, min, max, nan_count);
+}
+#endif
+
+#ifdef SIMD_NEON
+template <GatherMode mode = GatherMode::Hardware,
+          NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxGatherNEON(float const *const arr, int const *const indices,
+                             size_t const n, float *const min,
+                             float *const max,
+                             size_t *const nan_count = nullptr) {
+  minMaxGatherVec<4, mode, policy>(arr, indices, n, min, max, nan_count);
+}
+#endif
+
+template <GatherMode mode = GatherMode::Hardware,
+          NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxGatherAuto(float const *const arr, int const *const indices,
+                             size_t const n, float *const min,
+                             float *const max,
+                             size_t *const nan_count = nullptr) {
+  minMaxGatherVec<minMaxAutoWidth, mode, policy>(arr, indices, n, min, max,
+                                                 nan_count);
+}
+
+/*
+Min-max of the elements of arr that are valid in an Arrow-style validity
+bitmap: arr[i] is valid when bit b % 8 of validity[b / 8] is set, with
+b = validity_offset + i, and null otherwise. Nulls are skipped whatever
+their value, NaNs among the valid elements follow the policy and are counted
+in nan_count, and min and max are NaN when nothing is valid, as for an array
+of NaNs. A null validity means that every element is valid, which is
+minMaxVec.
+
+The bitmap is read 64 bits at a time. A word of nulls skips its 64
+elements, a word of valid elements runs the loop of minMaxVec, and any
+other word is expanded W bits at a time into the lane masks of
+maskMin/maskMax. The elements before the first whole byte of the bitmap and
+the last ones that do not fill a word are handled one by one.
+*/
+static inline bool validityBit(uint8_t const *const validity, size_t const i) {
+  return validity[i / 8] >> (i % 8) & 1;
+}
+
+template <int W, NaNPolicy policy>
+static void minMaxMaskedVec(float const *const arr,
+                            uint8_t const *const validity, size_t const N,
+                            float *const min, float *const max,
+                            size_t *const nan_count,
+                            size_t const validity_offset = 0) {
+  typedef Vec<float, W> V;
+  typedef Vec<int, W> VI;
+
+  if (validity == nullptr) {
+    minMaxVec<V, policy>(arr, N, min, max, nan_count);
+    return;
+  }
+
+  const unsigned lane_bits = (1u << W) - 1;
+  size_t head = std::min(N, (8 - validity_offset % 8) % 8);
+  size_t limit = head + (N - head) / 64 * 64;
+  size_t valid = 0;
+
+  V max_r = V::set1(-INFINITY);
+  V min_r = V::set1(INFINITY);
+  VI nan_r = VI::zero();
+
+  for (size_t i = head; i < limit; i += 64) {
+    // Bitmaps are little-endian, like the x86 and AArch64 hosts
+    uint64_t word;
+    std::memcpy(&word, validity + (validity_offset + i) / 8, sizeof(word));
+    if (word == 0) {
+      continue;
+    }
+    valid += __builtin_popcountll(word);
+
+    if (word == ~uint64_t(0)) {
+      for (size_t j = i; j < i + 64; j += W) {
+        V arr_r = V::load(arr + j);
+        min_r = V::min(min_r, arr_r);
+        max_r = V::max(max_r, arr_r);
+        nan_r = VI::increment(nan_r, V::isnan(arr_r));
+      }
+      continue;
+    }
+    for (size_t j = 0; j < 64; j += W) {
+      typename V::Mask m = V::fromBits(unsigned(word >> j) & lane_bits);
+      V arr_r = V::load(arr + i + j);
+      min_r = V::maskMin(m, min_r, arr_r);
+      max_r = V::maskMax(m, max_r, arr_r);
+      // Null lanes are replaced by 0, so that only valid NaNs are counted
+      nan_r = VI::increment(nan_r, V::isnan(V::select(m, arr_r, V::zero())));
+    }
+  }
+
+  float max_all = V::reduceMax(max_r);
+  float min_all = V::reduceMin(min_r);
+  size_t nans_all = VI::reduceAdd(nan_r);
+
+  auto is_valid = [=](size_t i) {
+    return validityBit(validity, validity_offset + i);
+  };
+  auto scalar = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      if (!is_valid(i)) {
+        continue;
+      }
+      valid++;
+      if (std::isnan(arr[i])) {
+        nans_all++;
+        continue;
+      }
+      minUpdate<policy>(arr[i], min_all);
+      maxUpdate<policy>(arr[i], max_all);
+    }
+  };
+  scalar(0, head);
+  scalar(limit, N);
+  // Nulls read as NaN, which the zero sign pass skips
+  minMaxZeroSignAt<policy>(
+      N, [=](size_t i) { return is_valid(i) ? arr[i] : NAN; }, min_all,
+      max_all);
+
+  *min = min_all;
+  *max = max_all;
+  minMaxFinish<policy>(valid, nans_all, min, max, nan_count);
+}
+
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxMaskedSSE(float const *const arr,
+                            uint8_t const *const validity, size_t const N,
+                            float *const min, float *const max,
+                            size_t *const nan_count = nullptr) {
+  minMaxMaskedVec<4, policy>(arr, validity, N, min, max, nan_count);
+}
+
+#ifdef __AVX2__
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxMaskedAVX(float const *const arr,
+                            uint8_t const *const validity, size_t const N,
+                            float *const min, float *const max,
+                            size_t *const nan_count = nullptr) {
+  minMaxMaskedVec<8, policy>(arr, validity, N, min, max, nan_count);
+}
+#endif
+
+#ifdef __AVX512F__
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxMaskedAVX512(float const *const arr,
+                               uint8_t const *const validity, size_t const N,
+                               float *const min, float *const max,
+                               size_t *const nan_count = nullptr) {
+  minMaxMaskedVec<16, policy>(arr, validity, N, min, max, nan_count);
+}
+#endif
+
+#ifdef SIMD_NEON
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxMaskedNEON(float const *const arr,
+                             uint8_t const *const validity, size_t const N,
+                             float *const min, float *const max,
+                             size_t *const nan_count = nullptr) {
+  minMaxMaskedVec<4, policy>(arr, validity, N, min, max, nan_count);
+}
+#endif
+
+template <NaNPolicy policy = NaNPolicy::Ignore>
+static void minMaxMaskedAuto(float const *const arr,
+                             uint8_t const *const validity, size_t const N,
+                             float *const min, float *const max,
+                             size_t *const nan_count = nullptr) {
+  minMaxMaskedVec<minMaxAutoWidth, policy>(arr, validity, N, min, max,
+                                           nan_count);
+}
+
+/*
+Zone maps (block skip indexes): the min and max of every block of "block"
+elements of arr, in the arrays mins and maxs of (N + block - 1) / block
+floats each, 8 bytes per block in all. Each block is one call to minMaxVec,
+whose loop is the one of minMaxAVX/minMaxAVX512, and the OpenMP version
+shares the blocks out among the threads.
+
+NaNs are ignored, and a block of NaNs gets the empty range [+inf, -inf]: a
+NaN is in no range, so only queries with infinite bounds return the block.
+
+zoneMapQueryVec writes to out the indices of the blocks whose [min, max]
+meets [lo, hi], i.e. which may contain an element of [lo, hi], in increasing
+order, and returns their number; out must have room for all the blocks. It
+compares W blocks at a time and compacts the indices with compressStore.
+*/
+static const size_t zoneMapBlock = 4096;
+
+template <int W>
+static void zoneMapVec(float const *const arr, size_t const N,
+                       size_t const block, float *const mins,
+                       float *const maxs) {
+  size_t blocks = (N + block - 1) / block;
+  for (size_t b = 0; b < blocks; b++) {
+    size_t begin = b * block;
+    minMaxVec<Vec<float, W>, NaNPolicy::Ignore>(
+        arr + begin, std::min(block, N - begin), &mins[b], &maxs[b], nullptr);
+    if (std::isnan(mins[b])) {
+      mins[b] = INFINITY;
+      maxs[b] = -INFINITY;
+    }
+  }
+}
+
+// Multithreaded version of zoneMapVec
+template <int W>
+static void zoneMapVecOMP(float const *const arr, size_t const N,
+                          size_t const block, float *const mins,
+                          float *const maxs) {
+  size_t blocks = (N + block - 1) / block;
+
+#pragma omp parallel for
+  for (size_t b = 0; b < blocks; b++) {
+    size_t begin = b * block;
+    zoneMapVec<W>(arr + begin, std::min(block, N - begin), block, &mins[b],
+                  &maxs[b]);
+  }
+}
+
+template <int W>
+static size_t zoneMapQueryVec(float const *const mins, float const *const maxs,
+                              size_t const blocks, float const lo,
+                              float const hi, int *const out) {
+  typedef Vec<float, W> V;
+  typedef Vec<int, W> VI;
+
+  const int lanes[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+  const unsigned lane_bits = (1u << W) - 1;
+  size_t limit = blocks / W * W;
+  size_t count = 0;
+
+  V lo_r = V::set1(lo);
+  V hi_r = V::set1(hi);
+  VI index_r = VI::load(lanes);
+  for (size_t b = 0; b < limit; b += W) {
+    // The blocks that end below lo or start above hi cannot match
+    unsigned skip = V::bits(V::lt(V::load(maxs + b), lo_r)) |
+                    V::bits(V::gt(V::load(mins + b), hi_r));
+    count += VI::compressStore(out + count, index_r,
+                               VI::fromBits(~skip & lane_bits));
+    index_r = VI::add(index_r, VI::set1(W));
+  }
+
+  for (size_t b = limit; b < blocks; b++) {
+    if (!(maxs[b] < lo) && !(mins[b] > hi)) {
+      out[count++] = b;
+    }
+  }
+  return count;
+}
+
+// Zone maps
+static inline void zoneMapSSE(float const *const arr, size_t const N,
+                              float *const mins, float *const maxs,
+                              size_t const block = zoneMapBlock) {
+  zoneMapVec<4>(arr, N, block, mins, maxs);
+}
+
+static inline void zoneMapSSEOMP(float const *const arr, size_t const N,
+                                 float *const mins, float *const maxs,
+                                 size_t const block = zoneMapBlock) {
+  zoneMapVecOMP<4>(arr, N, block, mins, maxs);
+}
+
+static inline size_t zoneMapQuerySSE(float const *const mins,
+                                     float const *const maxs,
+                                     size_t const blocks, float const lo,
+                                     float const hi, int *const out) {
+  return zoneMapQueryVec<4>(mins, maxs, blocks, lo, hi, out);
+}
+
+#ifdef __AVX2__
+static inline void zoneMapAVX(float const *const arr, size_t const N,
+                              float *const mins, float *const maxs,
+                              size_t const block = zoneMapBlock) {
+  zoneMapVec<8>(arr, N, block, mins, maxs);
+}
+
+static inline void zoneMapAVXOMP(float const *const arr, size_t const N,
+                                 float *const mins, float *const maxs,
+                                 size_t const block = zoneMapBlock) {
+  zoneMapVecOMP<8>(arr, N, block, mins, maxs);
+}
+
+static inline size_t zoneMapQueryAVX(float const *const mins,
+                                     float const *const maxs,
+                                     size_t const blocks, float const lo,
+                                     float const hi, int *const out) {
+  return zoneMapQueryVec<8>(mins, maxs, blocks, lo, hi, out);
+}
+#endif
+
+#ifdef __AVX512F__
+static inline void zoneMapAVX512(float const *const arr, size_t const N,
+                                 float *const mins, float *const maxs,
+                                 size_t const block = zoneMapBlock) {
+  zoneMapVec<16>(arr, N, block, mins, maxs);
+}
+
+static inline void zoneMapAVX512OMP(float const *const arr, size_t const N,
+                                    float *const mins, float *const maxs,
+                                    size_t const block = zoneMapBlock) {
+  zoneMapVecOMP<16>(arr, N, block, mins, maxs);
+}
+
+static inline size_t zoneMapQueryAVX512(float const *const mins,
+                                        float const *const maxs,
+                                        size_t const blocks, float const lo,
+                                        float const hi, int *const out) {
+  return zoneMapQueryVec<16>(mins, maxs, blocks, lo, hi, out);
+}
+#endif
+
+#ifdef SIMD_NEON
+static inline void zoneMapNEON(float const *const arr, size_t const N,
+                               float *const mins, float *const maxs,
+                               size_t const block = zoneMapBlock) {
+  zoneMapVec<4>(arr, N, block, mins, maxs);
+}
+
+static inline void zoneMapNEONOMP(float const *const arr, size_t const N,
+                                  float *const mins, float *const maxs,
+                                  size_t const block = zoneMapBlock) {
+  zoneMapVecOMP<4>(arr, N, block, mins, maxs);
+}
+
+static inline size_t zoneMapQueryNEON(float const *const mins,
+                                      float const *const maxs,
+                                      size_t const blocks, float const lo,
+                                      float const hi, int *const out) {
+  return zoneMapQueryVec<4>(mins, maxs, blocks, lo, hi, out);
+}
+#endif
+
+static inline void zoneMapAuto(float const *const arr, size_t const N,
+                               float *const mins, float *const maxs,
+                               size_t const block = zoneMapBlock) {
+  zoneMapVec<minMaxAutoWidth>(arr, N, block, mins, maxs);
+}
+
+static inline void zoneMapAutoOMP(float const *const arr, size_t const N,
+                                  float *const mins, float *const maxs,
+                                  size_t const block = zoneMapBlock) {
+  zoneMapVecOMP<minMaxAutoWidth>(arr, N, block, mins, maxs);
+}
+
+static inline size_t zoneMapQueryAuto(float const *const mins,
+                                      float const *const maxs,
+                                      size_t const blocks, float const lo,
+                                      float const hi, int *const out) {
+  return zoneMapQueryVec<minMaxAutoWidth>(mins, maxs, blocks, lo, hi, out);
+}
+
+/*
+Sliding-window min and max: out[i] is the min (max) of arr[i, i + w), for
+the N - w + 1 windows of w elements in arr, and nothing is written when w is
+0 or above N. The floats must not be NaN; a window holding one gets an
+unspecified result.
+
+The van Herk/Gil-Werman algorithm cuts arr into blocks of w elements and
+takes, for every element, the min of its block from it on (the suffix) and
+up to it (the prefix). The window starting at i is the suffix of its block
+from i and the prefix of the next block up to i + w - 1, so
+out[i] = min(suffix[i], prefix[i + w - 1]): three steps per element
+whatever w. Both passes go a vector at a time, with an in-register scan of
+log2(W) shift and min steps (shiftUp for the prefix, shiftDown for the
+suffix, run backward) and the min of the vector before carried across, and
+the prefix pass combines with the suffix as it goes.
+
+Windows of up to slidingDirectMax elements are instead the min of w
+shifted loads, which is cheaper than the passes. The array is done in
+pieces of about slidingChunk elements, whole blocks each, so that the
+suffixes stay in cache. The OpenMP versions run the pieces in parallel.
+*/
+static const size_t slidingDirectMax = 8;
+static const size_t slidingChunk = 1 << 14;
+
+template <bool is_max, typename V> static inline V minOrMax(V a, V b) {
+  return is_max ? V::max(a, b) : V::min(a, b);
+}
+
+// Lane i gets the min (max) of lanes 0 to i (prefix) or i to W - 1 (suffix)
+template <bool is_max, bool suffix, typename V, int k = 1>
+static inline V scanMinMax(V a) {
+  if constexpr (k < V::width) {
+    // The lanes shifted in are replaced by the lane itself
+    const unsigned lanes = (1u << V::width) - 1;
+    V shifted = V::select(
+        V::fromBits(suffix ? lanes >> k : (lanes << k) & lanes),
+        suffix ? V::template shiftDown<k>(a) : V::template shiftUp<k>(a), a);
+    return scanMinMax<is_max, suffix, V, 2 * k>(minOrMax<is_max>(a, shifted));
+  } else {
+    return a;
+  }
+}
+
+/*
+The windows starting in [begin, end), begin a multiple of w. scratch has
+room for the suffixes of the blocks covering them, end - begin + w elements.
+*/
+template <int W, bool is_max, typename T>
+static void slidingMinMaxRange(T const *const arr, size_t const N,
+                               size_t const w, size_t const begin,
+                               size_t const end, T *const out,
+                               T *const scratch) {
+  typedef Vec<T, W> V;
+
+  if (w <= slidingDirectMax) {
+    size_t limit = begin + (end - begin) / W * W;
+    for (size_t i = begin; i < limit; i += W) {
+      V out_r = V::load(arr + i);
+      for (size_t k = 1; k < w; k++) {
+        out_r = minOrMax<is_max>(out_r, V::load(arr + i + k));
+      }
+      V::store(out + i, out_r);
+    }
+    for (size_t i = limit; i < end; i++) {
+      T x = arr[i];
+      for (size_t k = 1; k < w; k++) {
+        x = is_max ? std::max(x, arr[i + k]) : std::min(x, arr[i + k]);
+      }
+      out[i] = x;
+    }
+    return;
+  }
+
+  auto op = [](T a, T b) { return is_max ? std::max(a, b) : std::min(a, b); };
+  for (size_t s = begin; s < end; s += w) {
+    // Suffixes of the block [s, e), backward; the front is done last
+    T *suffix = scratch + (s - begin);
+    size_t e = std::min(s + w, N);
+    size_t n = e - s;
+    size_t front = n % W;
+    V carry_r = V::set1(arr[e - 1]);
+    for (size_t i = n; i > front; i -= W) {
+      V x_r = scanMinMax<is_max, true>(V::load(arr + s + i - W));
+      x_r = minOrMax<is_max>(x_r, carry_r);
+      V::store(suffix + i - W, x_r);
+      carry_r = V::broadcastFirst(x_r);
+    }
+    T carry = n > front ? suffix[front] : arr[e - 1];
+    for (size_t i = front; i-- > 0;) {
+      carry = op(carry, arr[s + i]);
+      suffix[i] = carry;
+    }
+
+    // The window at s is the block itself; the next w - 1 windows end in
+    // the block [s + w, s + 2w), and take its prefixes
+    out[s] = suffix[0];
+    size_t m = std::min(w - 1, end - s - 1);
+    // Past the last window, the next block starts at or beyond arr + N
+    if (m == 0) {
+      continue;
+    }
+    T const *next = arr + s + w;
+    size_t limit = m / W * W;
+    carry_r = V::set1(next[0]);
+    for (size_t i = 0; i < limit; i += W) {
+      V x_r = scanMinMax<is_max, false>(V::load(next + i));
+      x_r = minOrMax<is_max>(x_r, carry_r);
+      carry_r = V::broadcastLast(x_r);
+      V::store(out + s + 1 + i,
+               minOrMax<is_max>(x_r, V::load(suffix + 1 + i)));
+    }
+    T lanes[W];
+    V::store(lanes, carry_r);
+    carry = lanes[0];
+    for (size_t i = limit; i < m; i++) {
+      carry = op(carry, next[i]);
+      out[s + 1 + i] = op(carry, suffix[1 + i]);
+    }
+  }
+}
+
+template <int W, bool is_max, typename T>
+static void slidingMinMaxVec(T const *const arr, size_t const N,
+                             size_t const w, T *const out) {
+  if (w == 0 || w > N) {
+    return;
+  }
+  size_t windows = N - w + 1;
+  size_t chunk = std::max(w, slidingChunk / w * w);
+  std::vector<T> scratch(w > slidingDirectMax ? chunk + w : 0);
+  for (size_t begin = 0; begin < windows; begin += chunk) {
+    slidingMinMaxRange<W, is_max>(arr, N, w, begin,
+                                  std::min(windows, begin + chunk), out,
+                                  scratch.data());
+  }
+}
+
+// Multithreaded version of slidingMinMaxVec
+template <int W, bool is_max, typename T>
+static void slidingMinMaxVecOMP(T const *const arr, size_t const N,
+                                size_t const w, T *const out) {
+  if (w == 0 || w > N) {
+    return;
+  }
+  size_t windows = N - w + 1;
+  size_t chunk = std::max(w, slidingChunk / w * w);
+  size_t pieces = (windows + chunk - 1) / chunk;
+
+#pragma omp parallel
+  {
+    std::vector<T> scratch(w > slidingDirectMax ? chunk + w : 0);
+#pragma omp for
+    for (size_t p = 0; p < pieces; p++) {
+      size_t begin = p * chunk;
+      slidingMinMaxRange<W, is_max>(arr, N, w, begin,
+                                    std::min(windows, begin + chunk), out,
+                                    scratch.data());
+    }
+  }
+}
+
+// Sliding-window kernels for int and float
+template <typename T>
+static inline void slidingMinSSE(T const *const arr, size_t const N,
+                                 size_t const w, T *const out) {
+  slidingMinMaxVec<4, false>(arr, N, w, out);
+}
+
+template <typename T>
+static inline void slidingMaxSSE(T const *const arr, size_t const N,
+                                 size_t const w, T *const out) {
+  slidingMinMaxVec<4, true>(arr, N, w, out);
+}
+
+template <typename T>
+static inline void slidingMinSSEOMP(T const *const arr, size_t const N,
+                                    size_t const w, T *const out) {
+  slidingMinMaxVecOMP<4, false>(arr, N, w, out);
+}
+
+template <typename T>
+static inline void slidingMaxSSEOMP(T const *const arr, size_t const N,
+                                    size_t const w, T *const out) {
+  slidingMinMaxVecOMP<4, true>(arr, N, w, out);
+}
+
+#ifdef __AVX2__
+template <typename T>
+static inline void slidingMinAVX2(T const *const arr, size_t const N,
+                                  size_t const w, T *const out) {
+  slidingMinMaxVec<8, false>(arr, N, w, out);
+}
+
+template <typename T>
+static inline void slidingMaxAVX2(T const *const arr, size_t const N,
+                                  size_t const w, T *const out) {
+  slidingMinMaxVec<8, true>(arr, N, w, out);
+}
+
+template <typename T>
+static inline void slidingMinAVX2OMP(T const *const arr, size_t const N,
+                                     size_t const w, T *const out) {
+  slidingMinMaxVecOMP<8, false>(arr, N, w, out);
+}
+
+template <typename T>
+static inline void slidingMaxAVX2OMP(T const *const arr, size_t const N,
+                                     size_t const w, T *const out) {
+  slidingMinMaxVecOMP<8, true>(arr, N, w, out);
+}
+#endif
+
+#ifdef __AVX512F__
+template <typename T>
+static inline void slidingMinAVX512(T const *const arr, size_t const N,
+                                    size_t const w, T *const out) {
+  slidingMinMaxVec<16, false>(arr, N, w, out);
+}
+
+template <typename T>
+static inline void slidingMaxAVX512(T const *const arr, size_t const N,
+                                    size_t const w, T *const out) {
+  slidingMinMaxVec<16, true>(arr, N, w, out);
+}
+
+template <typename T>
+static inline void slidingMinAVX512OMP(T const *const arr, size_t const N,
+                                       size_t const w, T *const out) {
+  slidingMinMaxVecOMP<16, false>(arr, N, w, out);
+}
+
+template <typename T>
+static inline void slidingMaxAVX512OMP(T const *const arr, size_t const N,
+                                       size_t const w, T *const out) {
+  slidingMinMaxVecOMP<16, true>(arr, N, w, out);
+}
+#endif
+
+#ifdef SIMD_NEON
+template <typename T>
+static inline void slidingMinNEON(T const *const arr, size_t const N,
+                                  size_t const w, T *const out) {
+  slidingMinMaxVec<4, false>(arr, N, w, out);
+}
+
+template <typename T>
+static inline void slidingMaxNEON(T const *const arr, size_t const N,
+                                  size_t const w, T *const out) {
+  slidingMinMaxVec<4, true>(arr, N, w, out);
+}
+
+template <typename T>
+static inline void slidingMinNEONOMP(T const *const arr, size_t const N,
+                                     size_t const w, T *const out) {
+  slidingMinMaxVecOMP<4, false>(arr, N, w, out);
+}
+
+template <typename T>
+static inline void slidingMaxNEONOMP(T const *const arr, size_t const N,
+                                     size_t const w, T *const out) {
+  slidingMinMaxVecOMP<4, true>(arr, N, w, out);
+}
+#endif
+
+template <typename T>
+static inline void slidingMinAuto(T const *const arr, size_t const N,
+                                  size_t const w, T *const out) {
+  slidingMinMaxVec<minMaxAutoWidth, false>(arr, N, w, out);
+}
+
+template <typename T>
+static inline void slidingMinAutoOMP(T const *const arr, size_t const N,
+                                     size_t const w, T *const out) {
+  slidingMinMaxVecOMP<minMaxAutoWidth, false>(arr, N, w, out);
+}
+
+template <typename T>
+static inline void slidingMaxAuto(T const *const arr, size_t const N,
+                                  size_t const w, T *const out) {
+  slidingMinMaxVec<minMaxAutoWidth, true>(arr, N, w, out);
+}
+
+template <typename T>
+static inline void slidingMaxAutoOMP(T const *const arr, size_t const N,
+                                     size_t const w, T *const out) {
+  slidingMinMaxVecOMP<minMaxAutoWidth, true>(arr, N, w, out);
+}
+
+/*
+Min-max normalization: out[i] = (arr[i] - min) * inv_range with
+inv_range = 1 / (max - min), rescaling arr to [0, 1]. NaNs are ignored when
+finding min and max and stay NaN in out. If all numbers are equal out is 0
+for them. out may be arr for an in-place rescale.
+
+The rescale cannot start before the min-max pass has seen the whole array,
+so the two passes cannot be fused. The blocked and threaded versions instead
+run the min-max pass over blocks of normalizeBlock elements (256 KiB, which
+fits in L2) from the last block to the first, and the rescale from the first
+to the last, so the rescale starts on the blocks the min-max pass touched
+most recently and that are still cached. The threaded version runs both
+passes in one parallel region, and each thread rescales the blocks it
+scanned, from its own cache.
+*/
+static const size_t normalizeBlock = 1 << 16;
+
+// 1 / (max - min), or 0 if the range is empty so that the output is 0
+static inline float normalizeScale(float const min, float const max) {
+  float range = max - min;
+  return range > 0.0f ? 1.0f / range : 0.0f;
+}
+
+/*
+Rescales the elements [begin, end) of arr into out. The product can round to
+one ulp above 1, so it is clamped at 1; NaN compares false and is kept.
+*/
+template <typename V>
+static inline void normalizeRange(float const *const arr, size_t const begin,
+                                  size_t const end, float const min,
+                                  float const inv_range, float *const out) {
+  const int simd_width = V::width;
+  size_t limit = begin + (end - begin) / simd_width * simd_width;
+
+  V min_r = V::set1(min);
+  V inv_range_r = V::set1(inv_range);
+  V one_r = V::set1(1.0f);
+
+  for (size_t i = begin; i < limit; i += simd_width) {
+    V arr_r = V::mul(V::sub(V::load(arr + i), min_r), inv_range_r);
+
+    V::store(out + i, V::select(V::gt(arr_r, one_r), one_r, arr_r));
+  }
+
+  // Rescaling the remaining elements
+  for (size_t i = limit; i < end; i++) {
+    float x = (arr[i] - min) * inv_range;
+    out[i] = x > 1.0f ? 1.0f : x;
+  }
+}
+
+// Two-phase normalization, written once for any Vec<float, W>
+template <typename V>
+static void normalizeVec(float const *const arr, size_t const N,
+                         float *const out) {
+  float min, max;
+  minMaxVec<V, NaNPolicy::Ignore>(arr, N, &min, &max, nullptr);
+
+  normalizeRange<V>(arr, 0, N, min, normalizeScale(min, max), out);
+}
+
+// Blocked version of normalizeVec, see above
+template <typename V>
+static void normalizeBlockedVec(float const *const arr, size_t const N,
+                                float *const out) {
+  size_t blocks = (N + normalizeBlock - 1) / normalizeBlock;
+
+  float min_all = INFINITY;
+  float max_all = -INFINITY;
+
+  for (size_t b = blocks; b-- > 0;) {
+    size_t begin = b * normalizeBlock;
+    float min, max;
+    minMaxVec<V, NaNPolicy::Ignore>(arr + begin,
+                                    std::min(normalizeBlock, N - begin), &min,
+                                    &max, nullptr);
+    minUpdate<NaNPolicy::Ignore>(min, min_all);
+    maxUpdate<NaNPolicy::Ignore>(max, max_all);
+  }
+
+  float inv_range = normalizeScale(min_all, max_all);
+
+  for (size_t b = 0; b < blocks; b++) {
+    size_t begin = b * normalizeBlock;
+    normalizeRange<V>(arr, begin, std::min(begin + normalizeBlock, N),
+                      min_all, inv_range, out);
+  }
+}
+
+// Multithreaded version of normalizeBlockedVec
+template <typename V>
+static void normalizeVecOMP(float const *const arr, size_t const N,
+                            float *const out) {
+  size_t blocks = (N + normalizeBlock - 1) / normalizeBlock;
+
+  float min_all = INFINITY;
+  float max_all = -INFINITY;
+
+#pragma omp parallel
+  {
+    float min_local = INFINITY;
+    float max_local = -INFINITY;
+    // The blocks [first, last] given to this thread by the static schedule
+    size_t first = blocks;
+    size_t last = 0;
+
+#pragma omp for schedule(static) nowait
+    for (size_t i = 0; i < blocks; i++) {
+      size_t b = blocks - 1 - i;
+      size_t begin = b * normalizeBlock;
+      float min, max;
+      minMaxVec<V, NaNPolicy::Ignore>(arr + begin,
+                                      std::min(normalizeBlock, N - begin),
+                                      &min, &max, nullptr);
+      minUpdate<NaNPolicy::Ignore>(min, min_local);
+      maxUpdate<NaNPolicy::Ignore>(max, max_local);
+      first = std::min(first, b);
+      last = std::max(last, b);
+    }
+
+#pragma omp critical
+    {
+      minUpdate<NaNPolicy::Ignore>(min_local, min_all);
+      maxUpdate<NaNPolicy::Ignore>(max_local, max_all);
+    }
+#pragma omp barrier
+
+    float inv_range = normalizeScale(min_all, max_all);
+
+    for (size_t b = first; b <= last && b < blocks; b++) {
+      size_t begin = b * normalizeBlock;
+      normalizeRange<V>(arr, begin, std::min(begin + normalizeBlock, N),
+                        min_all, inv_range, out);
+    }
+  }
+}
+
+// Normalization kernels
+static inline void normalizeSSE(float const *const arr, size_t const N,
+                                float *const out) {
+  normalizeVec<Vec<float, 4>>(arr, N, out);
+}
+
+static inline void normalizeSSEBlocked(float const *const arr, size_t const N,
+                                       float *const out) {
+  normalizeBlockedVec<Vec<float, 4>>(arr, N, out);
+}
+
+static inline void normalizeSSEOMP(float const *const arr, size_t const N,
+                                   float *const out) {
+  normalizeVecOMP<Vec<float, 4>>(arr, N, out);
+}
+
+#ifdef __AVX2__
+static inline void normalizeAVX(float const *const arr, size_t const N,
+                                float *const out) {
+  normalizeVec<Vec<float, 8>>(arr, N, out);
+}
+
+static inline void normalizeAVXBlocked(float const *const arr, size_t const N,
+                                       float *const out) {
+  normalizeBlockedVec<Vec<float, 8>>(arr, N, out);
+}
+
+static inline void normalizeAVXOMP(float const *const arr, size_t const N,
+                                   float *const out) {
+  normalizeVecOMP<Vec<float, 8>>(arr, N, out);
+}
+#endif
+
+#ifdef __AVX512F__
+static inline void normalizeAVX512(float const *const arr, size_t const N,
+                                   float *const out) {
+  normalizeVec<Vec<float, 16>>(arr, N, out);
+}
+
+static inline void normalizeAVX512Blocked(float const *const arr,
+                                          size_t const N, float *const out) {
+  normalizeBlockedVec<Vec<float, 16>>(arr, N, out);
+}
+
+static inline void normalizeAVX512OMP(float const *const arr, size_t const N,
+                                      float *const out) {
+  normalizeVecOMP<Vec<float, 16>>(arr, N, out);
+}
+#endif
+
+#ifdef SIMD_NEON
+static inline void normalizeNEON(float const *const arr, size_t const N,
+                                 float *const out) {
+  normalizeVec<Vec<float, 4>>(arr, N, out);
+}
+
+static inline void normalizeNEONBlocked(float const *const arr,
+                                        size_t const N, float *const out) {
+  normalizeBlockedVec<Vec<float, 4>>(arr, N, out);
+}
+
+static inline void normalizeNEONOMP(float const *const arr, size_t const N,
+                                    float *const out) {
+  normalizeVecOMP<Vec<float, 4>>(arr, N, out);
+}
+#endif
+
+// Normalization dispatchers, in order of preference NEON, AVX-512, AVX2, SSE
+static inline void normalizeAuto(float const *const arr, size_t const N,
+                                 float *const out) {
+#ifdef SIMD_NEON
+  normalizeNEONBlocked(arr, N, out);
+#elif defined(__AVX512F__)
+  normalizeAVX512Blocked(arr, N, out);
+#elif defined(__AVX2__)
+  normalizeAVXBlocked(arr, N, out);
+#else
+  normalizeSSEBlocked(arr, N, out);
+#endif
+}
+
+static inline void normalizeAutoOMP(float const *const arr, size_t const N,
+                                    float *const out) {
+#ifdef SIMD_NEON
+  normalizeNEONOMP(arr, N, out);
+#elif defined(__AVX512F__)
+  normalizeAVX512OMP(arr, N, out);
+#elif defined(__AVX2__)
+  normalizeAVXOMP(arr, N, out);
+#else
+  normalizeSSEOMP(arr, N, out);
+#endif
+}
+
+/*
+How the float sum kernels add up the array.
+
+Fast         : each thread keeps several vector accumulators and the partial
+               sums are combined in whatever order the threads finish, so the
+               last bits of the result depend on the ISA and thread count.
+Reproducible : the array is cut into fixed blocks of sumBlock elements and
+               every block is summed in the same order whatever the vector
+               width (see sumBlockReproducible). Block sums are added in
+               double in block order, so the result is bitwise identical for
+               every ISA and thread count.
+*/
+enum class SumMode { Fast, Reproducible };
+
+// Elements per block and virtual lanes per block of the reproducible sum
+static const size_t sumBlock = 4096;
+static const int sumLanes = 32;
+
+/*
+Sum of n <= sumBlock floats in a fixed order: element i is added to virtual
+lane i % sumLanes, and the lanes are combined by a fixed pairwise tree. The
+sumLanes lanes are held in sumLanes / V::width registers, so every width
+performs exactly the same float additions.
+*/
+template <typename V>
+static inline float sumBlockReproducible(float const *const arr,
+                                         size_t const n) {
+  const int simd_width = V::width;
+  const int regs = sumLanes / simd_width;
+  size_t limit = n / sumLanes * sumLanes;
+
+  V acc[regs];
+  for (int r = 0; r < regs; r++) {
+    acc[r] = V::zero();
+  }
+
+  for (size_t i = 0; i < limit; i += sumLanes) {
+    for (int r = 0; r < regs; r++) {
+      acc[r] = V::add(acc[r], V::load(arr + i + r * simd_width));
+    }
+  }
+
+  float lanes[sumLanes];
+  for (int r = 0; r < regs; r++) {
+    V::store(lanes + r * simd_width, acc[r]);
+  }
+
+  // The remainder goes to the lanes it would have reached in a full row
+  for (size_t i = limit; i < n; i++) {
+    lanes[i - limit] += arr[i];
+  }
+
+  for (int w = sumLanes / 2; w > 0; w /= 2) {
+    for (int j = 0; j < w; j++) {
+      lanes[j] += lanes[j + w];
+    }
+  }
+  return lanes[0];
+}
+
+/*
+Sum of N floats, written once for any Vec<float, W>.
+The fast mode uses four independent accumulators to hide the latency of the
+vector add.
+*/
+template <typename V, SumMode mode>
+static float sumVec(float const *const arr, size_t const N) {
+  if (mode == SumMode::Reproducible) {
+    double sum = 0;
+    for (size_t b = 0; b < N; b += sumBlock) {
+      sum += sumBlockReproducible<V>(arr + b, std::min(sumBlock, N - b));
+    }
+    return sum;
+  }
+
+  const int simd_width = V::width;
+  const size_t step = 4 * simd_width;
+  size_t limit = N / step * step;
+
+  V sum0_r = V::zero();
+  V sum1_r = V::zero();
+  V sum2_r = V::zero();
+  V sum3_r = V::zero();
+
+  for (size_t i = 0; i < limit; i += step) {
+    sum0_r = V::add(sum0_r, V::load(arr + i));
+    sum1_r = V::add(sum1_r, V::load(arr + i + simd_width));
+    sum2_r = V::add(sum2_r, V::load(arr + i + 2 * simd_width));
+    sum3_r = V::add(sum3_r, V::load(arr + i + 3 * simd_width));
+  }
+
+  float sum = V::reduceAdd(
+      V::add(V::add(sum0_r, sum1_r), V::add(sum2_r, sum3_r)));
+
+  // Adding the remaining elements
+  for (size_t i = limit; i < N; i++) {
+    sum += arr[i];
+  }
+  return sum;
+}
+
+// Multithreaded version of sumVec. Partial sums are combined in double.
+template <typename V, SumMode mode>
+static float sumVecOMP(float const *const arr, size_t const N) {
+  if (mode == SumMode::Reproducible) {
+    size_t blocks = (N + sumBlock - 1) / sumBlock;
+    std::vector<float> block_sums(blocks);
+
+#pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < blocks; b++) {
+      size_t begin = b * sumBlock;
+      block_sums[b] =
+          sumBlockReproducible<V>(arr + begin, std::min(sumBlock, N - begin));
+    }
+
+    // Same order as the single threaded loop in sumVec
+    double sum = 0;
+    for (size_t b = 0; b < blocks; b++) {
+      sum += block_sums[b];
+    }
+    return sum;
+  }
+
+  const int simd_width = V::width;
+  const size_t step = 4 * simd_width;
+  size_t limit = N / step * step;
+
+  double sum = 0;
+
+#pragma omp parallel
+  {
+    V sum0_r = V::zero();
+    V sum1_r = V::zero();
+    V sum2_r = V::zero();
+    V sum3_r = V::zero();
+
+#pragma omp for nowait
+    for (size_t i = 0; i < limit; i += step) {
+      sum0_r = V::add(sum0_r, V::load(arr + i));
+      sum1_r = V::add(sum1_r, V::load(arr + i + simd_width));
+      sum2_r = V::add(sum2_r, V::load(arr + i + 2 * simd_width));
+      sum3_r = V::add(sum3_r, V::load(arr + i + 3 * simd_width));
+    }
+
+    float sum_local = V::reduceAdd(
+        V::add(V::add(sum0_r, sum1_r), V::add(sum2_r, sum3_r)));
+
+#pragma omp critical
+    sum += sum_local;
+  }
+
+  // Adding the remaining elements
+  for (size_t i = limit; i < N; i++) {
+    sum += arr[i];
+  }
+  return sum;
+}
+
+/*
+Sum of N ints, written once for any Vec<int, W>.
+Every lane is widened to 64 bits before it is added, so the result is exact
+for any N that fits in memory. Integer addition is associative, so there is
+no separate reproducible mode.
+*/
+template <typename V>
+static int64_t sumIntVec(int const *const arr, size_t const N) {
+  const int simd_width = V::width;
+  const size_t step = 2 * simd_width;
+  size_t limit = N / step * step;
+
+  typename V::Wide sum0_r = V::zeroWide();
+  typename V::Wide sum1_r = V::zeroWide();
+
+  for (size_t i = 0; i < limit; i += step) {
+    sum0_r = V::addWide(sum0_r, V::load(arr + i));
+    sum1_r = V::addWide(sum1_r, V::load(arr + i + simd_width));
+  }
+
+  int64_t sum = V::reduceWide(sum0_r) + V::reduceWide(sum1_r);
+
+  // Adding the remaining elements
+  for (size_t i = limit; i < N; i++) {
+    sum += arr[i];
+  }
+  return sum;
+}
+
+// Multithreaded version of sumIntVec
+template <typename V>
+static int64_t sumIntVecOMP(int const *const arr, size_t const N) {
+  const int simd_width = V::width;
+  const size_t step = 2 * simd_width;
+  size_t limit = N / step * step;
+
+  int64_t sum = 0;
+
+#pragma omp parallel reduction(+ : sum)
+  {
+    typename V::Wide sum0_r = V::zeroWide();
+    typename V::Wide sum1_r = V::zeroWide();
+
+#pragma omp for nowait
+    for (size_t i = 0; i < limit; i += step) {
+      sum0_r = V::addWide(sum0_r, V::load(arr + i));
+      sum1_r = V::addWide(sum1_r, V::load(arr + i + simd_width));
+    }
+
+    sum += V::reduceWide(sum0_r) + V::reduceWide(sum1_r);
+  }
+
+  // Adding the remaining elements
+  for (size_t i = limit; i < N; i++) {
+    sum += arr[i];
+  }
+  return sum;
+}
+
+// 128-bit sum kernels
+template <SumMode mode = SumMode::Fast>
+static float sumSSE(float const *const arr, size_t const N) {
+  return sumVec<Vec<float, 4>, mode>(arr, N);
+}
+
+template <SumMode mode = SumMode::Fast>
+static float sumSSEOMP(float const *const arr, size_t const N) {
+  return sumVecOMP<Vec<float, 4>, mode>(arr, N);
+}
+
+static inline int64_t sumSSE(int const *const arr, size_t const N) {
+  return sumIntVec<Vec<int, 4>>(arr, N);
+}
+
+static inline int64_t sumSSEOMP(int const *const arr, size_t const N) {
+  return sumIntVecOMP<Vec<int, 4>>(arr, N);
+}
+
+#ifdef __AVX2__
+template <SumMode mode = SumMode::Fast>
+static float sumAVX2(float const *const arr, size_t const N) {
+  return sumVec<Vec<float, 8>, mode>(arr, N);
+}
+
+template <SumMode mode = SumMode::Fast>
+static float sumAVX2OMP(float const *const arr, size_t const N) {
+  return sumVecOMP<Vec<float, 8>, mode>(arr, N);
+}
+
+static inline int64_t sumAVX2(int const *const arr, size_t const N) {
+  return sumIntVec<Vec<int, 8>>(arr, N);
+}
+
+static inline int64_t sumAVX2OMP(int const *const arr, size_t const N) {
+  return sumIntVecOMP<Vec<int, 8>>(arr, N);
+}
+#endif
+
+#ifdef __AVX512F__
+template <SumMode mode = SumMode::Fast>
+static float sumAVX512(float const *const arr, size_t const N) {
+  return sumVec<Vec<float, 16>, mode>(arr, N);
+}
+
+template <SumMode mode = SumMode::Fast>
+static float sumAVX512OMP(float const *const arr, size_t const N) {
+  return sumVecOMP<Vec<float, 16>, mode>(arr, N);
+}
+
+static inline int64_t sumAVX512(int const *const arr, size_t const N) {
+  return sumIntVec<Vec<int, 16>>(arr, N);
+}
+
+static inline int64_t sumAVX512OMP(int const *const arr, size_t const N) {
+  return sumIntVecOMP<Vec<int, 16>>(arr, N);
+}
+#endif
+
+#ifdef SIMD_NEON
+template <SumMode mode = SumMode::Fast>
+static float sumNEON(float const *const arr, size_t const N) {
+  return sumVec<Vec<float, 4>, mode>(arr, N);
+}
+
+template <SumMode mode = SumMode::Fast>
+static float sumNEONOMP(float const *const arr, size_t const N) {
+  return sumVecOMP<Vec<float, 4>, mode>(arr, N);
+}
+
+static inline int64_t sumNEON(int const *const arr, size_t const N) {
+  return sumIntVec<Vec<int, 4>>(arr, N);
+}
+
+static inline int64_t sumNEONOMP(int const *const arr, size_t const N) {
+  return sumIntVecOMP<Vec<int, 4>>(arr, N);
+}
+#endif
+
+// Sum dispatchers, in order of preference NEON, AVX-512, AVX2, SSE
+template <SumMode mode = SumMode::Fast>
+static float sumAuto(float const *const arr, size_t const N) {
+#ifdef SIMD_NEON
+  return sumNEON<mode>(arr, N);
+#elif defined(__AVX512F__)
+  return sumAVX512<mode>(arr, N);
+#elif defined(__AVX2__)
+  return sumAVX2<mode>(arr, N);
+#else
+  return sumSSE<mode>(arr, N);
+#endif
+}
+
+template <SumMode mode = SumMode::Fast>
+static float sumAutoOMP(float const *const arr, size_t const N) {
+#ifdef SIMD_NEON
+  return sumNEONOMP<mode>(arr, N);
+#elif defined(__AVX512F__)
+  return sumAVX512OMP<mode>(arr, N);
+#elif defined(__AVX2__)
+  return sumAVX2OMP<mode>(arr, N);
+#else
+  return sumSSEOMP<mode>(arr, N);
+#endif
+}
+
+static inline int64_t sumAuto(int const *const arr, size_t const N) {
+#ifdef SIMD_NEON
+  return sumNEON(arr, N);
+#elif defined(__AVX512F__)
+  return sumAVX512(arr, N);
+#elif defined(__AVX2__)
+  return sumAVX2(arr, N);
+#else
+  return sumSSE(arr, N);
+#endif
+}
+
+static inline int64_t sumAutoOMP(int const *const arr, size_t const N) {
+#ifdef SIMD_NEON
+  return sumNEONOMP(arr, N);
+#elif defined(__AVX512F__)
+  return sumAVX512OMP(arr, N);
+#elif defined(__AVX2__)
+  return sumAVX2OMP(arr, N);
+#else
+  return sumSSEOMP(arr, N);
+#endif
+}
+
+// Arithmetic mean, NaN for an empty array
+template <SumMode mode = SumMode::Fast>
+static double meanAuto(float const *const arr, size_t const N) {
+  return double(sumAuto<mode>(arr, N)) / N;
+}
+
+template <SumMode mode = SumMode::Fast>
+static double meanAutoOMP(float const *const arr, size_t const N) {
+  return double(sumAutoOMP<mode>(arr, N)) / N;
+}
+
+static inline double meanAuto(int const *const arr, size_t const N) {
+  return double(sumAuto(arr, N)) / N;
+}
+
+static inline double meanAutoOMP(int const *const arr, size_t const N) {
+  return double(sumAutoOMP(arr, N)) / N;
+}
+
+/*
+Dot product of two arrays of N floats, written once for any Vec<float, W>.
+Four independent accumulators hide the latency of the multiply-add.
+*/
+template <typename V>
+static float dotVec(float const *const a, float const *const b,
+                    size_t const N) {
+  const int simd_width = V::width;
+  const size_t step = 4 * simd_width;
+  size_t limit = N / step * step;
+
+  V sum0_r = V::zero();
+  V sum1_r = V::zero();
+  V sum2_r = V::zero();
+  V sum3_r = V::zero();
+
+  for (size_t i = 0; i < limit; i += step) {
+    sum0_r = V::fmadd(V::load(a + i), V::load(b + i), sum0_r);
+    sum1_r = V::fmadd(V::load(a + i + simd_width),
+                      V::load(b + i + simd_width), sum1_r);
+    sum2_r = V::fmadd(V::load(a + i + 2 * simd_width),
+                      V::load(b + i + 2 * simd_width), sum2_r);
+    sum3_r = V::fmadd(V::load(a + i + 3 * simd_width),
+                      V::load(b + i + 3 * simd_width), sum3_r);
+  }
+
+  float sum = V::reduceAdd(
+      V::add(V::add(sum0_r, sum1_r), V::add(sum2_r, sum3_r)));
+
+  // Adding the remaining products
+  for (size_t i = limit; i < N; i++) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+// Multithreaded version of dotVec. Partial sums are combined in double.
+template <typename V>
+static float dotVecOMP(float const *const a, float const *const b,
+                       size_t const N) {
+  const int simd_width = V::width;
+  const size_t step = 4 * simd_width;
+  size_t limit = N / step * step;
+
+  double sum = 0;
+
+#pragma omp parallel
+  {
+    V sum0_r = V::zero();
+    V sum1_r = V::zero();
+    V sum2_r = V::zero();
+    V sum3_r = V::zero();
+
+#pragma omp for nowait
+    for (size_t i = 0; i < limit; i += step) {
+      sum0_r = V::fmadd(V::load(a + i), V::load(b + i), sum0_r);
+      sum1_r = V::fmadd(V::load(a + i + simd_width),
+                        V::load(b + i + simd_width), sum1_r);
+      sum2_r = V::fmadd(V::load(a + i + 2 * simd_width),
+                        V::load(b + i + 2 * simd_width), sum2_r);
+      sum3_r = V::fmadd(V::load(a + i + 3 * simd_width),
+                        V::load(b + i + 3 * simd_width), sum3_r);
+    }
+
+    float sum_local = V::reduceAdd(
+        V::add(V::add(sum0_r, sum1_r), V::add(sum2_r, sum3_r)));
+
+#pragma omp critical
+    sum += sum_local;
+  }
+
+  // Adding the remaining products
+  for (size_t i = limit; i < N; i++) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+/*
+int8 dot products. The products are summed in 32-bit lanes, which are
+widened to 64 bits after every block of dotI8Block elements: a lane receives
+at most dotI8Block / 4 products of magnitude <= 2^14 per block, so it cannot
+overflow, and the result is exact for any N.
+The x86 kernels multiply with maddubs/VNNI, which take an unsigned and a
+signed operand: |a| is used as the unsigned operand and the sign of a is
+moved onto b, so elements must lie in [-127, 127], the range of symmetric
+int8 quantization.
+*/
+static const size_t dotI8Block = 1 << 16;
+
+typedef int64_t (*DotI8Kernel)(int8_t const *, int8_t const *, size_t);
+
+// Sums the block kernel over the whole array
+template <DotI8Kernel block>
+static int64_t dotI8Vec(int8_t const *const a, int8_t const *const b,
+                        size_t const N) {
+  int64_t sum = 0;
+  for (size_t i = 0; i < N; i += dotI8Block) {
+    sum += block(a + i, b + i, std::min(dotI8Block, N - i));
+  }
+  return sum;
+}
+
+// Multithreaded version of dotI8Vec
+template <DotI8Kernel block>
+static int64_t dotI8VecOMP(int8_t const *const a, int8_t const *const b,
+                           size_t const N) {
+  int64_t sum = 0;
+
+#pragma omp parallel for schedule(static) reduction(+ : sum)
+  for (size_t i = 0; i < N; i += dotI8Block) {
+    sum += block(a + i, b + i, std::min(dotI8Block, N - i));
+  }
+  return sum;
+}
+
+// Dot product of the elements [begin, end) left over by a vector loop
+static inline int64_t dotI8Remainder(int8_t const *const a,
+                                     int8_t const *const b,
+                                     size_t const begin, size_t const end) {
+  int64_t sum = 0;
+  for (size_t i = begin; i < end; i++) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+#ifdef SIMD_SSE
+static inline int64_t dotI8BlockSSE(int8_t const *const a,
+                                    int8_t const *const b, size_t const n) {
+  const int simd_width = 16;
+  size_t limit = n / simd_width * simd_width;
+
+  const __m128i ones = _mm_set1_epi16(1);
+  __m128i sum_r = _mm_setzero_si128();
+
+  for (size_t i = 0; i < limit; i += simd_width) {
+    __m128i a_r = _mm_loadu_si128((__m128i const *)(a + i));
+    __m128i b_r = _mm_loadu_si128((__m128i const *)(b + i));
+
+    __m128i prod_r =
+        _mm_maddubs_epi16(_mm_abs_epi8(a_r), _mm_sign_epi8(b_r, a_r));
+    sum_r = _mm_add_epi32(sum_r, _mm_madd_epi16(prod_r, ones));
+  }
+
+  return Vec<int, 4>::reduceAdd({sum_r}) + dotI8Remainder(a, b, limit, n);
+}
+#endif
+
+#ifdef __AVX2__
+// Uses VNNI (AVX512-VNNI with VL, or AVX-VNNI) when the target has it
+static inline int64_t dotI8BlockAVX2(int8_t const *const a,
+                                     int8_t const *const b, size_t const n) {
+  const int simd_width = 32;
+  size_t limit = n / simd_width * simd_width;
+
+  __m256i sum_r = _mm256_setzero_si256();
+#if !defined(__AVX512VNNI__) && !defined(__AVXVNNI__)
+  const __m256i ones = _mm256_set1_epi16(1);
+#endif
+
+  for (size_t i = 0; i < limit; i += simd_width) {
+    __m256i a_r = _mm256_loadu_si256((__m256i const *)(a + i));
+    __m256i b_r = _mm256_loadu_si256((__m256i const *)(b + i));
+    __m256i abs_a_r = _mm256_abs_epi8(a_r);
+    __m256i sign_b_r = _mm256_sign_epi8(b_r, a_r);
+
+#if defined(__AVX512VNNI__) && defined(__AVX512VL__)
+    sum_r = _mm256_dpbusd_epi32(sum_r, abs_a_r, sign_b_r);
+#elif defined(__AVXVNNI__)
+    sum_r = _mm256_dpbusd_avx_epi32(sum_r, abs_a_r, sign_b_r);
+#else
+    __m256i prod_r = _mm256_maddubs_epi16(abs_a_r, sign_b_r);
+    sum_r = _mm256_add_epi32(sum_r, _mm256_madd_epi16(prod_r, ones));
+#endif
+  }
+
+  return Vec<int, 8>::reduceAdd({sum_r}) + dotI8Remainder(a, b, limit, n);
+}
+#endif
+
+#ifdef __AVX512BW__
+/*
+AVX-512 has no sign_epi8, so b is negated under the mask of negative a.
+Uses VNNI when the target has it.
+*/
+static inline int64_t dotI8BlockAVX512(int8_t const *const a,
+                                       int8_t const *const b,
+                                       size_t const n) {
+  const int simd_width = 64;
+  size_t limit = n / simd_width * simd_width;
+
+  const __mmask64 all = ~__mmask64(0);
+  const __m512i zero = _mm512_setzero_si512();
+  __m512i sum_r = _mm512_setzero_si512();
+#ifndef __AVX512VNNI__
+  const __m512i ones = _mm512_set1_epi16(1);
+#endif
+
+  for (size_t i = 0; i < limit; i += simd_width) {
+    __m512i a_r = _mm512_loadu_si512(a + i);
+    __m512i b_r = _mm512_loadu_si512(b + i);
+    __m512i abs_a_r = _mm512_maskz_abs_epi8(all, a_r);
+    __m512i sign_b_r =
+        _mm512_mask_sub_epi8(b_r, _mm512_movepi8_mask(a_r), zero, b_r);
+
+#ifdef __AVX512VNNI__
+    sum_r = _mm512_dpbusd_epi32(sum_r, abs_a_r, sign_b_r);
+#else
+    __m512i prod_r = _mm512_maddubs_epi16(abs_a_r, sign_b_r);
+    sum_r = _mm512_add_epi32(sum_r, _mm512_madd_epi16(prod_r, ones));
+#endif
+  }
+
+  return Vec<int, 16>::reduceAdd({sum_r}) + dotI8Remainder(a, b, limit, n);
+}
+#endif
+
+#ifdef SIMD_NEON
+// Uses SDOT when the target has the dot product extension
+static inline int64_t dotI8BlockNEON(int8_t const *const a,
+                                     int8_t const *const b, size_t const n) {
+  const int simd_width = 16;
+  size_t limit = n / simd_width * simd_width;
+
+  int32x4_t sum_r = vdupq_n_s32(0);
+
+  for (size_t i = 0; i < limit; i += simd_width) {
+    int8x16_t a_r = vld1q_s8(a + i);
+    int8x16_t b_r = vld1q_s8(b + i);
+
+#ifdef __ARM_FEATURE_DOTPROD
+    sum_r = vdotq_s32(sum_r, a_r, b_r);
+#else
+    int16x8_t prod_r = vmull_s8(vget_low_s8(a_r), vget_low_s8(b_r));
+    prod_r = vmlal_high_s8(prod_r, a_r, b_r);
+    sum_r = vpadalq_s16(sum_r, prod_r);
+#endif
+  }
+
+  return vaddlvq_s32(sum_r) + dotI8Remainder(a, b, limit, n);
+}
+#endif
+
+// Dot product kernels
+static inline float dotSSE(float const *const a, float const *const b,
+                           size_t const N) {
+  return dotVec<Vec<float, 4>>(a, b, N);
+}
+
+static inline float dotSSEOMP(float const *const a, float const *const b,
+                              size_t const N) {
+  return dotVecOMP<Vec<float, 4>>(a, b, N);
+}
+
+#ifdef SIMD_SSE
+static inline int64_t dotSSE(int8_t const *const a, int8_t const *const b,
+                             size_t const N) {
+  return dotI8Vec<dotI8BlockSSE>(a, b, N);
+}
+
+static inline int64_t dotSSEOMP(int8_t const *const a, int8_t const *const b,
+                                size_t const N) {
+  return dotI8VecOMP<dotI8BlockSSE>(a, b, N);
+}
+#endif
+
+#ifdef __AVX2__
+// With FMA when the target has it (-march=native on any AVX2 CPU)
+static inline float dotAVX2(float const *const a, float const *const b,
+                            size_t const N) {
+  return dotVec<Vec<float, 8>>(a, b, N);
+}
+
+static inline float dotAVX2OMP(float const *const a, float const *const b,
+                               size_t const N) {
+  return dotVecOMP<Vec<float, 8>>(a, b, N);
+}
+
+static inline int64_t dotAVX2(int8_t const *const a, int8_t const *const b,
+                              size_t const N) {
+  return dotI8Vec<dotI8BlockAVX2>(a, b, N);
+}
+
+static inline int64_t dotAVX2OMP(int8_t const *const a,
+                                 int8_t const *const b, size_t const N) {
+  return dotI8VecOMP<dotI8BlockAVX2>(a, b, N);
+}
+#endif
+
+#ifdef __AVX512F__
+static inline float dotAVX512(float const *const a, float const *const b,
+                              size_t const N) {
+  return dotVec<Vec<float, 16>>(a, b, N);
+}
+
+static inline float dotAVX512OMP(float const *const a, float const *const b,
+                                 size_t const N) {
+  return dotVecOMP<Vec<float, 16>>(a, b, N);
+}
+#endif
+
+#ifdef __AVX512BW__
+static inline int64_t dotAVX512(int8_t const *const a, int8_t const *const b,
+                                size_t const N) {
+  return dotI8Vec<dotI8BlockAVX512>(a, b, N);
+}
+
+static inline int64_t dotAVX512OMP(int8_t const *const a,
+                                   int8_t const *const b, size_t const N) {
+  return dotI8VecOMP<dotI8BlockAVX512>(a, b, N);
+}
+#endif
+
+#ifdef SIMD_NEON
+static inline float dotNEON(float const *const a, float const *const b,
+                            size_t const N) {
+  return dotVec<Vec<float, 4>>(a, b, N);
+}
+
+static inline float dotNEONOMP(float const *const a, float const *const b,
+                               size_t const N) {
+  return dotVecOMP<Vec<float, 4>>(a, b, N);
+}
+
+static inline int64_t dotNEON(int8_t const *const a, int8_t const *const b,
+                              size_t const N) {
+  return dotI8Vec<dotI8BlockNEON>(a, b, N);
+}
+
+static inline int64_t dotNEONOMP(int8_t const *const a,
+                                 int8_t const *const b, size_t const N) {
+  return dotI8VecOMP<dotI8BlockNEON>(a, b, N);
+}
+
+// The int8 "SSE" kernels are the NEON ones, as for the float kernels
+static inline int64_t dotSSE(int8_t const *const a, int8_t const *const b,
+                             size_t const N) {
+  return dotNEON(a, b, N);
+}
+
+static inline int64_t dotSSEOMP(int8_t const *const a, int8_t const *const b,
+                                size_t const N) {
+  return dotNEONOMP(a, b, N);
+}
+#endif
+
+// Dot product dispatchers, in order of preference NEON, AVX-512, AVX2, SSE
+static inline float dotAuto(float const *const a, float const *const b,
+                            size_t const N) {
+#ifdef SIMD_NEON
+  return dotNEON(a, b, N);
+#elif defined(__AVX512F__)
+  return dotAVX512(a, b, N);
+#elif defined(__AVX2__)
+  return dotAVX2(a, b, N);
+#else
+  return dotSSE(a, b, N);
+#endif
+}
+
+static inline float dotAutoOMP(float const *const a, float const *const b,
+                               size_t const N) {
+#ifdef SIMD_NEON
+  return dotNEONOMP(a, b, N);
+#elif defined(__AVX512F__)
+  return dotAVX512OMP(a, b, N);
+#elif defined(__AVX2__)
+  return dotAVX2OMP(a, b, N);
+#else
+  return dotSSEOMP(a, b, N);
+#endif
+}
+
+static inline int64_t dotAuto(int8_t const *const a, int8_t const *const b,
+                              size_t const N) {
+#ifdef SIMD_NEON
+  return dotNEON(a, b, N);
+#elif defined(__AVX512BW__)
+  return dotAVX512(a, b, N);
+#elif defined(__AVX2__)
+  return dotAVX2(a, b, N);
+#else
+  return dotSSE(a, b, N);
+#endif
+}
+
+static inline int64_t dotAutoOMP(int8_t const *const a, int8_t const *const b,
+                                 size_t const N) {
+#ifdef SIMD_NEON
+  return dotNEONOMP(a, b, N);
+#elif defined(__AVX512BW__)
+  return dotAVX512OMP(a, b, N);
+#elif defined(__AVX2__)
+  return dotAVX2OMP(a, b, N);
+#else
+  return dotSSEOMP(a, b, N);
+#endif
+}
+
+/*
+Histograms of N floats over "bins" equal-width bins spanning [min, max] of
+the array, where min and max are found with the min-max kernels and returned
+to the caller as the bin edges. NaNs are not counted. Element x goes to bin
+(x - min) * scale with scale = bins / (max - min), truncated and capped at
+the last bin, and to bin 0 if all numbers are equal.
+
+The counting is done by a "core", which keeps private counts while it adds
+ranges of the array and then merges them into hist:
+  HistogramLanes<V>   a sub-histogram per vector lane, so that the scalar
+                      increments of one vector never hit the same counter
+  HistogramConflict   AVX-512 only: one histogram updated with gather and
+                      scatter, where vpconflictd finds the lanes with the
+                      same bin so that each bin is incremented once by the
+                      number of lanes falling in it
+The cores count in 32 bits, so a call handles at most 2^32 - 1 elements in a
+bin (per thread).
+*/
+static const size_t histogramBlock = 1 << 16;
+
+static inline float histogramScale(float const min, float const max,
+                                   size_t const bins) {
+  float range = max - min;
+  return range > 0.0f ? bins / range : 0.0f;
+}
+
+// Bin of x, or "bins" if x is NaN
+static inline size_t histogramBin(float const x, float const min,
+                                  float const scale, size_t const bins) {
+  float y = (x - min) * scale;
+  float last = bins - 1;
+  if (y > last) {
+    y = last;
+  }
+  return std::isnan(y) ? bins : size_t(y);
+}
+
+// Vector version of histogramBin
+template <typename V>
+static inline Vec<int, V::width> histogramBins(V arr_r, V min_r, V scale_r,
+                                               V last_r, V nan_bin_r) {
+  V y_r = V::mul(V::sub(arr_r, min_r), scale_r);
+  y_r = V::select(V::gt(y_r, last_r), last_r, y_r);
+  y_r = V::select(V::isnan(y_r), nan_bin_r, y_r);
+  return Vec<int, V::width>::truncate(y_r);
+}
+
+template <typename V> struct HistogramLanes {
+  size_t bins;
+  // V::width sub-histograms of bins + 1 counters, the last one for NaNs
+  std::vector<uint32_t> counts;
+
+  HistogramLanes(size_t const bins)
+      : bins(bins), counts(V::width * (bins + 1)) {}
+
+  void add(float const *const arr, size_t const begin, size_t const end,
+           float const min, float const scale) {
+    typedef Vec<int, V::width> VI;
+
+    const int simd_width = V::width;
+    const size_t stride = bins + 1;
+    size_t limit = begin + (end - begin) / simd_width * simd_width;
+
+    V min_r = V::set1(min);
+    V scale_r = V::set1(scale);
+    V last_r = V::set1(bins - 1);
+    V nan_bin_r = V::set1(bins);
+
+    for (size_t i = begin; i < limit; i += simd_width) {
+      int bin[simd_width];
+      VI::store(bin, histogramBins(V::load(arr + i), min_r, scale_r, last_r,
+                                   nan_bin_r));
+
+      for (int l = 0; l < simd_width; l++) {
+        counts[l * stride + bin[l]]++;
+      }
+    }
+
+    // Counting the remaining elements in the first sub-histogram
+    for (size_t i = limit; i < end; i++) {
+      counts[histogramBin(arr[i], min, scale, bins)]++;
+    }
+  }
+
+  void mergeInto(size_t *const hist) const {
+    for (int l = 0; l < V::width; l++) {
+      for (size_t b = 0; b < bins; b++) {
+        hist[b] += counts[l * (bins + 1) + b];
+      }
+    }
+  }
+};
+
+#if defined(__AVX512CD__) && defined(__AVX512VPOPCNTDQ__)
+struct HistogramConflict {
+  size_t bins;
+  // Updated as int32 by gather/scatter, read back as uint32
+  std::vector<int> counts;
+
+  HistogramConflict(size_t const bins) : bins(bins), counts(bins + 1) {}
+
+  void add(float const *const arr, size_t const begin, size_t const end,
+           float const min, float const scale) {
+    typedef Vec<float, 16> V;
+
+    const int simd_width = V::width;
+    size_t limit = begin + (end - begin) / simd_width * simd_width;
+
+    V min_r = V::set1(min);
+    V scale_r = V::set1(scale);
+    V last_r = V::set1(bins - 1);
+    V nan_bin_r = V::set1(bins);
+
+    const __mmask16 all = 0xFFFF;
+    const __m512i ones = _mm512_set1_epi32(1);
+    const __m512i zero = _mm512_setzero_si512();
+    int *const base = counts.data();
+
+    for (size_t i = begin; i < limit; i += simd_width) {
+      __m512i bin_r = histogramBins(V::load(arr + i), min_r, scale_r, last_r,
+                                    nan_bin_r)
+                          .r;
+
+      // Lane j of conflict has bit k set for every earlier lane k with the
+      // same bin, so the last lane of each bin adds the whole group
+      __m512i conflict_r = _mm512_maskz_conflict_epi32(all, bin_r);
+      __m512i inc_r = _mm512_add_epi32(
+          _mm512_maskz_popcnt_epi32(all, conflict_r), ones);
+
+      __m512i count_r =
+          _mm512_mask_i32gather_epi32(zero, all, bin_r, base, sizeof(int));
+      // Scattered lanes with the same index are written in lane order
+      _mm512_i32scatter_epi32(base, bin_r, _mm512_add_epi32(count_r, inc_r),
+                              sizeof(int));
+    }
+
+    for (size_t i = limit; i < end; i++) {
+      counts[histogramBin(arr[i], min, scale, bins)]++;
+    }
+  }
+
+  void mergeInto(size_t *const hist) const {
+    for (size_t b = 0; b < bins; b++) {
+      hist[b] += uint32_t(counts[b]);
+    }
+  }
+};
+#endif
+
+/*
+Histogram of N floats with the given core, using the min-max kernel of the
+same width. hist receives "bins" counts, min and max the range they span.
+*/
+template <typename V, typename Core>
+static void histogramVec(float const *const arr, size_t const N,
+                         size_t const bins, size_t *const hist,
+                         float *const min, float *const max) {
+  minMaxVec<V, NaNPolicy::Ignore>(arr, N, min, max, nullptr);
+  float scale = histogramScale(*min, *max, bins);
+
+  Core core(bins);
+  core.add(arr, 0, N, *min, scale);
+
+  std::fill(hist, hist + bins, 0);
+  core.mergeInto(hist);
+}
+
+// Multithreaded version of histogramVec, with a core per thread
+template <typename V, typename Core>
+static void histogramVecOMP(float const *const arr, size_t const N,
+                            size_t const bins, size_t *const hist,
+                            float *const min, float *const max) {
+  minMaxVecOMP<V, NaNPolicy::Ignore>(arr, N, min, max, nullptr);
+  float min_all = *min;
+  float scale = histogramScale(*min, *max, bins);
+
+  std::fill(hist, hist + bins, 0);
+
+  size_t blocks = (N + histogramBlock - 1) / histogramBlock;
+
+#pragma omp parallel
+  {
+    Core core(bins);
+
+#pragma omp for schedule(static) nowait
+    for (size_t b = 0; b < blocks; b++) {
+      size_t begin = b * histogramBlock;
+      core.add(arr, begin, std::min(begin + histogramBlock, N), min_all,
+               scale);
+    }
+
+#pragma omp critical
+    core.mergeInto(hist);
+  }
+}
+
+// Histogram kernels
+static inline void histogramSSE(float const *const arr, size_t const N,
+                                size_t const bins, size_t *const hist,
+                                float *const min, float *const max) {
+  histogramVec<Vec<float, 4>, HistogramLanes<Vec<float, 4>>>(arr, N, bins,
+                                                             hist, min, max);
+}
+
+static inline void histogramSSEOMP(float const *const arr, size_t const N,
+                                   size_t const bins, size_t *const hist,
+                                   float *const min, float *const max) {
+  histogramVecOMP<Vec<float, 4>, HistogramLanes<Vec<float, 4>>>(
+      arr, N, bins, hist, min, max);
+}
+
+#ifdef __AVX2__
+static inline void histogramAVX(float const *const arr, size_t const N,
+                                size_t const bins, size_t *const hist,
+                                float *const min, float *const max) {
+  histogramVec<Vec<float, 8>, HistogramLanes<Vec<float, 8>>>(arr, N, bins,
+                                                             hist, min, max);
+}
+
+static inline void histogramAVXOMP(float const *const arr, size_t const N,
+                                   size_t const bins, size_t *const hist,
+                                   float *const min, float *const max) {
+  histogramVecOMP<Vec<float, 8>, HistogramLanes<Vec<float, 8>>>(
+      arr, N, bins, hist, min, max);
+}
+#endif
+
+#ifdef __AVX512F__
+static inline void histogramAVX512(float const *const arr, size_t const N,
+                                   size_t const bins, size_t *const hist,
+                                   float *const min, float *const max) {
+  histogramVec<Vec<float, 16>, HistogramLanes<Vec<float, 16>>>(
+      arr, N, bins, hist, min, max);
+}
+
+static inline void histogramAVX512OMP(float const *const arr, size_t const N,
+                                      size_t const bins, size_t *const hist,
+                                      float *const min, float *const max) {
+  histogramVecOMP<Vec<float, 16>, HistogramLanes<Vec<float, 16>>>(
+      arr, N, bins, hist, min, max);
+}
+#endif
+
+#if defined(__AVX512CD__) && defined(__AVX512VPOPCNTDQ__)
+static inline void histogramAVX512CD(float const *const arr, size_t const N,
+                                     size_t const bins, size_t *const hist,
+                                     float *const min, float *const max) {
+  histogramVec<Vec<float, 16>, HistogramConflict>(arr, N, bins, hist, min,
+                                                  max);
+}
+
+static inline void histogramAVX512CDOMP(float const *const arr, size_t const N,
+                                        size_t const bins, size_t *const hist,
+                                        float *const min, float *const max) {
+  histogramVecOMP<Vec<float, 16>, HistogramConflict>(arr, N, bins, hist, min,
+                                                     max);
+}
+#endif
+
+#ifdef SIMD_NEON
+static inline void histogramNEON(float const *const arr, size_t const N,
+                                 size_t const bins, size_t *const hist,
+                                 float *const min, float *const max) {
+  histogramVec<Vec<float, 4>, HistogramLanes<Vec<float, 4>>>(arr, N, bins,
+                                                             hist, min, max);
+}
+
+static inline void histogramNEONOMP(float const *const arr, size_t const N,
+                                    size_t const bins, size_t *const hist,
+                                    float *const min, float *const max) {
+  histogramVecOMP<Vec<float, 4>, HistogramLanes<Vec<float, 4>>>(
+      arr, N, bins, hist, min, max);
+}
+#endif
+
+// Histogram dispatchers, in order of preference NEON, AVX-512, AVX2, SSE
+static inline void histogramAuto(float const *const arr, size_t const N,
+                                 size_t const bins, size_t *const hist,
+                                 float *const min, float *const max) {
+#ifdef SIMD_NEON
+  histogramNEON(arr, N, bins, hist, min, max);
+#elif defined(__AVX512F__)
+  histogramAVX512(arr, N, bins, hist, min, max);
+#elif defined(__AVX2__)
+  histogramAVX(arr, N, bins, hist, min, max);
+#else
+  histogramSSE(arr, N, bins, hist, min, max);
+#endif
+}
+
+static inline void histogramAutoOMP(float const *const arr, size_t const N,
+                                    size_t const bins, size_t *const hist,
+                                    float *const min, float *const max) {
+#ifdef SIMD_NEON
+  histogramNEONOMP(arr, N, bins, hist, min, max);
+#elif defined(__AVX512F__)
+  histogramAVX512OMP(arr, N, bins, hist, min, max);
+#elif defined(__AVX2__)
+  histogramAVXOMP(arr, N, bins, hist, min, max);
+#else
+  histogramSSEOMP(arr, N, bins, hist, min, max);
+#endif
+}
+
+/*
+Prefix sums of N ints or floats. The inclusive scan writes
+out[i] = arr[0] + ... + arr[i], the exclusive scan
+out[i] = arr[0] + ... + arr[i - 1] with out[0] = 0. out may be arr.
+Each vector is scanned in registers with V::scan, and the running total is
+kept broadcast in a register and added to the next vector. int sums wrap
+around on overflow. Float sums are added in a different order than a
+sequential loop, so the last bits of the results may differ from it.
+
+The threaded versions use the two-pass blocked scan: pass one sums blocks of
+scanBlock elements in parallel, the block sums are scanned sequentially to
+give the offset of every block, and pass two scans each block in parallel
+starting from its offset. Both passes use the same static schedule, so each
+thread scans the blocks it summed.
+*/
+static const size_t scanBlock = 1 << 16;
+
+// a + b for the scalar parts of the scans; the int sum is taken as unsigned
+// so that it wraps around on overflow as the vector lanes do
+static inline int scanAdd(int const a, int const b) {
+  return int(unsigned(a) + unsigned(b));
+}
+
+static inline float scanAdd(float const a, float const b) { return a + b; }
+
+/*
+Scan of N elements starting from "carry", written once for any Vec<T, W>.
+Returns the sum of carry and all elements, the carry for the next block.
+*/
+template <int W, bool exclusive, typename T>
+static T scanVec(T const *const arr, size_t const N, T *const out,
+                 T const carry) {
+  typedef Vec<T, W> V;
+
+  const int simd_width = V::width;
+  size_t quot = N / simd_width;
+  size_t limit = quot * simd_width;
+
+  V carry_r = V::set1(carry);
+
+  for (size_t i = 0; i < limit; i += simd_width) {
+    V arr_r = V::load(arr + i);
+
+    if (exclusive) {
+      V out_r = V::add(carry_r, V::scan(V::template shiftUp<1>(arr_r)));
+      carry_r = V::broadcastLast(V::add(out_r, arr_r));
+      V::store(out + i, out_r);
+    } else {
+      V out_r = V::add(carry_r, V::scan(arr_r));
+      carry_r = V::broadcastLast(out_r);
+      V::store(out + i, out_r);
+    }
+  }
+
+  T lanes[simd_width];
+  V::store(lanes, carry_r);
+  T sum = lanes[0];
+
+  // Scanning the remaining elements
+  for (size_t i = limit; i < N; i++) {
+    T x = arr[i];
+    if (exclusive) {
+      out[i] = sum;
+      sum = scanAdd(sum, x);
+    } else {
+      sum = scanAdd(sum, x);
+      out[i] = sum;
+    }
+  }
+  return sum;
+}
+
+// Sum of the n elements of one block, for the first pass of scanVecOMP
+template <int W, typename T>
+static T scanBlockSum(T const *const arr, size_t const n) {
+  typedef Vec<T, W> V;
+
+  const int simd_width = V::width;
+  size_t limit = n / simd_width * simd_width;
+
+  V sum_r = V::zero();
+  for (size_t i = 0; i < limit; i += simd_width) {
+    sum_r = V::add(sum_r, V::load(arr + i));
+  }
+
+  T sum = T(V::reduceAdd(sum_r));
+  for (size_t i = limit; i < n; i++) {
+    sum = scanAdd(sum, arr[i]);
+  }
+  return sum;
+}
+
+// Multithreaded two-pass version of scanVec
+template <int W, bool exclusive, typename T>
+static void scanVecOMP(T const *const arr, size_t const N, T *const out) {
+  size_t blocks = (N + scanBlock - 1) / scanBlock;
+  std::vector<T> offsets(blocks);
+
+#pragma omp parallel
+  {
+#pragma omp for schedule(static)
+    for (size_t b = 0; b < blocks; b++) {
+      size_t begin = b * scanBlock;
+      offsets[b] = scanBlockSum<W>(arr + begin, std::min(scanBlock, N - begin));
+    }
+
+#pragma omp single
+    {
+      T total = 0;
+      for (size_t b = 0; b < blocks; b++) {
+        T block_sum = offsets[b];
+        offsets[b] = total;
+        total = scanAdd(total, block_sum);
+      }
+    }
+
+#pragma omp for schedule(static)
+    for (size_t b = 0; b < blocks; b++) {
+      size_t begin = b * scanBlock;
+      scanVec<W, exclusive>(arr + begin, std::min(scanBlock, N - begin),
+                            out + begin, offsets[b]);
+    }
+  }
+}
+
+// Prefix sum kernels for int and float
+template <typename T>
+static inline void inclusiveScanSSE(T const *const arr, size_t const N,
+                                    T *const out) {
+  scanVec<4, false>(arr, N, out, T(0));
+}
+
+template <typename T>
+static inline void exclusiveScanSSE(T const *const arr, size_t const N,
+                                    T *const out) {
+  scanVec<4, true>(arr, N, out, T(0));
+}
+
+template <typename T>
+static inline void inclusiveScanSSEOMP(T const *const arr, size_t const N,
+                                       T *const out) {
+  scanVecOMP<4, false>(arr, N, out);
+}
+
+template <typename T>
+static inline void exclusiveScanSSEOMP(T const *const arr, size_t const N,
+                                       T *const out) {
+  scanVecOMP<4, true>(arr, N, out);
+}
+
+#ifdef __AVX2__
+template <typename T>
+static inline void inclusiveScanAVX2(T const *const arr, size_t const N,
+                                     T *const out) {
+  scanVec<8, false>(arr, N, out, T(0));
+}
+
+template <typename T>
+static inline void exclusiveScanAVX2(T const *const arr, size_t const N,
+                                     T *const out) {
+  scanVec<8, true>(arr, N, out, T(0));
+}
+
+template <typename T>
+static inline void inclusiveScanAVX2OMP(T const *const arr, size_t const N,
+                                        T *const out) {
+  scanVecOMP<8, false>(arr, N, out);
+}
+
+template <typename T>
+static inline void exclusiveScanAVX2OMP(T const *const arr, size_t const N,
+                                        T *const out) {
+  scanVecOMP<8, true>(arr, N, out);
+}
+#endif
+
+#ifdef __AVX512F__
+template <typename T>
+static inline void inclusiveScanAVX512(T const *const arr, size_t const N,
+                                       T *const out) {
+  scanVec<16, false>(arr, N, out, T(0));
+}
+
+template <typename T>
+static inline void exclusiveScanAVX512(T const *const arr, size_t const N,
+                                       T *const out) {
+  scanVec<16, true>(arr, N, out, T(0));
+}
+
+template <typename T>
+static inline void inclusiveScanAVX512OMP(T const *const arr, size_t const N,
+                                          T *const out) {
+  scanVecOMP<16, false>(arr, N, out);
+}
+
+template <typename T>
+static inline void exclusiveScanAVX512OMP(T const *const arr, size_t const N,
+                                          T *const out) {
+  scanVecOMP<16, true>(arr, N, out);
+}
+#endif
+
+#ifdef SIMD_NEON
+template <typename T>
+static inline void inclusiveScanNEON(T const *const arr, size_t const N,
+                                     T *const out) {
+  scanVec<4, false>(arr, N, out, T(0));
+}
+
+template <typename T>
+static inline void exclusiveScanNEON(T const *const arr, size_t const N,
+                                     T *const out) {
+  scanVec<4, true>(arr, N, out, T(0));
+}
+
+template <typename T>
+static inline void inclusiveScanNEONOMP(T const *const arr, size_t const N,
+                                        T *const out) {
+  scanVecOMP<4, false>(arr, N, out);
+}
+
+template <typename T>
+static inline void exclusiveScanNEONOMP(T const *const arr, size_t const N,
+                                        T *const out) {
+  scanVecOMP<4, true>(arr, N, out);
+}
+#endif
+
+// Prefix sum dispatchers, in order of preference NEON, AVX-512, AVX2, SSE
+template <typename T>
+static inline void inclusiveScanAuto(T const *const arr, size_t const N,
+                                     T *const out) {
+#ifdef SIMD_NEON
+  inclusiveScanNEON(arr, N, out);
+#elif defined(__AVX512F__)
+  inclusiveScanAVX512(arr, N, out);
+#elif defined(__AVX2__)
+  inclusiveScanAVX2(arr, N, out);
+#else
+  inclusiveScanSSE(arr, N, out);
+#endif
+}
+
+template <typename T>
+static inline void inclusiveScanAutoOMP(T const *const arr, size_t const N,
+                                        T *const out) {
+#ifdef SIMD_NEON
+  inclusiveScanNEONOMP(arr, N, out);
+#elif defined(__AVX512F__)
+  inclusiveScanAVX512OMP(arr, N, out);
+#elif defined(__AVX2__)
+  inclusiveScanAVX2OMP(arr, N, out);
+#else
+  inclusiveScanSSEOMP(arr, N, out);
+#endif
+}
+
+template <typename T>
+static inline void exclusiveScanAuto(T const *const arr, size_t const N,
+                                     T *const out) {
+#ifdef SIMD_NEON
+  exclusiveScanNEON(arr, N, out);
+#elif defined(__AVX512F__)
+  exclusiveScanAVX512(arr, N, out);
+#elif defined(__AVX2__)
+  exclusiveScanAVX2(arr, N, out);
+#else
+  exclusiveScanSSE(arr, N, out);
+#endif
+}
+
+template <typename T>
+static inline void exclusiveScanAutoOMP(T const *const arr, size_t const N,
+                                        T *const out) {
+#ifdef SIMD_NEON
+  exclusiveScanNEONOMP(arr, N, out);
+#elif defined(__AVX512F__)
+  exclusiveScanAVX512OMP(arr, N, out);
+#elif defined(__AVX2__)
+  exclusiveScanAVX2OMP(arr, N, out);
+#else
+  exclusiveScanSSEOMP(arr, N, out);
+#endif
+}
+
+/*
+Stream compaction: the filter kernels copy the elements of arr for which
+pred is true to the front of out, in order, and return their number. out
+must have room for N elements, and may be arr in the single threaded
+kernels. The vector loop stores every vector with V::compressStore (a
+lookup-table shuffle on SSE/AVX2/NEON, vpcompressd on AVX-512), which may
+write past the last selected element, but never past the room left in out.
+
+The threaded versions count the selected elements of each block of
+filterBlock elements in parallel, turn the counts into output offsets with a
+prefix sum, and then compact every block in parallel straight into its part
+of out, so no thread waits for a lock. Their out must not overlap arr.
+*/
+static const size_t filterBlock = 1 << 16;
+
+// Predicates for the filter kernels, callable on a Vec and on a scalar
+template <typename T> struct Greater {
+  T threshold;
+
+  template <typename V> typename V::Mask operator()(V a) const {
+    return V::gt(a, V::set1(threshold));
+  }
+  bool operator()(T x) const { return x > threshold; }
+};
+
+// abs(x) > threshold for ints; abs(INT_MIN) is INT_MIN, as in absVec
+struct AbsGreater {
+  int threshold;
+
+  template <typename V> typename V::Mask operator()(V a) const {
+    return V::gt(V::abs(a), V::set1(threshold));
+  }
+  bool operator()(int x) const {
+    unsigned abs_x = x < 0 ? 0u - unsigned(x) : unsigned(x);
+    return int(abs_x) > threshold;
+  }
+};
+
+/*
+Compacts the n elements of arr into out, where out has room for "room"
+elements: full vectors are stored only while they fit. Returns the number of
+selected elements. Written once for any Vec<T, W>.
+*/
+template <int W, typename T, typename Pred>
+static size_t filterVec(T const *const arr, size_t const n, T *const out,
+                        size_t const room, Pred const pred) {
+  typedef Vec<T, W> V;
+
+  const int simd_width = V::width;
+  size_t count = 0;
+  size_t i = 0;
+
+  for (; i + simd_width <= n && count + simd_width <= room; i += simd_width) {
+    V arr_r = V::load(arr + i);
+    count += V::compressStore(out + count, arr_r, pred(arr_r));
+  }
+
+  // Filtering the remaining elements
+  for (; i < n; i++) {
+    if (pred(arr[i])) {
+      out[count++] = arr[i];
+    }
+  }
+  return count;
+}
+
+// Number of elements of arr for which pred is true; also used by the count
+// kernels
+template <int W, typename T, typename Pred>
+static size_t countVec(T const *const arr, size_t const n, Pred const pred) {
+  typedef Vec<T, W> V;
+  typedef Vec<int, W> VI;
+
+  const int simd_width = V::width;
+  size_t limit = n / simd_width * simd_width;
+  size_t count = 0;
+
+  // Lane counters, added up every 2^16 elements so that they cannot overflow
+  for (size_t block = 0; block < limit; block += 1 << 16) {
+    size_t block_end = std::min(limit, block + (1 << 16));
+    VI count_r = VI::zero();
+    for (size_t i = block; i < block_end; i += simd_width) {
+      count_r = VI::increment(count_r, pred(V::load(arr + i)));
+    }
+    count += VI::reduceAdd(count_r);
+  }
+
+  for (size_t i = limit; i < n; i++) {
+    count += pred(arr[i]);
+  }
+  return count;
+}
+
+// Multithreaded version of filterVec
+template <int W, typename T, typename Pred>
+static size_t filterVecOMP(T const *const arr, size_t const N, T *const out,
+                           Pred const pred) {
+  size_t blocks = (N + filterBlock - 1) / filterBlock;
+  // offsets[b] is where the output of block b starts
+  std::vector<size_t> offsets(blocks + 1);
+
+#pragma omp parallel
+  {
+#pragma omp for schedule(static)
+    for (size_t b = 0; b < blocks; b++) {
+      size_t begin = b * filterBlock;
+      offsets[b + 1] =
+          countVec<W>(arr + begin, std::min(filterBlock, N - begin), pred);
+    }
+
+#pragma omp single
+    for (size_t b = 0; b < blocks; b++) {
+      offsets[b + 1] += offsets[b];
+    }
+
+#pragma omp for schedule(static)
+    for (size_t b = 0; b < blocks; b++) {
+      size_t begin = b * filterBlock;
+      filterVec<W>(arr + begin, std::min(filterBlock, N - begin),
+                   out + offsets[b], offsets[b + 1] - offsets[b], pred);
+    }
+  }
+  return offsets[blocks];
+}
+
+// Filter kernels for int and float
+template <typename T, typename Pred>
+static inline size_t filterSSE(T const *const arr, size_t const N,
+                               T *const out, Pred const pred) {
+  return filterVec<4>(arr, N, out, N, pred);
+}
+
+template <typename T, typename Pred>
+static inline size_t filterSSEOMP(T const *const arr, size_t const N,
+                                  T *const out, Pred const pred) {
+  return filterVecOMP<4>(arr, N, out, pred);
+}
+
+#ifdef __AVX2__
+template <typename T, typename Pred>
+static inline size_t filterAVX2(T const *const arr, size_t const N,
+                                T *const out, Pred const pred) {
+  return filterVec<8>(arr, N, out, N, pred);
+}
+
+template <typename T, typename Pred>
+static inline size_t filterAVX2OMP(T const *const arr, size_t const N,
+                                   T *const out, Pred const pred) {
+  return filterVecOMP<8>(arr, N, out, pred);
+}
+#endif
+
+#ifdef __AVX512F__
+template <typename T, typename Pred>
+static inline size_t filterAVX512(T const *const arr, size_t const N,
+                                  T *const out, Pred const pred) {
+  return filterVec<16>(arr, N, out, N, pred);
+}
+
+template <typename T, typename Pred>
+static inline size_t filterAVX512OMP(T const *const arr, size_t const N,
+                                     T *const out, Pred const pred) {
+  return filterVecOMP<16>(arr, N, out, pred);
+}
+#endif
+
+#ifdef SIMD_NEON
+template <typename T, typename Pred>
+static inline size_t filterNEON(T const *const arr, size_t const N,
+                                T *const out, Pred const pred) {
+  return filterVec<4>(arr, N, out, N, pred);
+}
+
+template <typename T, typename Pred>
+static inline size_t filterNEONOMP(T const *const arr, size_t const N,
+                                   T *const out, Pred const pred) {
+  return filterVecOMP<4>(arr, N, out, pred);
+}
+#endif
+
+/*
+Top-k selection: the topK kernels write the k largest (TopKOrder::Largest)
+or smallest (TopKOrder::Smallest) elements of arr to out, best first, and
+return their number, which is less than k only if arr has fewer than k
+elements that are not NaN. NaNs are skipped. They are meant for small k, up
+to about 64.
+
+The k best elements so far are kept in a heap with the worst of them on
+top, which is the threshold an element must beat to enter. Each vector is
+compared with the threshold, and in the common case where no lane beats it
+the vector is discarded without leaving the SIMD registers; the few
+survivors are compacted with compressStore and pushed one by one. On random
+data almost every vector is discarded once the heap is full, but on data
+sorted toward the best end every element survives.
+
+The threaded versions scan blocks of topKBlock elements with a heap per
+thread and merge the heaps at the end.
+*/
+enum class TopKOrder { Largest, Smallest };
+
+static const size_t topKBlock = 1 << 16;
+
+// The best k elements seen so far, in a heap with the worst of them on top
+template <typename T, TopKOrder order> struct TopKHeap {
+  size_t k;
+  std::vector<T> heap;
+
+  explicit TopKHeap(size_t k) : k(k) { heap.reserve(k); }
+
+  static bool better(T x, T y) {
+    return order == TopKOrder::Largest ? x > y : x < y;
+  }
+
+  bool full() const { return heap.size() == k; }
+  // The element to beat once the heap is full
+  T threshold() const { return heap.front(); }
+
+  void push(T x) {
+    if (!full()) {
+      if (!std::isnan(x)) {
+        heap.push_back(x);
+        std::push_heap(heap.begin(), heap.end(), better);
+      }
+    } else if (better(x, threshold())) {
+      std::pop_heap(heap.begin(), heap.end(), better);
+      heap.back() = x;
+      std::push_heap(heap.begin(), heap.end(), better);
+    }
+  }
+
+  // Writes the heap to out, best first, and returns its size
+  size_t finish(T *const out) {
+    std::sort_heap(heap.begin(), heap.end(), better);
+    std::copy(heap.begin(), heap.end(), out);
+    return heap.size();
+  }
+};
+
+// Pushes the elements of arr that beat the threshold to heap (k > 0)
+template <int W, TopKOrder order, typename T>
+static void topKScan(T const *const arr, size_t const n,
+                     TopKHeap<T, order> &heap) {
+  typedef Vec<T, W> V;
+
+  const int simd_width = V::width;
+  size_t i = 0;
+
+  // Filling the heap, after which there is a threshold to compare with
+  for (; i < n && !heap.full(); i++) {
+    heap.push(arr[i]);
+  }
+
+  if (heap.full()) {
+    V threshold_r = V::set1(heap.threshold());
+    for (; i + simd_width <= n; i += simd_width) {
+      V arr_r = V::load(arr + i);
+      typename V::Mask beats = order == TopKOrder::Largest
+                                   ? V::gt(arr_r, threshold_r)
+                                   : V::lt(arr_r, threshold_r);
+      if (V::bits(beats) != 0) {
+        T survivors[simd_width];
+        int count = V::compressStore(survivors, arr_r, beats);
+        for (int j = 0; j < count; j++) {
+          heap.push(survivors[j]);
+        }
+        threshold_r = V::set1(heap.threshold());
+      }
+    }
+  }
+
+  // Pushing the remaining elements
+  for (; i < n; i++) {
+    heap.push(arr[i]);
+  }
+}
+
+template <int W, TopKOrder order, typename T>
+static size_t topKVec(T const *const arr, size_t const N, size_t const k,
+                      T *const out) {
+  if (k == 0) {
+    return 0;
+  }
+  TopKHeap<T, order> heap(k);
+  topKScan<W>(arr, N, heap);
+  return heap.finish(out);
+}
+
+// Multithreaded version of topKVec
+template <int W, TopKOrder order, typename T>
+static size_t topKVecOMP(T const *const arr, size_t const N, size_t const k,
+                         T *const out) {
+  if (k == 0) {
+    return 0;
+  }
+  size_t blocks = (N + topKBlock - 1) / topKBlock;
+  TopKHeap<T, order> heap_all(k);
+
+#pragma omp parallel
+  {
+    TopKHeap<T, order> heap_local(k);
+
+#pragma omp for nowait
+    for (size_t b = 0; b < blocks; b++) {
+      size_t begin = b * topKBlock;
+      topKScan<W>(arr + begin, std::min(topKBlock, N - begin), heap_local);
+    }
+
+#pragma omp critical
+    for (T x : heap_local.heap) {
+      heap_all.push(x);
+    }
+  }
+  return heap_all.finish(out);
+}
+
+// Top-k kernels for int and float
+template <TopKOrder order = TopKOrder::Largest, typename T>
+static inline size_t topKSSE(T const *const arr, size_t const N,
+                             size_t const k, T *const out) {
+  return topKVec<4, order>(arr, N, k, out);
+}
+
+template <TopKOrder order = TopKOrder::Largest, typename T>
+static inline size_t topKSSEOMP(T const *const arr, size_t const N,
+                                size_t const k, T *const out) {
+  return topKVecOMP<4, order>(arr, N, k, out);
+}
+
+#ifdef __AVX2__
+template <TopKOrder order = TopKOrder::Largest, typename T>
+static inline size_t topKAVX2(T const *const arr, size_t const N,
+                              size_t const k, T *const out) {
+  return topKVec<8, order>(arr, N, k, out);
+}
+
+template <TopKOrder order = TopKOrder::Largest, typename T>
+static inline size_t topKAVX2OMP(T const *const arr, size_t const N,
+                                 size_t const k, T *const out) {
+  return topKVecOMP<8, order>(arr, N, k, out);
+}
+#endif
+
+#ifdef __AVX512F__
+template <TopKOrder order = TopKOrder::Largest, typename T>
+static inline size_t topKAVX512(T const *const arr, size_t const N,
+                                size_t const k, T *const out) {
+  return topKVec<16, order>(arr, N, k, out);
+}
+
+template <TopKOrder order = TopKOrder::Largest, typename T>
+static inline size_t topKAVX512OMP(T const *const arr, size_t const N,
+                                   size_t const k, T *const out) {
+  return topKVecOMP<16, order>(arr, N, k, out);
+}
+#endif
+
+#ifdef SIMD_NEON
+template <TopKOrder order = TopKOrder::Largest, typename T>
+static inline size_t topKNEON(T const *const arr, size_t const N,
+                              size_t const k, T *const out) {
+  return topKVec<4, order>(arr, N, k, out);
+}
+
+template <TopKOrder order = TopKOrder::Largest, typename T>
+static inline size_t topKNEONOMP(T const *const arr, size_t const N,
+                                 size_t const k, T *const out) {
+  return topKVecOMP<4, order>(arr, N, k, out);
+}
+#endif
+
+// Top-k dispatchers, in order of preference NEON, AVX-512, AVX2, SSE
+template <TopKOrder order = TopKOrder::Largest, typename T>
+static inline size_t topKAuto(T const *const arr, size_t const N,
+                              size_t const k, T *const out) {
+#ifdef SIMD_NEON
+  return topKNEON<order>(arr, N, k, out);
+#elif defined(__AVX512F__)
+  return topKAVX512<order>(arr, N, k, out);
+#elif defined(__AVX2__)
+  return topKAVX2<order>(arr, N, k, out);
+#else
+  return topKSSE<order>(arr, N, k, out);
+#endif
+}
+
+template <TopKOrder order = TopKOrder::Largest, typename T>
+static inline size_t topKAutoOMP(T const *const arr, size_t const N,
+                                 size_t const k, T *const out) {
+#ifdef SIMD_NEON
+  return topKNEONOMP<order>(arr, N, k, out);
+#elif defined(__AVX512F__)
+  return topKAVX512OMP<order>(arr, N, k, out);
+#elif defined(__AVX2__)
+  return topKAVX2OMP<order>(arr, N, k, out);
+#else
+  return topKSSEOMP<order>(arr, N, k, out);
+#endif
+}
+
+/*
+Sorting: the sort kernels sort arr in ascending order, in place. arr must not
+contain NaNs, as for std::sort; -0 and +0 compare equal and keep their sign.
+
+They are a quicksort whose partition step works a vector at a time: every
+vector is split with V::partition into the elements below the pivot, stored
+at the left end of the range, and the others, stored at the right end. The
+first and last vector of the range are set aside first, which keeps at least
+one vector of free space at each end, so whole vectors can be stored without
+overwriting elements that were not read yet. Ranges of at most two vectors
+are sorted by a bitonic network in registers, and ranges that recurse too
+deep fall back to heapsort, as in introsort.
+
+The threaded versions sort blocks of sortBlock elements in parallel and then
+merge runs pairwise. Each merge is split into output segments of sortBlock
+elements whose inputs are found by a binary search (the merge path), so even
+the last merge of two halves keeps all threads busy.
+*/
+static const size_t sortBlock = 1 << 16;
+
+// Largest value of T, which sorts after every other
+template <typename T> static T sortLargest() {
+  return std::numeric_limits<T>::has_infinity
+             ? std::numeric_limits<T>::infinity()
+             : std::numeric_limits<T>::max();
+}
+
+// Smallest value of T above x (x below sortLargest<T>())
+template <typename T> static T sortNext(T x) {
+  if constexpr (std::numeric_limits<T>::is_integer) {
+    return x + 1;
+  } else {
+    return std::nextafter(x, sortLargest<T>());
+  }
+}
+
+// Lanes of bitonic step (j, k) that keep the larger element of their pair:
+// lanes with bit j set in blocks sorted up, and lanes without it in blocks
+// sorted down
+static constexpr unsigned sortHighLanes(int width, int j, int k) {
+  unsigned lanes = 0;
+  for (int i = 0; i < width; i++) {
+    if (((i & j) != 0) != ((i & k) != 0)) {
+      lanes |= 1u << i;
+    }
+  }
+  return lanes;
+}
+
+// Compare-exchange of every lane i with lane i ^ j
+template <typename V, int j, int k> static V sortExchange(V a) {
+  V partner = V::template swapLanes<j>(a);
+  typename V::Mask swap = V::lt(partner, a);
+  V lo = V::select(swap, partner, a);
+  V hi = V::select(swap, a, partner);
+  return V::select(V::fromBits(sortHighLanes(V::width, j, k)), hi, lo);
+}
+
+// Bitonic merge steps j, j / 2, ..., 1 for blocks of k lanes
+template <typename V, int j, int k> static V sortMergeSteps(V a) {
+  a = sortExchange<V, j, k>(a);
+  if constexpr (j > 1) {
+    return sortMergeSteps<V, j / 2, k>(a);
+  } else {
+    return a;
+  }
+}
+
+// Bitonic sort of the lanes of a
+template <typename V, int k = 2> static V sortLanes(V a) {
+  a = sortMergeSteps<V, k / 2, k>(a);
+  if constexpr (k < V::width) {
+    return sortLanes<V, 2 * k>(a);
+  } else {
+    return a;
+  }
+}
+
+// Lane i gets lane width - 1 - i
+template <typename V, int j = 1> static V sortReverse(V a) {
+  if constexpr (j < V::width) {
+    return sortReverse<V, 2 * j>(V::template swapLanes<j>(a));
+  } else {
+    return a;
+  }
+}
+
+// Sorts n <= 2 * W elements with a bitonic network over two vectors, padded
+// with the largest value of T
+template <int W, typename T>
+static void sortNetwork(T *const arr, size_t const n) {
+  typedef Vec<T, W> V;
+
+  T lanes[2 * W];
+  std::fill(lanes, lanes + 2 * W, sortLargest<T>());
+  std::copy(arr, arr + n, lanes);
+
+  V a = sortLanes(V::load(lanes));
+  V b = sortReverse(sortLanes(V::load(lanes + W)));
+  // a and reversed b form a bitonic sequence: the lower half goes to a
+  typename V::Mask swap = V::lt(b, a);
+  V lo = V::select(swap, b, a);
+  V hi = V::select(swap, a, b);
+  V::store(lanes, sortMergeSteps<V, W / 2, W>(lo));
+  V::store(lanes + W, sortMergeSteps<V, W / 2, W>(hi));
+
+  std::copy(lanes, lanes + n, arr);
+}
+
+/*
+Moves the elements of arr below pivot to the front and returns their number.
+n must be at least 2 * W.
+*/
+template <int W, typename T>
+static size_t sortPartition(T *const arr, size_t const n, T const pivot) {
+  typedef Vec<T, W> V;
+
+  const int simd_width = V::width;
+  V pivot_r = V::set1(pivot);
+  V first = V::load(arr);
+  V last = V::load(arr + n - simd_width);
+  size_t read_left = simd_width, read_right = n - simd_width;
+  size_t write_left = 0, write_right = n;
+
+  while (read_right - read_left >= size_t(simd_width)) {
+    // Reading from the end with less free space keeps a vector of free
+    // space at both ends for the stores below
+    V arr_r;
+    if (read_left - write_left <= write_right - read_right) {
+      arr_r = V::load(arr + read_left);
+      read_left += simd_width;
+    } else {
+      read_right -= simd_width;
+      arr_r = V::load(arr + read_right);
+    }
+
+    typename V::Mask below = V::lt(arr_r, pivot_r);
+    int count = __builtin_popcount(V::bits(below));
+    V parted = V::partition(arr_r, below);
+    V::store(arr + write_left, parted);
+    V::store(arr + write_right - simd_width, parted);
+    write_left += count;
+    write_right -= simd_width - count;
+  }
+
+  // The elements left over, and the first and last vector, fill the gap
+  T rest[3 * W];
+  size_t rest_n = read_right - read_left;
+  std::copy(arr + read_left, arr + read_right, rest);
+  V::store(rest + rest_n, first);
+  V::store(rest + rest_n + simd_width, last);
+  for (size_t i = 0; i < rest_n + 2 * simd_width; i++) {
+    if (rest[i] < pivot) {
+      arr[write_left++] = rest[i];
+    } else {
+      arr[--write_right] = rest[i];
+    }
+  }
+  return write_left;
+}
+
+template <typename T> static T sortMedian(T a, T b, T c) {
+  return std::max(std::min(a, b), std::min(std::max(a, b), c));
+}
+
+// Quicksort of arr, with heapsort once depth reaches 0
+template <int W, typename T>
+static void sortQuick(T *arr, size_t n, int depth) {
+  while (n > 2 * W) {
+    if (depth-- == 0) {
+      std::make_heap(arr, arr + n);
+      std::sort_heap(arr, arr + n);
+      return;
+    }
+
+    T pivot = sortMedian(arr[0], arr[n / 2], arr[n - 1]);
+    size_t left = sortPartition<W>(arr, n, pivot);
+    if (left == 0) {
+      // pivot is the smallest element: the elements equal to it, moved to
+      // the front as those below the next value, are in place
+      if (pivot == sortLargest<T>()) {
+        return;
+      }
+      left = sortPartition<W>(arr, n, sortNext(pivot));
+      arr += left;
+      n -= left;
+      continue;
+    }
+
+    // Recursing into the smaller side bounds the stack depth
+    if (left < n - left) {
+      sortQuick<W>(arr, left, depth);
+      arr += left;
+      n -= left;
+    } else {
+      sortQuick<W>(arr + left, n - left, depth);
+      n = left;
+    }
+  }
+  sortNetwork<W>(arr, n);
+}
+
+template <int W, typename T> static void sortVec(T *const arr, size_t const N) {
+  int depth = 0;
+  for (size_t n = N; n > 1; n /= 2) {
+    depth += 2;
+  }
+  sortQuick<W>(arr, N, depth);
+}
+
+/*
+Number of elements of a (of size m) among the first d elements of the merge
+of a and b (of size n), with ties going to a as in std::merge.
+*/
+template <typename T>
+static size_t sortMergePath(T const *const a, size_t const m,
+                            T const *const b, size_t const n, size_t const d) {
+  size_t lo = d > n ? d - n : 0;
+  size_t hi = std::min(d, m);
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (b[d - mid - 1] < a[mid]) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return lo;
+}
+
+// Multithreaded version of sortVec
+template <int W, typename T>
+static void sortVecOMP(T *const arr, size_t const N) {
+  if (N <= sortBlock) {
+    sortVec<W>(arr, N);
+    return;
+  }
+  size_t blocks = (N + sortBlock - 1) / sortBlock;
+  std::vector<T> buffer(N);
+
+#pragma omp parallel
+  {
+#pragma omp for schedule(dynamic)
+    for (size_t b = 0; b < blocks; b++) {
+      size_t begin = b * sortBlock;
+      sortVec<W>(arr + begin, std::min(sortBlock, N - begin));
+    }
+
+    // Runs of "run" elements are merged pairwise from src into dst
+    T *src = arr, *dst = buffer.data();
+    for (size_t run = sortBlock; run < N; run *= 2) {
+#pragma omp for schedule(static)
+      for (size_t s = 0; s < blocks; s++) {
+        // Segments never straddle two pairs of runs, 2 * run being a
+        // multiple of sortBlock
+        size_t begin = s * sortBlock;
+        size_t end = std::min(begin + sortBlock, N);
+        size_t base = begin / (2 * run) * (2 * run);
+        T const *a = src + base;
+        size_t m = std::min(run, N - base);
+        T const *b = a + m;
+        size_t n = std::min(run, N - base - m);
+
+        size_t a_begin = sortMergePath(a, m, b, n, begin - base);
+        size_t a_end = sortMergePath(a, m, b, n, end - base);
+        std::merge(a + a_begin, a + a_end, b + (begin - base - a_begin),
+                   b + (end - base - a_end), dst + begin);
+      }
+      std::swap(src, dst);
+    }
+
+    if (src != arr) {
+#pragma omp for schedule(static)
+      for (size_t s = 0; s < blocks; s++) {
+        size_t begin = s * sortBlock;
+        std::copy(src + begin, src + std::min(begin + sortBlock, N),
+                  arr + begin);
+      }
+    }
+  }
+}
+
+// Sort kernels for int and float
+template <typename T>
+static inline void sortSSE(T *const arr, size_t const N) {
+  sortVec<4>(arr, N);
+}
+
+template <typename T>
+static inline void sortSSEOMP(T *const arr, size_t const N) {
+  sortVecOMP<4>(arr, N);
+}
+
+#ifdef __AVX2__
+template <typename T>
+static inline void sortAVX2(T *const arr, size_t const N) {
+  sortVec<8>(arr, N);
+}
+
+template <typename T>
+static inline void sortAVX2OMP(T *const arr, size_t const N) {
+  sortVecOMP<8>(arr, N);
+}
+#endif
+
+#ifdef __AVX512F__
+template <typename T>
+static inline void sortAVX512(T *const arr, size_t const N) {
+  sortVec<16>(arr, N);
+}
+
+template <typename T>
+static inline void sortAVX512OMP(T *const arr, size_t const N) {
+  sortVecOMP<16>(arr, N);
+}
+#endif
+
+#ifdef SIMD_NEON
+template <typename T>
+static inline void sortNEON(T *const arr, size_t const N) {
+  sortVec<4>(arr, N);
+}
+
+template <typename T>
+static inline void sortNEONOMP(T *const arr, size_t const N) {
+  sortVecOMP<4>(arr, N);
+}
+#endif
+
+// Sort dispatchers, in order of preference NEON, AVX-512, AVX2, SSE
+template <typename T>
+static inline void sortAuto(T *const arr, size_t const N) {
+#ifdef SIMD_NEON
+  sortNEON(arr, N);
+#elif defined(__AVX512F__)
+  sortAVX512(arr, N);
+#elif defined(__AVX2__)
+  sortAVX2(arr, N);
+#else
+  sortSSE(arr, N);
+#endif
+}
+
+template <typename T>
+static inline void sortAutoOMP(T *const arr, size_t const N) {
+#ifdef SIMD_NEON
+  sortNEONOMP(arr, N);
+#elif defined(__AVX512F__)
+  sortAVX512OMP(arr, N);
+#elif defined(__AVX2__)
+  sortAVX2OMP(arr, N);
+#else
+  sortSSEOMP(arr, N);
+#endif
+}
+
+/*
+Searching: findFirst returns the index of the first element of arr for
+which pred is true (N if there is none), and countIf the number of such
+elements; pred is one of the filter predicates above. countEq counts the
+elements equal to x.
+
+lowerBound returns the index of the first element of the sorted array arr
+that is not below x, like std::lower_bound. It halves the range without
+branches until it fits in one vector, then counts the elements below x in a
+single vector compare. For many queries over the same array, a SearchTree
+stores it as an implicit B-tree of nodes of one vector of keys each (an
+S-tree), so each level costs one vector compare instead of log2(width + 1)
+dependent loads, and the top levels stay in cache.
+*/
+static const size_t countBlock = 1 << 16;
+
+template <typename T> struct Equal {
+  T x;
+
+  template <typename V> typename V::Mask operator()(V a) const {
+    return V::eq(a, V::set1(x));
+  }
+  bool operator()(T y) const { return y == x; }
+};
+
+template <int W, typename T, typename Pred>
+static size_t findFirstVec(T const *const arr, size_t const N,
+                           Pred const pred) {
+  typedef Vec<T, W> V;
+
+  const int simd_width = V::width;
+  size_t limit = N / simd_width * simd_width;
+
+  for (size_t i = 0; i < limit; i += simd_width) {
+    unsigned found = V::bits(pred(V::load(arr + i)));
+    if (found != 0) {
+      return i + __builtin_ctz(found);
+    }
+  }
+
+  for (size_t i = limit; i < N; i++) {
+    if (pred(arr[i])) {
+      return i;
+    }
+  }
+  return N;
+}
+
+// Multithreaded version of countVec
+template <int W, typename T, typename Pred>
+static size_t countVecOMP(T const *const arr, size_t const N,
+                          Pred const pred) {
+  size_t blocks = (N + countBlock - 1) / countBlock;
+  size_t count = 0;
+
+#pragma omp parallel for reduction(+ : count)
+  for (size_t b = 0; b < blocks; b++) {
+    size_t begin = b * countBlock;
+    count += countVec<W>(arr + begin, std::min(countBlock, N - begin), pred);
+  }
+  return count;
+}
+
+template <int W, typename T>
+static size_t lowerBoundVec(T const *const arr, size_t const N, T const x) {
+  typedef Vec<T, W> V;
+
+  const int simd_width = V::width;
+  if (N < size_t(simd_width)) {
+    size_t i = 0;
+    while (i < N && arr[i] < x) {
+      i++;
+    }
+    return i;
+  }
+
+  // The answer stays in [base, base + n]; the compiler turns the update
+  // into a conditional move
+  size_t base = 0, n = N;
+  while (n > size_t(simd_width)) {
+    size_t half = n / 2;
+    // Both halves of the next step, while the comparison waits on memory
+    __builtin_prefetch(arr + base + half / 2);
+    __builtin_prefetch(arr + base + half + half / 2);
+    base = arr[base + half] < x ? base + half : base;
+    n -= half;
+  }
+
+  // Elements before base are below x and elements from base + n on are not,
+  // so counting over a whole vector containing [base, base + n) is exact
+  size_t start = std::min(base, N - simd_width);
+  typename V::Mask below = V::lt(V::load(arr + start), V::set1(x));
+  return start + __builtin_popcount(V::bits(below));
+}
+
+/*
+Static search tree over a sorted array: an implicit (W + 1)-ary B-tree whose
+nodes hold W keys, the children of node k being nodes k * (W + 1) + i + 1
+for i in [0, W]. The last node is padded with the largest value of T.
+*/
+template <typename T, int W> struct SearchTree {
+  typedef Vec<T, W> V;
+
+  size_t n, nodes;
+  std::vector<T> keys;
+  // Index in the sorted array of every key, n for the padding
+  std::vector<size_t> ranks;
+
+  SearchTree(T const *const sorted, size_t const n)
+      : n(n), nodes((n + W - 1) / W), keys(nodes * W, sortLargest<T>()),
+        ranks(nodes * W, n) {
+    size_t next = 0;
+    build(sorted, 0, next);
+  }
+
+  // Fills the subtree of node k in order
+  void build(T const *const sorted, size_t const k, size_t &next) {
+    if (k >= nodes) {
+      return;
+    }
+    for (int i = 0; i < W; i++) {
+      build(sorted, k * (W + 1) + i + 1, next);
+      if (next < n) {
+        keys[k * W + i] = sorted[next];
+        ranks[k * W + i] = next++;
+      }
+    }
+    build(sorted, k * (W + 1) + W + 1, next);
+  }
+
+  // Index of the first element of the sorted array not below x
+  size_t lowerBound(T const x) const {
+    V x_r = V::set1(x);
+    size_t result = n;
+    for (size_t k = 0; k < nodes;) {
+      int i = __builtin_popcount(V::bits(V::lt(V::load(&keys[k * W]), x_r)));
+      // The first key of the node not below x, if any, is the best so far
+      if (i < W) {
+        result = ranks[k * W + i];
+      }
+      k = k * (W + 1) + i + 1;
+    }
+    return result;
+  }
+};
+
+// Search kernels for int and float
+template <typename T, typename Pred>
+static inline size_t findFirstSSE(T const *const arr, size_t const N,
+                                  Pred const pred) {
+  return findFirstVec<4>(arr, N, pred);
+}
+
+template <typename T, typename Pred>
+static inline size_t countIfSSE(T const *const arr, size_t const N,
+                                Pred const pred) {
+  return countVec<4>(arr, N, pred);
+}
+
+template <typename T, typename Pred>
+static inline size_t countIfSSEOMP(T const *const arr, size_t const N,
+                                   Pred const pred) {
+  return countVecOMP<4>(arr, N, pred);
+}
+
+template <typename T>
+static inline size_t countEqSSE(T const *const arr, size_t const N,
+                                T const x) {
+  return countVec<4>(arr, N, Equal<T>{x});
+}
+
+template <typename T>
+static inline size_t countEqSSEOMP(T const *const arr, size_t const N,
+                                   T const x) {
+  return countVecOMP<4>(arr, N, Equal<T>{x});
+}
+
+template <typename T>
+static inline size_t lowerBoundSSE(T const *const arr, size_t const N,
+                                   T const x) {
+  return lowerBoundVec<4>(arr, N, x);
+}
+
+template <typename T> using SearchTreeSSE = SearchTree<T, 4>;
+
+#ifdef __AVX2__
+template <typename T, typename Pred>
+static inline size_t findFirstAVX2(T const *const arr, size_t const N,
+                                   Pred const pred) {
+  return findFirstVec<8>(arr, N, pred);
+}
+
+template <typename T, typename Pred>
+static inline size_t countIfAVX2(T const *const arr, size_t const N,
+                                 Pred const pred) {
+  return countVec<8>(arr, N, pred);
+}
+
+template <typename T, typename Pred>
+static inline size_t countIfAVX2OMP(T const *const arr, size_t const N,
+                                    Pred const pred) {
+  return countVecOMP<8>(arr, N, pred);
+}
+
+template <typename T>
+static inline size_t countEqAVX2(T const *const arr, size_t const N,
+                                 T const x) {
+  return countVec<8>(arr, N, Equal<T>{x});
+}
+
+template <typename T>
+static inline size_t countEqAVX2OMP(T const *const arr, size_t const N,
+                                    T const x) {
+  return countVecOMP<8>(arr, N, Equal<T>{x});
+}
+
+template <typename T>
+static inline size_t lowerBoundAVX2(T const *const arr, size_t const N,
+                                    T const x) {
+  return lowerBoundVec<8>(arr, N, x);
+}
+
+template <typename T> using SearchTreeAVX2 = SearchTree<T, 8>;
+#endif
+
+#ifdef __AVX512F__
+template <typename T, typename Pred>
+static inline size_t findFirstAVX512(T const *const arr, size_t const N,
+                                     Pred const pred) {
+  return findFirstVec<16>(arr, N, pred);
+}
+
+template <typename T, typename Pred>
+static inline size_t countIfAVX512(T const *const arr, size_t const N,
+                                   Pred const pred) {
+  return countVec<16>(arr, N, pred);
+}
+
+template <typename T, typename Pred>
+static inline size_t countIfAVX512OMP(T const *const arr, size_t const N,
+                                      Pred const pred) {
+  return countVecOMP<16>(arr, N, pred);
+}
+
+template <typename T>
+static inline size_t countEqAVX512(T const *const arr, size_t const N,
+                                   T const x) {
+  return countVec<16>(arr, N, Equal<T>{x});
+}
+
+template <typename T>
+static inline size_t countEqAVX512OMP(T const *const arr, size_t const N,
+                                      T const x) {
+  return countVecOMP<16>(arr, N, Equal<T>{x});
+}
+
+template <typename T>
+static inline size_t lowerBoundAVX512(T const *const arr, size_t const N,
+                                      T const x) {
+  return lowerBoundVec<16>(arr, N, x);
+}
+
+template <typename T> using SearchTreeAVX512 = SearchTree<T, 16>;
+#endif
+
+#ifdef SIMD_NEON
+template <typename T, typename Pred>
+static inline size_t findFirstNEON(T const *const arr, size_t const N,
+                                   Pred const pred) {
+  return findFirstVec<4>(arr, N, pred);
+}
+
+template <typename T, typename Pred>
+static inline size_t countIfNEON(T const *const arr, size_t const N,
+                                 Pred const pred) {
+  return countVec<4>(arr, N, pred);
+}
+
+template <typename T, typename Pred>
+static inline size_t countIfNEONOMP(T const *const arr, size_t const N,
+                                    Pred const pred) {
+  return countVecOMP<4>(arr, N, pred);
+}
+
+template <typename T>
+static inline size_t countEqNEON(T const *const arr, size_t const N,
+                                 T const x) {
+  return countVec<4>(arr, N, Equal<T>{x});
+}
+
+template <typename T>
+static inline size_t countEqNEONOMP(T const *const arr, size_t const N,
+                                    T const x) {
+  return countVecOMP<4>(arr, N, Equal<T>{x});
+}
+
+template <typename T>
+static inline size_t lowerBoundNEON(T const *const arr, size_t const N,
+                                    T const x) {
+  return lowerBoundVec<4>(arr, N, x);
+}
+
+template <typename T> using SearchTreeNEON = SearchTree<T, 4>;
 #endif
 
-#endif // include_simd_h
\ No newline at end of file
+#endif // include_simd_h
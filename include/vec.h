@@ -0,0 +1,1076 @@
+#ifndef include_vec_h
+#define include_vec_h
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+On AArch64 the SSE backend runs through sse2neon.h, which translates the SSE
+intrinsics to NEON. The native NEON backend of Vec<T, 4>, and the NEON
+kernels of simd.h, have not yet been built and run on AArch64, so they are
+compiled only when asked for with -DSIMD_NATIVE_NEON; scripts/qemu-aarch64.sh
+builds them so. SIMD_SSE is defined when the SSE backend is used, SIMD_NEON
+when the native NEON one is.
+*/
+#ifdef __x86_64__
+#include <immintrin.h>
+#ifndef __SSE4_1__
+#error "vec.h needs SSE4.1, build with -march=native or -msse4.1"
+#endif
+#define SIMD_SSE 1
+#elif defined(__aarch64__) && defined(__ARM_NEON) && defined(SIMD_NATIVE_NEON)
+#include <arm_neon.h>
+#define SIMD_NEON 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include "sse2neon.h"
+#define SIMD_SSE 1
+#endif
+
+/*
+Thin wrappers around one SIMD register of "Width" lanes of type T, so that a
+kernel can be written once as a template over Vec and instantiated for every
+instruction set. All members are static inline functions over the raw
+register, which the compiler reduces to the bare intrinsics.
+
+Backends:
+  Vec<float, 4>,  Vec<int, 4>  : SSE, through sse2neon.h on AArch64, or
+                                 native NEON (see above)
+  Vec<float, 8>,  Vec<int, 8>  : AVX2
+  Vec<float, 16>, Vec<int, 16> : AVX-512F
+
+Every backend provides:
+  width                    number of lanes
+  Mask                     result of a lane-wise comparison; a vector on
+                           SSE/AVX2/NEON, a k-register on AVX-512
+  load(p), store(p, a)     unaligned load and store of "width" elements
+  set1(x), zero()          broadcast
+  add, sub, min, max       lane-wise arithmetic
+  lt, gt, eq               lane-wise comparison, giving a Mask
+  select(m, a, b)          a in the lanes set in m, b elsewhere
+  bits(m)                  the mask as an integer, lane i in bit i
+  reduceMin, reduceMax,
+  reduceAdd                horizontal reduction to a scalar
+  shiftUp<k>(a)            lane i gets lane i - k of a, the low k lanes get 0
+                           (0 < k < width)
+  scan(a)                  inclusive prefix sum across the lanes, by
+                           log2(width) shift-and-add steps
+  shiftDown<k>(a)          lane i gets lane i + k of a, the high k lanes
+                           get 0 (0 < k < width)
+  broadcastLast(a)         the last lane of a in every lane
+  broadcastFirst(a)        the first lane of a in every lane
+  fromBits(b)              the Mask with lane i set where bit i of b is set
+  partition(a, m)          the lanes of a set in m first, then the others,
+                           each in order
+  compressStore(p, a, m)   stores the lanes of a set in m contiguously at p
+                           and returns their number; may write all "width"
+                           elements at p
+  swapLanes<j>(a)          lane i gets lane i ^ j of a (j a power of two
+                           below width)
+float vectors also provide mul, fmadd(a, b, c) = a * b + c (fused where the
+target has FMA), isnan and signbit (the lanes with the sign bit set, -0
+included), int vectors provide abs and increment(count, m), which adds one
+to the lanes of count set in m (m may come from a float or an int
+comparison), and truncate(f), which converts a Vec<float, W> to int rounding
+toward zero (out-of-range lanes and NaN give an unspecified value).
+float vectors are also seen as width / 4 blocks of 4 lanes for records of
+four floats: loadBlocks(p, stride) and storeBlocks(p, stride, a) load and
+store block b at p + b * stride, and transpose4(a, b, c, d) transposes the
+4x4 matrix whose rows are block b of a, b, c and d, for every block b.
+gather(p, idx) loads p[idx[i]] into lane i, with the gather instructions
+of AVX2 and AVX-512 and one load per lane on SSE and NEON.
+maskMin(m, a, b) and maskMax(m, a, b) are min(a, b) and max(a, b) in the
+lanes set in m and a elsewhere: a masked min/max on AVX-512, a min/max and
+a blend on the others.
+
+int vectors also have a Wide accumulator of 64-bit lanes for sums that must
+not overflow: addWide(acc, a) sign-extends every lane of a and adds it to
+acc, and reduceWide(acc) adds up all lanes of acc.
+
+min(a, b) and max(a, b) return a in any lane where b is NaN, so an
+accumulator passed as "a" that starts out as a number never becomes NaN. On
+x86 this is the rule that min/max return their second operand when either is
+NaN, with the operands swapped; NEON gets it from FMINNM/FMAXNM. Which zero
+is returned when a and b are -0 and +0 is unspecified. The float reductions
+expect vectors without NaNs.
+*/
+template <typename T, int Width> struct Vec;
+
+/*
+Lookup tables for compressStore. For every mask of 4 lanes, the byte shuffle
+moving the 32-bit lanes set in the mask to the front (SSE pshufb and NEON
+tbl), and for every mask of 8 lanes the lane permutation doing the same
+(AVX2 vpermd). The other lanes follow in order, so the same tables serve
+partition.
+*/
+struct CompressTable {
+  uint8_t shuffle4[16][16];
+  uint32_t permute8[256][8];
+
+  CompressTable() {
+    for (unsigned m = 0; m < 16; m++) {
+      unsigned k = 0;
+      for (unsigned lane = 0; lane < 4; lane++) {
+        if (m & (1u << lane)) {
+          for (unsigned byte = 0; byte < 4; byte++) {
+            shuffle4[m][4 * k + byte] = 4 * lane + byte;
+          }
+          k++;
+        }
+      }
+      for (unsigned lane = 0; lane < 4; lane++) {
+        if (!(m & (1u << lane))) {
+          for (unsigned byte = 0; byte < 4; byte++) {
+            shuffle4[m][4 * k + byte] = 4 * lane + byte;
+          }
+          k++;
+        }
+      }
+    }
+    for (unsigned m = 0; m < 256; m++) {
+      unsigned k = 0;
+      for (unsigned lane = 0; lane < 8; lane++) {
+        if (m & (1u << lane)) {
+          permute8[m][k++] = lane;
+        }
+      }
+      for (unsigned lane = 0; lane < 8; lane++) {
+        if (!(m & (1u << lane))) {
+          permute8[m][k++] = lane;
+        }
+      }
+    }
+  }
+};
+
+static inline const CompressTable &compressTable() {
+  static const CompressTable table;
+  return table;
+}
+
+#ifdef SIMD_SSE
+template <> struct Vec<float, 4> {
+  static constexpr int width = 4;
+  typedef __m128 Mask;
+
+  __m128 r;
+
+  static Vec load(float const *const p) { return {_mm_loadu_ps(p)}; }
+  static void store(float *const p, Vec a) { _mm_storeu_ps(p, a.r); }
+  static Vec set1(float x) { return {_mm_set1_ps(x)}; }
+  static Vec zero() { return {_mm_setzero_ps()}; }
+
+  static Vec add(Vec a, Vec b) { return {_mm_add_ps(a.r, b.r)}; }
+  static Vec sub(Vec a, Vec b) { return {_mm_sub_ps(a.r, b.r)}; }
+
+  template <int k> static Vec shiftUp(Vec a) {
+    return {_mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(a.r), 4 * k))};
+  }
+  static Vec scan(Vec a) {
+    a = add(a, shiftUp<1>(a));
+    return add(a, shiftUp<2>(a));
+  }
+  static Vec broadcastLast(Vec a) {
+    return {_mm_shuffle_ps(a.r, a.r, _MM_SHUFFLE(3, 3, 3, 3))};
+  }
+  template <int k> static Vec shiftDown(Vec a) {
+    return {_mm_castsi128_ps(_mm_srli_si128(_mm_castps_si128(a.r), 4 * k))};
+  }
+  static Vec broadcastFirst(Vec a) {
+    return {_mm_shuffle_ps(a.r, a.r, _MM_SHUFFLE(0, 0, 0, 0))};
+  }
+  static Vec mul(Vec a, Vec b) { return {_mm_mul_ps(a.r, b.r)}; }
+  static Vec fmadd(Vec a, Vec b, Vec c) {
+#ifdef __FMA__
+    return {_mm_fmadd_ps(a.r, b.r, c.r)};
+#else
+    return {_mm_add_ps(_mm_mul_ps(a.r, b.r), c.r)};
+#endif
+  }
+  static Vec min(Vec a, Vec b) { return {_mm_min_ps(b.r, a.r)}; }
+  static Vec max(Vec a, Vec b) { return {_mm_max_ps(b.r, a.r)}; }
+
+  static Mask lt(Vec a, Vec b) { return _mm_cmplt_ps(a.r, b.r); }
+  static Mask gt(Vec a, Vec b) { return _mm_cmpgt_ps(a.r, b.r); }
+  static Mask eq(Vec a, Vec b) { return _mm_cmpeq_ps(a.r, b.r); }
+  static Mask isnan(Vec a) { return _mm_cmpunord_ps(a.r, a.r); }
+  static Mask signbit(Vec a) {
+    return _mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(a.r), 31));
+  }
+  static Vec select(Mask m, Vec a, Vec b) {
+    return {_mm_blendv_ps(b.r, a.r, m)};
+  }
+  static unsigned bits(Mask m) { return _mm_movemask_ps(m); }
+  static Mask fromBits(unsigned b) {
+    __m128i lane_bits = _mm_setr_epi32(1, 2, 4, 8);
+    return _mm_castsi128_ps(_mm_cmpeq_epi32(
+        _mm_and_si128(_mm_set1_epi32(b), lane_bits), lane_bits));
+  }
+  static Vec partition(Vec a, Mask m) {
+    __m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+        compressTable().shuffle4[bits(m)]));
+    return {_mm_castsi128_ps(_mm_shuffle_epi8(_mm_castps_si128(a.r), shuffle))};
+  }
+  static int compressStore(float *const p, Vec a, Mask m) {
+    store(p, partition(a, m));
+    return __builtin_popcount(bits(m));
+  }
+  template <int j> static Vec swapLanes(Vec a) {
+    return {_mm_shuffle_ps(a.r, a.r,
+                           j == 1 ? _MM_SHUFFLE(2, 3, 0, 1)
+                                  : _MM_SHUFFLE(1, 0, 3, 2))};
+  }
+  static Vec loadBlocks(float const *const p, size_t) { return load(p); }
+  static void storeBlocks(float *const p, size_t, Vec a) { store(p, a); }
+  static void transpose4(Vec &a, Vec &b, Vec &c, Vec &d) {
+    _MM_TRANSPOSE4_PS(a.r, b.r, c.r, d.r);
+  }
+  static Vec gather(float const *const p, int const *const idx) {
+    return {_mm_setr_ps(p[idx[0]], p[idx[1]], p[idx[2]], p[idx[3]])};
+  }
+  static Vec maskMin(Mask m, Vec a, Vec b) {
+    return {_mm_blendv_ps(a.r, _mm_min_ps(b.r, a.r), m)};
+  }
+  static Vec maskMax(Mask m, Vec a, Vec b) {
+    return {_mm_blendv_ps(a.r, _mm_max_ps(b.r, a.r), m)};
+  }
+
+  static float reduceMin(Vec a) {
+    __m128 m = _mm_min_ps(a.r, _mm_movehl_ps(a.r, a.r));
+    m = _mm_min_ss(m, _mm_shuffle_ps(m, m, 1));
+    return _mm_cvtss_f32(m);
+  }
+  static float reduceMax(Vec a) {
+    __m128 m = _mm_max_ps(a.r, _mm_movehl_ps(a.r, a.r));
+    m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+    return _mm_cvtss_f32(m);
+  }
+  static float reduceAdd(Vec a) {
+    __m128 s = _mm_add_ps(a.r, _mm_movehl_ps(a.r, a.r));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+  }
+};
+
+template <> struct Vec<int, 4> {
+  static constexpr int width = 4;
+  typedef __m128i Mask;
+
+  __m128i r;
+
+  static Vec load(int const *const p) {
+    return {_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))};
+  }
+  static void store(int *const p, Vec a) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), a.r);
+  }
+  static Vec set1(int x) { return {_mm_set1_epi32(x)}; }
+  static Vec zero() { return {_mm_setzero_si128()}; }
+
+  static Vec add(Vec a, Vec b) { return {_mm_add_epi32(a.r, b.r)}; }
+  static Vec sub(Vec a, Vec b) { return {_mm_sub_epi32(a.r, b.r)}; }
+
+  template <int k> static Vec shiftUp(Vec a) {
+    return {_mm_slli_si128(a.r, 4 * k)};
+  }
+  static Vec scan(Vec a) {
+    a = add(a, shiftUp<1>(a));
+    return add(a, shiftUp<2>(a));
+  }
+  static Vec broadcastLast(Vec a) {
+    return {_mm_shuffle_epi32(a.r, _MM_SHUFFLE(3, 3, 3, 3))};
+  }
+  template <int k> static Vec shiftDown(Vec a) {
+    return {_mm_srli_si128(a.r, 4 * k)};
+  }
+  static Vec broadcastFirst(Vec a) {
+    return {_mm_shuffle_epi32(a.r, _MM_SHUFFLE(0, 0, 0, 0))};
+  }
+  static Vec min(Vec a, Vec b) { return {_mm_min_epi32(a.r, b.r)}; }
+  static Vec max(Vec a, Vec b) { return {_mm_max_epi32(a.r, b.r)}; }
+  static Vec abs(Vec a) { return {_mm_abs_epi32(a.r)}; }
+  static Vec truncate(Vec<float, 4> f) { return {_mm_cvttps_epi32(f.r)}; }
+
+  static Mask lt(Vec a, Vec b) { return _mm_cmplt_epi32(a.r, b.r); }
+  static Mask gt(Vec a, Vec b) { return _mm_cmpgt_epi32(a.r, b.r); }
+  static Mask eq(Vec a, Vec b) { return _mm_cmpeq_epi32(a.r, b.r); }
+  static Vec select(Mask m, Vec a, Vec b) {
+    return {_mm_blendv_epi8(b.r, a.r, m)};
+  }
+  static unsigned bits(Mask m) {
+    return _mm_movemask_ps(_mm_castsi128_ps(m));
+  }
+  static Mask fromBits(unsigned b) {
+    __m128i lane_bits = _mm_setr_epi32(1, 2, 4, 8);
+    return _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(b), lane_bits),
+                           lane_bits);
+  }
+  static Vec partition(Vec a, Mask m) {
+    __m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+        compressTable().shuffle4[bits(m)]));
+    return {_mm_shuffle_epi8(a.r, shuffle)};
+  }
+  static int compressStore(int *const p, Vec a, Mask m) {
+    store(p, partition(a, m));
+    return __builtin_popcount(bits(m));
+  }
+  template <int j> static Vec swapLanes(Vec a) {
+    return {_mm_shuffle_epi32(a.r, j == 1 ? _MM_SHUFFLE(2, 3, 0, 1)
+                                          : _MM_SHUFFLE(1, 0, 3, 2))};
+  }
+
+  // All-ones mask lanes are -1, so subtracting the mask adds one
+  static Vec increment(Vec count, Mask m) {
+    return {_mm_sub_epi32(count.r, m)};
+  }
+  static Vec increment(Vec count, __m128 m) {
+    return increment(count, _mm_castps_si128(m));
+  }
+
+  static int reduceMin(Vec a) {
+    __m128i m = _mm_min_epi32(a.r, _mm_shuffle_epi32(a.r, 0x4E));
+    m = _mm_min_epi32(m, _mm_shuffle_epi32(m, 0xB1));
+    return _mm_cvtsi128_si32(m);
+  }
+  static int reduceMax(Vec a) {
+    __m128i m = _mm_max_epi32(a.r, _mm_shuffle_epi32(a.r, 0x4E));
+    m = _mm_max_epi32(m, _mm_shuffle_epi32(m, 0xB1));
+    return _mm_cvtsi128_si32(m);
+  }
+  // Widened to 64 bits, so the sum of the lanes cannot overflow
+  static int64_t reduceAdd(Vec a) {
+    int lanes[width];
+    store(lanes, a);
+    return int64_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+  }
+
+  struct Wide {
+    __m128i lo, hi;
+  };
+  static Wide zeroWide() { return {_mm_setzero_si128(), _mm_setzero_si128()}; }
+  static Wide addWide(Wide acc, Vec a) {
+    return {_mm_add_epi64(acc.lo, _mm_cvtepi32_epi64(a.r)),
+            _mm_add_epi64(acc.hi, _mm_cvtepi32_epi64(_mm_srli_si128(a.r, 8)))};
+  }
+  static int64_t reduceWide(Wide acc) {
+    __m128i s = _mm_add_epi64(acc.lo, acc.hi);
+    return _mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1);
+  }
+};
+#endif
+
+#ifdef __AVX2__
+template <> struct Vec<float, 8> {
+  static constexpr int width = 8;
+  typedef __m256 Mask;
+
+  __m256 r;
+
+  static Vec load(float const *const p) { return {_mm256_loadu_ps(p)}; }
+  static void store(float *const p, Vec a) { _mm256_storeu_ps(p, a.r); }
+  static Vec set1(float x) { return {_mm256_set1_ps(x)}; }
+  static Vec zero() { return {_mm256_setzero_ps()}; }
+
+  static Vec add(Vec a, Vec b) { return {_mm256_add_ps(a.r, b.r)}; }
+  static Vec sub(Vec a, Vec b) { return {_mm256_sub_ps(a.r, b.r)}; }
+
+  // alignr shifts within each 128-bit half, so the low half is shifted in
+  // from [0, low half]
+  template <int k> static Vec shiftUp(Vec a) {
+    __m256i i = _mm256_castps_si256(a.r);
+    __m256i low = _mm256_permute2x128_si256(i, i, 0x08);
+    return {_mm256_castsi256_ps(_mm256_alignr_epi8(i, low, 16 - 4 * k))};
+  }
+  static Vec scan(Vec a) {
+    a = add(a, shiftUp<1>(a));
+    a = add(a, shiftUp<2>(a));
+    return add(a, shiftUp<4>(a));
+  }
+  static Vec broadcastLast(Vec a) {
+    return {_mm256_permutevar8x32_ps(a.r, _mm256_set1_epi32(7))};
+  }
+  template <int k> static Vec shiftDown(Vec a) {
+    __m256i i = _mm256_castps_si256(a.r);
+    __m256i high = _mm256_permute2x128_si256(i, i, 0x81);
+    return {_mm256_castsi256_ps(_mm256_alignr_epi8(high, i, 4 * k))};
+  }
+  static Vec broadcastFirst(Vec a) {
+    return {_mm256_permutevar8x32_ps(a.r, _mm256_setzero_si256())};
+  }
+  static Vec mul(Vec a, Vec b) { return {_mm256_mul_ps(a.r, b.r)}; }
+  static Vec fmadd(Vec a, Vec b, Vec c) {
+#ifdef __FMA__
+    return {_mm256_fmadd_ps(a.r, b.r, c.r)};
+#else
+    return {_mm256_add_ps(_mm256_mul_ps(a.r, b.r), c.r)};
+#endif
+  }
+  static Vec min(Vec a, Vec b) { return {_mm256_min_ps(b.r, a.r)}; }
+  static Vec max(Vec a, Vec b) { return {_mm256_max_ps(b.r, a.r)}; }
+
+  static Mask lt(Vec a, Vec b) { return _mm256_cmp_ps(a.r, b.r, _CMP_LT_OQ); }
+  static Mask gt(Vec a, Vec b) { return _mm256_cmp_ps(a.r, b.r, _CMP_GT_OQ); }
+  static Mask eq(Vec a, Vec b) { return _mm256_cmp_ps(a.r, b.r, _CMP_EQ_OQ); }
+  static Mask isnan(Vec a) { return _mm256_cmp_ps(a.r, a.r, _CMP_UNORD_Q); }
+  static Mask signbit(Vec a) {
+    return _mm256_castsi256_ps(_mm256_srai_epi32(_mm256_castps_si256(a.r), 31));
+  }
+  static Vec select(Mask m, Vec a, Vec b) {
+    return {_mm256_blendv_ps(b.r, a.r, m)};
+  }
+  static unsigned bits(Mask m) { return _mm256_movemask_ps(m); }
+  static Mask fromBits(unsigned b) {
+    __m256i lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    return _mm256_castsi256_ps(_mm256_cmpeq_epi32(
+        _mm256_and_si256(_mm256_set1_epi32(b), lane_bits), lane_bits));
+  }
+  static Vec partition(Vec a, Mask m) {
+    __m256i permute = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(
+        compressTable().permute8[bits(m)]));
+    return {_mm256_permutevar8x32_ps(a.r, permute)};
+  }
+  static int compressStore(float *const p, Vec a, Mask m) {
+    store(p, partition(a, m));
+    return __builtin_popcount(bits(m));
+  }
+  template <int j> static Vec swapLanes(Vec a) {
+    if constexpr (j == 4) {
+      return {_mm256_permute2f128_ps(a.r, a.r, 1)};
+    } else {
+      return {_mm256_permute_ps(a.r, j == 1 ? _MM_SHUFFLE(2, 3, 0, 1)
+                                            : _MM_SHUFFLE(1, 0, 3, 2))};
+    }
+  }
+  static Vec loadBlocks(float const *const p, size_t const stride) {
+    return {_mm256_set_m128(_mm_loadu_ps(p + stride), _mm_loadu_ps(p))};
+  }
+  static void storeBlocks(float *const p, size_t const stride, Vec a) {
+    _mm_storeu_ps(p, _mm256_castps256_ps128(a.r));
+    _mm_storeu_ps(p + stride, _mm256_extractf128_ps(a.r, 1));
+  }
+  static void transpose4(Vec &a, Vec &b, Vec &c, Vec &d) {
+    __m256 ab_low = _mm256_unpacklo_ps(a.r, b.r);
+    __m256 cd_low = _mm256_unpacklo_ps(c.r, d.r);
+    __m256 ab_high = _mm256_unpackhi_ps(a.r, b.r);
+    __m256 cd_high = _mm256_unpackhi_ps(c.r, d.r);
+    a.r = _mm256_shuffle_ps(ab_low, cd_low, _MM_SHUFFLE(1, 0, 1, 0));
+    b.r = _mm256_shuffle_ps(ab_low, cd_low, _MM_SHUFFLE(3, 2, 3, 2));
+    c.r = _mm256_shuffle_ps(ab_high, cd_high, _MM_SHUFFLE(1, 0, 1, 0));
+    d.r = _mm256_shuffle_ps(ab_high, cd_high, _MM_SHUFFLE(3, 2, 3, 2));
+  }
+  static Vec gather(float const *const p, int const *const idx) {
+    __m256i idx_r = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(idx));
+    return {_mm256_i32gather_ps(p, idx_r, 4)};
+  }
+  static Vec maskMin(Mask m, Vec a, Vec b) {
+    return {_mm256_blendv_ps(a.r, _mm256_min_ps(b.r, a.r), m)};
+  }
+  static Vec maskMax(Mask m, Vec a, Vec b) {
+    return {_mm256_blendv_ps(a.r, _mm256_max_ps(b.r, a.r), m)};
+  }
+
+  static float reduceMin(Vec a) {
+    return Vec<float, 4>::reduceMin({_mm_min_ps(
+        _mm256_castps256_ps128(a.r), _mm256_extractf128_ps(a.r, 1))});
+  }
+  static float reduceMax(Vec a) {
+    return Vec<float, 4>::reduceMax({_mm_max_ps(
+        _mm256_castps256_ps128(a.r), _mm256_extractf128_ps(a.r, 1))});
+  }
+  static float reduceAdd(Vec a) {
+    return Vec<float, 4>::reduceAdd({_mm_add_ps(
+        _mm256_castps256_ps128(a.r), _mm256_extractf128_ps(a.r, 1))});
+  }
+};
+
+template <> struct Vec<int, 8> {
+  static constexpr int width = 8;
+  typedef __m256i Mask;
+
+  __m256i r;
+
+  static Vec load(int const *const p) {
+    return {_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p))};
+  }
+  static void store(int *const p, Vec a) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), a.r);
+  }
+  static Vec set1(int x) { return {_mm256_set1_epi32(x)}; }
+  static Vec zero() { return {_mm256_setzero_si256()}; }
+
+  static Vec add(Vec a, Vec b) { return {_mm256_add_epi32(a.r, b.r)}; }
+  static Vec sub(Vec a, Vec b) { return {_mm256_sub_epi32(a.r, b.r)}; }
+
+  // As in Vec<float, 8>
+  template <int k> static Vec shiftUp(Vec a) {
+    __m256i low = _mm256_permute2x128_si256(a.r, a.r, 0x08);
+    return {_mm256_alignr_epi8(a.r, low, 16 - 4 * k)};
+  }
+  static Vec scan(Vec a) {
+    a = add(a, shiftUp<1>(a));
+    a = add(a, shiftUp<2>(a));
+    return add(a, shiftUp<4>(a));
+  }
+  static Vec broadcastLast(Vec a) {
+    return {_mm256_permutevar8x32_epi32(a.r, _mm256_set1_epi32(7))};
+  }
+  template <int k> static Vec shiftDown(Vec a) {
+    __m256i high = _mm256_permute2x128_si256(a.r, a.r, 0x81);
+    return {_mm256_alignr_epi8(high, a.r, 4 * k)};
+  }
+  static Vec broadcastFirst(Vec a) {
+    return {_mm256_permutevar8x32_epi32(a.r, _mm256_setzero_si256())};
+  }
+  static Vec min(Vec a, Vec b) { return {_mm256_min_epi32(a.r, b.r)}; }
+  static Vec max(Vec a, Vec b) { return {_mm256_max_epi32(a.r, b.r)}; }
+  static Vec abs(Vec a) { return {_mm256_abs_epi32(a.r)}; }
+  static Vec truncate(Vec<float, 8> f) {
+    return {_mm256_cvttps_epi32(f.r)};
+  }
+
+  static Mask lt(Vec a, Vec b) { return _mm256_cmpgt_epi32(b.r, a.r); }
+  static Mask gt(Vec a, Vec b) { return _mm256_cmpgt_epi32(a.r, b.r); }
+  static Mask eq(Vec a, Vec b) { return _mm256_cmpeq_epi32(a.r, b.r); }
+  static Vec select(Mask m, Vec a, Vec b) {
+    return {_mm256_blendv_epi8(b.r, a.r, m)};
+  }
+  static unsigned bits(Mask m) {
+    return _mm256_movemask_ps(_mm256_castsi256_ps(m));
+  }
+  static Mask fromBits(unsigned b) {
+    __m256i lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    return _mm256_cmpeq_epi32(
+        _mm256_and_si256(_mm256_set1_epi32(b), lane_bits), lane_bits);
+  }
+  static Vec partition(Vec a, Mask m) {
+    __m256i permute = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(
+        compressTable().permute8[bits(m)]));
+    return {_mm256_permutevar8x32_epi32(a.r, permute)};
+  }
+  static int compressStore(int *const p, Vec a, Mask m) {
+    store(p, partition(a, m));
+    return __builtin_popcount(bits(m));
+  }
+  template <int j> static Vec swapLanes(Vec a) {
+    if constexpr (j == 4) {
+      return {_mm256_permute2x128_si256(a.r, a.r, 1)};
+    } else {
+      return {_mm256_shuffle_epi32(a.r, j == 1 ? _MM_SHUFFLE(2, 3, 0, 1)
+                                               : _MM_SHUFFLE(1, 0, 3, 2))};
+    }
+  }
+
+  static Vec increment(Vec count, Mask m) {
+    return {_mm256_sub_epi32(count.r, m)};
+  }
+  static Vec increment(Vec count, __m256 m) {
+    return increment(count, _mm256_castps_si256(m));
+  }
+
+  static int reduceMin(Vec a) {
+    return Vec<int, 4>::reduceMin({_mm_min_epi32(
+        _mm256_castsi256_si128(a.r), _mm256_extracti128_si256(a.r, 1))});
+  }
+  static int reduceMax(Vec a) {
+    return Vec<int, 4>::reduceMax({_mm_max_epi32(
+        _mm256_castsi256_si128(a.r), _mm256_extracti128_si256(a.r, 1))});
+  }
+  static int64_t reduceAdd(Vec a) {
+    return Vec<int, 4>::reduceAdd({_mm256_castsi256_si128(a.r)}) +
+           Vec<int, 4>::reduceAdd({_mm256_extracti128_si256(a.r, 1)});
+  }
+
+  struct Wide {
+    __m256i lo, hi;
+  };
+  static Wide zeroWide() {
+    return {_mm256_setzero_si256(), _mm256_setzero_si256()};
+  }
+  static Wide addWide(Wide acc, Vec a) {
+    __m256i lo = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(a.r));
+    __m256i hi = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(a.r, 1));
+    return {_mm256_add_epi64(acc.lo, lo), _mm256_add_epi64(acc.hi, hi)};
+  }
+  static int64_t reduceWide(Wide acc) {
+    __m256i s = _mm256_add_epi64(acc.lo, acc.hi);
+    return Vec<int, 4>::reduceWide(
+        {_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1)});
+  }
+};
+#endif
+
+#ifdef __AVX512F__
+template <> struct Vec<float, 16> {
+  static constexpr int width = 16;
+  typedef __mmask16 Mask;
+  static constexpr Mask all = 0xFFFF;
+
+  __m512 r;
+
+  static Vec load(float const *const p) { return {_mm512_loadu_ps(p)}; }
+  static void store(float *const p, Vec a) { _mm512_storeu_ps(p, a.r); }
+  static Vec set1(float x) { return {_mm512_set1_ps(x)}; }
+  static Vec zero() { return {_mm512_setzero_ps()}; }
+
+  static Vec add(Vec a, Vec b) { return {_mm512_add_ps(a.r, b.r)}; }
+  static Vec sub(Vec a, Vec b) { return {_mm512_sub_ps(a.r, b.r)}; }
+
+  template <int k> static Vec shiftUp(Vec a) {
+    return {_mm512_castsi512_ps(_mm512_maskz_alignr_epi32(
+        all, _mm512_castps_si512(a.r), _mm512_setzero_si512(), 16 - k))};
+  }
+  static Vec scan(Vec a) {
+    a = add(a, shiftUp<1>(a));
+    a = add(a, shiftUp<2>(a));
+    a = add(a, shiftUp<4>(a));
+    return add(a, shiftUp<8>(a));
+  }
+  static Vec broadcastLast(Vec a) {
+    return {_mm512_maskz_permutexvar_ps(all, _mm512_set1_epi32(15), a.r)};
+  }
+  template <int k> static Vec shiftDown(Vec a) {
+    return {_mm512_castsi512_ps(_mm512_maskz_alignr_epi32(
+        all, _mm512_setzero_si512(), _mm512_castps_si512(a.r), k))};
+  }
+  static Vec broadcastFirst(Vec a) {
+    return {_mm512_maskz_permutexvar_ps(all, _mm512_setzero_si512(), a.r)};
+  }
+  static Vec mul(Vec a, Vec b) { return {_mm512_mul_ps(a.r, b.r)}; }
+  static Vec fmadd(Vec a, Vec b, Vec c) {
+    return {_mm512_fmadd_ps(a.r, b.r, c.r)};
+  }
+  // The all-lanes maskz forms compile to the plain instructions. The unmasked
+  // intrinsics use an _mm512_undefined_* placeholder that GCC 12 reports as
+  // uninitialized once inlined into an OpenMP region, as it does for the
+  // _mm512_reduce_* and 512-bit extract intrinsics avoided below.
+  static Vec min(Vec a, Vec b) {
+    return {_mm512_maskz_min_ps(all, b.r, a.r)};
+  }
+  static Vec max(Vec a, Vec b) {
+    return {_mm512_maskz_max_ps(all, b.r, a.r)};
+  }
+
+  static Mask lt(Vec a, Vec b) {
+    return _mm512_cmp_ps_mask(a.r, b.r, _CMP_LT_OQ);
+  }
+  static Mask gt(Vec a, Vec b) {
+    return _mm512_cmp_ps_mask(a.r, b.r, _CMP_GT_OQ);
+  }
+  static Mask eq(Vec a, Vec b) {
+    return _mm512_cmp_ps_mask(a.r, b.r, _CMP_EQ_OQ);
+  }
+  static Mask isnan(Vec a) {
+    return _mm512_cmp_ps_mask(a.r, a.r, _CMP_UNORD_Q);
+  }
+  static Mask signbit(Vec a) {
+    return _mm512_cmplt_epi32_mask(_mm512_castps_si512(a.r),
+                                   _mm512_setzero_si512());
+  }
+  static Vec select(Mask m, Vec a, Vec b) {
+    return {_mm512_mask_blend_ps(m, b.r, a.r)};
+  }
+  static unsigned bits(Mask m) { return m; }
+  // Writes only the selected lanes
+  static Mask fromBits(unsigned b) { return Mask(b); }
+  // The other lanes are compressed too and expanded above the selected ones
+  static Vec partition(Vec a, Mask m) {
+    Mask high = Mask(~0u << __builtin_popcount(m));
+    __m512 selected = _mm512_maskz_compress_ps(m, a.r);
+    __m512 others = _mm512_maskz_compress_ps(Mask(~m), a.r);
+    return {_mm512_mask_expand_ps(selected, high, others)};
+  }
+  static int compressStore(float *const p, Vec a, Mask m) {
+    _mm512_mask_compressstoreu_ps(p, m, a.r);
+    return __builtin_popcount(m);
+  }
+  template <int j> static Vec swapLanes(Vec a) {
+    if constexpr (j == 8) {
+      return {_mm512_maskz_shuffle_f32x4(all, a.r, a.r,
+                                         _MM_SHUFFLE(1, 0, 3, 2))};
+    } else if constexpr (j == 4) {
+      return {_mm512_maskz_shuffle_f32x4(all, a.r, a.r,
+                                         _MM_SHUFFLE(2, 3, 0, 1))};
+    } else {
+      return {_mm512_maskz_permute_ps(all, a.r,
+                                      j == 1 ? _MM_SHUFFLE(2, 3, 0, 1)
+                                             : _MM_SHUFFLE(1, 0, 3, 2))};
+    }
+  }
+  static Vec loadBlocks(float const *const p, size_t const stride) {
+    __m512 r = _mm512_zextps128_ps512(_mm_loadu_ps(p));
+    r = _mm512_insertf32x4(r, _mm_loadu_ps(p + stride), 1);
+    r = _mm512_insertf32x4(r, _mm_loadu_ps(p + 2 * stride), 2);
+    return {_mm512_insertf32x4(r, _mm_loadu_ps(p + 3 * stride), 3)};
+  }
+  static void storeBlocks(float *const p, size_t const stride, Vec a) {
+    _mm_storeu_ps(p, _mm512_maskz_extractf32x4_ps(0xF, a.r, 0));
+    _mm_storeu_ps(p + stride, _mm512_maskz_extractf32x4_ps(0xF, a.r, 1));
+    _mm_storeu_ps(p + 2 * stride, _mm512_maskz_extractf32x4_ps(0xF, a.r, 2));
+    _mm_storeu_ps(p + 3 * stride, _mm512_maskz_extractf32x4_ps(0xF, a.r, 3));
+  }
+  static void transpose4(Vec &a, Vec &b, Vec &c, Vec &d) {
+    __m512 ab_low = _mm512_maskz_unpacklo_ps(all, a.r, b.r);
+    __m512 cd_low = _mm512_maskz_unpacklo_ps(all, c.r, d.r);
+    __m512 ab_high = _mm512_maskz_unpackhi_ps(all, a.r, b.r);
+    __m512 cd_high = _mm512_maskz_unpackhi_ps(all, c.r, d.r);
+    a.r = _mm512_maskz_shuffle_ps(all, ab_low, cd_low, _MM_SHUFFLE(1, 0, 1, 0));
+    b.r = _mm512_maskz_shuffle_ps(all, ab_low, cd_low, _MM_SHUFFLE(3, 2, 3, 2));
+    c.r =
+        _mm512_maskz_shuffle_ps(all, ab_high, cd_high, _MM_SHUFFLE(1, 0, 1, 0));
+    d.r =
+        _mm512_maskz_shuffle_ps(all, ab_high, cd_high, _MM_SHUFFLE(3, 2, 3, 2));
+  }
+  static Vec gather(float const *const p, int const *const idx) {
+    return {_mm512_mask_i32gather_ps(_mm512_setzero_ps(), all,
+                                     _mm512_loadu_si512(idx), p, 4)};
+  }
+  static Vec maskMin(Mask m, Vec a, Vec b) {
+    return {_mm512_mask_min_ps(a.r, m, b.r, a.r)};
+  }
+  static Vec maskMax(Mask m, Vec a, Vec b) {
+    return {_mm512_mask_max_ps(a.r, m, b.r, a.r)};
+  }
+
+  // Through memory rather than _mm512_reduce_*, see min; they run once per
+  // kernel call.
+  static float reduceMin(Vec a) {
+    float lanes[width];
+    store(lanes, a);
+    float m = lanes[0];
+    for (int i = 1; i < width; i++) {
+      m = lanes[i] < m ? lanes[i] : m;
+    }
+    return m;
+  }
+  static float reduceMax(Vec a) {
+    float lanes[width];
+    store(lanes, a);
+    float m = lanes[0];
+    for (int i = 1; i < width; i++) {
+      m = lanes[i] > m ? lanes[i] : m;
+    }
+    return m;
+  }
+  static float reduceAdd(Vec a) {
+    float lanes[width];
+    store(lanes, a);
+    float s = lanes[0];
+    for (int i = 1; i < width; i++) {
+      s += lanes[i];
+    }
+    return s;
+  }
+};
+
+template <> struct Vec<int, 16> {
+  static constexpr int width = 16;
+  typedef __mmask16 Mask;
+  static constexpr Mask all = 0xFFFF;
+
+  __m512i r;
+
+  static Vec load(int const *const p) { return {_mm512_loadu_si512(p)}; }
+  static void store(int *const p, Vec a) { _mm512_storeu_si512(p, a.r); }
+  static Vec set1(int x) { return {_mm512_set1_epi32(x)}; }
+  static Vec zero() { return {_mm512_setzero_si512()}; }
+
+  static Vec add(Vec a, Vec b) { return {_mm512_add_epi32(a.r, b.r)}; }
+  static Vec sub(Vec a, Vec b) { return {_mm512_sub_epi32(a.r, b.r)}; }
+
+  template <int k> static Vec shiftUp(Vec a) {
+    return {_mm512_maskz_alignr_epi32(all, a.r, _mm512_setzero_si512(),
+                                      16 - k)};
+  }
+  static Vec scan(Vec a) {
+    a = add(a, shiftUp<1>(a));
+    a = add(a, shiftUp<2>(a));
+    a = add(a, shiftUp<4>(a));
+    return add(a, shiftUp<8>(a));
+  }
+  static Vec broadcastLast(Vec a) {
+    return {_mm512_maskz_permutexvar_epi32(all, _mm512_set1_epi32(15), a.r)};
+  }
+  template <int k> static Vec shiftDown(Vec a) {
+    return {_mm512_maskz_alignr_epi32(all, _mm512_setzero_si512(), a.r, k)};
+  }
+  static Vec broadcastFirst(Vec a) {
+    return {_mm512_maskz_permutexvar_epi32(all, _mm512_setzero_si512(), a.r)};
+  }
+  // maskz forms for the same reason as in Vec<float, 16>
+  static Vec min(Vec a, Vec b) {
+    return {_mm512_maskz_min_epi32(all, a.r, b.r)};
+  }
+  static Vec max(Vec a, Vec b) {
+    return {_mm512_maskz_max_epi32(all, a.r, b.r)};
+  }
+  static Vec abs(Vec a) { return {_mm512_maskz_abs_epi32(all, a.r)}; }
+  static Vec truncate(Vec<float, 16> f) {
+    return {_mm512_maskz_cvttps_epi32(all, f.r)};
+  }
+
+  static Mask lt(Vec a, Vec b) { return _mm512_cmplt_epi32_mask(a.r, b.r); }
+  static Mask gt(Vec a, Vec b) { return _mm512_cmpgt_epi32_mask(a.r, b.r); }
+  static Mask eq(Vec a, Vec b) { return _mm512_cmpeq_epi32_mask(a.r, b.r); }
+  static Vec select(Mask m, Vec a, Vec b) {
+    return {_mm512_mask_blend_epi32(m, b.r, a.r)};
+  }
+  static unsigned bits(Mask m) { return m; }
+  // Writes only the selected lanes
+  static Mask fromBits(unsigned b) { return Mask(b); }
+  static Vec partition(Vec a, Mask m) {
+    Mask high = Mask(~0u << __builtin_popcount(m));
+    __m512i selected = _mm512_maskz_compress_epi32(m, a.r);
+    __m512i others = _mm512_maskz_compress_epi32(Mask(~m), a.r);
+    return {_mm512_mask_expand_epi32(selected, high, others)};
+  }
+  static int compressStore(int *const p, Vec a, Mask m) {
+    _mm512_mask_compressstoreu_epi32(p, m, a.r);
+    return __builtin_popcount(m);
+  }
+  template <int j> static Vec swapLanes(Vec a) {
+    if constexpr (j == 8) {
+      return {_mm512_maskz_shuffle_i32x4(all, a.r, a.r,
+                                         _MM_SHUFFLE(1, 0, 3, 2))};
+    } else if constexpr (j == 4) {
+      return {_mm512_maskz_shuffle_i32x4(all, a.r, a.r,
+                                         _MM_SHUFFLE(2, 3, 0, 1))};
+    } else {
+      return {_mm512_maskz_shuffle_epi32(
+          all, a.r,
+          _MM_PERM_ENUM(j == 1 ? _MM_SHUFFLE(2, 3, 0, 1)
+                               : _MM_SHUFFLE(1, 0, 3, 2)))};
+    }
+  }
+
+  static Vec increment(Vec count, Mask m) {
+    return {_mm512_mask_sub_epi32(count.r, m, count.r, _mm512_set1_epi32(-1))};
+  }
+
+  // Through memory for the same reason as Vec<float, 16>
+  static int reduceMin(Vec a) {
+    int lanes[width];
+    store(lanes, a);
+    int m = lanes[0];
+    for (int i = 1; i < width; i++) {
+      m = lanes[i] < m ? lanes[i] : m;
+    }
+    return m;
+  }
+  static int reduceMax(Vec a) {
+    int lanes[width];
+    store(lanes, a);
+    int m = lanes[0];
+    for (int i = 1; i < width; i++) {
+      m = lanes[i] > m ? lanes[i] : m;
+    }
+    return m;
+  }
+  static int64_t reduceAdd(Vec a) {
+    int lanes[width];
+    store(lanes, a);
+    int64_t s = 0;
+    for (int i = 0; i < width; i++) {
+      s += lanes[i];
+    }
+    return s;
+  }
+
+  struct Wide {
+    __m512i lo, hi;
+  };
+  static Wide zeroWide() {
+    return {_mm512_setzero_si512(), _mm512_setzero_si512()};
+  }
+  // maskz extract for the same reason as above, also for the low half
+  static Wide addWide(Wide acc, Vec a) {
+    __m512i lo = _mm512_maskz_cvtepi32_epi64(
+        0xFF, _mm512_maskz_extracti64x4_epi64(0xF, a.r, 0));
+    __m512i hi = _mm512_maskz_cvtepi32_epi64(
+        0xFF, _mm512_maskz_extracti64x4_epi64(0xF, a.r, 1));
+    return {_mm512_add_epi64(acc.lo, lo), _mm512_add_epi64(acc.hi, hi)};
+  }
+  static int64_t reduceWide(Wide acc) {
+    int64_t lanes[8];
+    _mm512_storeu_si512(lanes, _mm512_add_epi64(acc.lo, acc.hi));
+    int64_t s = 0;
+    for (int i = 0; i < 8; i++) {
+      s += lanes[i];
+    }
+    return s;
+  }
+};
+#endif
+
+#ifdef SIMD_NEON
+// Lane i of a NEON comparison mask as bit i
+static inline unsigned neonMaskBits(uint32x4_t m) {
+  const int32_t shifts[4] = {0, 1, 2, 3};
+  return vaddvq_u32(vshlq_u32(vshrq_n_u32(m, 31), vld1q_s32(shifts)));
+}
+
+// The inverse of neonMaskBits
+static inline uint32x4_t neonMaskFromBits(unsigned b) {
+  const uint32_t lane_bits[4] = {1, 2, 4, 8};
+  return vtstq_u32(vdupq_n_u32(b), vld1q_u32(lane_bits));
+}
+
+template <> struct Vec<float, 4> {
+  static constexpr int width = 4;
+  typedef uint32x4_t Mask;
+
+  float32x4_t r;
+
+  static Vec load(float const *const p) { return {vld1q_f32(p)}; }
+  static void store(float *const p, Vec a) { vst1q_f32(p, a.r); }
+  static Vec set1(float x) { return {vdupq_n_f32(x)}; }
+  static Vec zero() { return {vdupq_n_f32(0.0f)}; }
+
+  static Vec add(Vec a, Vec b) { return {vaddq_f32(a.r, b.r)}; }
+  static Vec sub(Vec a, Vec b) { return {vsubq_f32(a.r, b.r)}; }
+
+  template <int k> static Vec shiftUp(Vec a) {
+    return {vextq_f32(vdupq_n_f32(0), a.r, 4 - k)};
+  }
+  static Vec scan(Vec a) {
+    a = add(a, shiftUp<1>(a));
+    return add(a, shiftUp<2>(a));
+  }
+  static Vec broadcastLast(Vec a) { return {vdupq_laneq_f32(a.r, 3)}; }
+  template <int k> static Vec shiftDown(Vec a) {
+    return {vextq_f32(a.r, vdupq_n_f32(0), k)};
+  }
+  static Vec broadcastFirst(Vec a) { return {vdupq_laneq_f32(a.r, 0)}; }
+  static Vec mul(Vec a, Vec b) { return {vmulq_f32(a.r, b.r)}; }
+  static Vec fmadd(Vec a, Vec b, Vec c) { return {vfmaq_f32(c.r, a.r, b.r)}; }
+  static Vec min(Vec a, Vec b) { return {vminnmq_f32(a.r, b.r)}; }
+  static Vec max(Vec a, Vec b) { return {vmaxnmq_f32(a.r, b.r)}; }
+
+  static Mask lt(Vec a, Vec b) { return vcltq_f32(a.r, b.r); }
+  static Mask gt(Vec a, Vec b) { return vcgtq_f32(a.r, b.r); }
+  static Mask eq(Vec a, Vec b) { return vceqq_f32(a.r, b.r); }
+  static Mask isnan(Vec a) { return vmvnq_u32(vceqq_f32(a.r, a.r)); }
+  static Mask signbit(Vec a) {
+    return vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_f32(a.r), 31));
+  }
+  static Vec select(Mask m, Vec a, Vec b) { return {vbslq_f32(m, a.r, b.r)}; }
+  static unsigned bits(Mask m) { return neonMaskBits(m); }
+  static Mask fromBits(unsigned b) { return neonMaskFromBits(b); }
+  static Vec partition(Vec a, Mask m) {
+    uint8x16_t shuffle = vld1q_u8(compressTable().shuffle4[bits(m)]);
+    return {vreinterpretq_f32_u8(
+        vqtbl1q_u8(vreinterpretq_u8_f32(a.r), shuffle))};
+  }
+  static int compressStore(float *const p, Vec a, Mask m) {
+    store(p, partition(a, m));
+    return __builtin_popcount(bits(m));
+  }
+  template <int j> static Vec swapLanes(Vec a) {
+    if constexpr (j == 1) {
+      return {vrev64q_f32(a.r)};
+    } else {
+      return {vextq_f32(a.r, a.r, 2)};
+    }
+  }
+  static Vec loadBlocks(float const *const p, size_t) { return load(p); }
+  static void storeBlocks(float *const p, size_t, Vec a) { store(p, a); }
+  static void transpose4(Vec &a, Vec &b, Vec &c, Vec &d) {
+    float32x4x2_t ab = vtrnq_f32(a.r, b.r);
+    float32x4x2_t cd = vtrnq_f32(c.r, d.r);
+    a.r = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+    b.r = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+    c.r = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+    d.r = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+  }
+  static Vec gather(float const *const p, int const *const idx) {
+    float32x4_t r = vdupq_n_f32(p[idx[0]]);
+    r = vsetq_lane_f32(p[idx[1]], r, 1);
+    r = vsetq_lane_f32(p[idx[2]], r, 2);
+    return {vsetq_lane_f32(p[idx[3]], r, 3)};
+  }
+  static Vec maskMin(Mask m, Vec a, Vec b) {
+    return {vbslq_f32(m, vminnmq_f32(a.r, b.r), a.r)};
+  }
+  static Vec maskMax(Mask m, Vec a, Vec b) {
+    return {vbslq_f32(m, vmaxnmq_f32(a.r, b.r), a.r)};
+  }
+
+  static float reduceMin(Vec a) { return vminnmvq_f32(a.r); }
+  static float reduceMax(Vec a) { return vmaxnmvq_f32(a.r); }
+  static float reduceAdd(Vec a) { return vaddvq_f32(a.r); }
+};
+
+template <> struct Vec<int, 4> {
+  static constexpr int width = 4;
+  typedef uint32x4_t Mask;
+
+  int32x4_t r;
+
+  static Vec load(int const *const p) { return {vld1q_s32(p)}; }
+  static void store(int *const p, Vec a) { vst1q_s32(p, a.r); }
+  static Vec set1(int x) { return {vdupq_n_s32(x)}; }
+  static Vec zero() { return {vdupq_n_s32(0)}; }
+
+  static Vec add(Vec a, Vec b) { return {vaddq_s32(a.r, b.r)}; }
+  static Vec sub(Vec a, Vec b) { return {vsubq_s32(a.r, b.r)}; }
+
+  template <int k> static Vec shiftUp(Vec a) {
+    return {vextq_s32(vdupq_n_s32(0), a.r, 4 - k)};
+  }
+  static Vec scan(Vec a) {
+    a = add(a, shiftUp<1>(a));
+    return add(a, shiftUp<2>(a));
+  }
+  static Vec broadcastLast(Vec a) { return {vdupq_laneq_s32(a.r, 3)}; }
+  template <int k> static Vec shiftDown(Vec a) {
+    return {vextq_s32(a.r, vdupq_n_s32(0), k)};
+  }
+  static Vec broadcastFirst(Vec a) { return {vdupq_laneq_s32(a.r, 0)}; }
+  static Vec min(Vec a, Vec b) { return {vminq_s32(a.r, b.r)}; }
+  static Vec max(Vec a, Vec b) { return {vmaxq_s32(a.r, b.r)}; }
+  static Vec abs(Vec a) { return {vabsq_s32(a.r)}; }
+  static Vec truncate(Vec<float, 4> f) { return {vcvtq_s32_f32(f.r)}; }
+
+  static Mask lt(Vec a, Vec b) { return vcltq_s32(a.r, b.r); }
+  static Mask gt(Vec a, Vec b) { return vcgtq_s32(a.r, b.r); }
+  static Mask eq(Vec a, Vec b) { return vceqq_s32(a.r, b.r); }
+  static Vec select(Mask m, Vec a, Vec b) { return {vbslq_s32(m, a.r, b.r)}; }
+  static unsigned bits(Mask m) { return neonMaskBits(m); }
+  static Mask fromBits(unsigned b) { return neonMaskFromBits(b); }
+  static Vec partition(Vec a, Mask m) {
+    uint8x16_t shuffle = vld1q_u8(compressTable().shuffle4[bits(m)]);
+    return {vreinterpretq_s32_u8(
+        vqtbl1q_u8(vreinterpretq_u8_s32(a.r), shuffle))};
+  }
+  static int compressStore(int *const p, Vec a, Mask m) {
+    store(p, partition(a, m));
+    return __builtin_popcount(bits(m));
+  }
+  template <int j> static Vec swapLanes(Vec a) {
+    if constexpr (j == 1) {
+      return {vrev64q_s32(a.r)};
+    } else {
+      return {vextq_s32(a.r, a.r, 2)};
+    }
+  }
+
+  static Vec increment(Vec count, Mask m) {
+    return {vsubq_s32(count.r, vreinterpretq_s32_u32(m))};
+  }
+
+  static int reduceMin(Vec a) { return vminvq_s32(a.r); }
+  static int reduceMax(Vec a) { return vmaxvq_s32(a.r); }
+  static int64_t reduceAdd(Vec a) { return vaddlvq_s32(a.r); }
+
+  struct Wide {
+    int64x2_t lo, hi;
+  };
+  static Wide zeroWide() { return {vdupq_n_s64(0), vdupq_n_s64(0)}; }
+  static Wide addWide(Wide acc, Vec a) {
+    return {vaddw_s32(acc.lo, vget_low_s32(a.r)), vaddw_high_s32(acc.hi, a.r)};
+  }
+  static int64_t reduceWide(Wide acc) {
+    return vaddvq_s64(vaddq_s64(acc.lo, acc.hi));
+  }
+};
+#endif
+
+#endif // include_vec_h
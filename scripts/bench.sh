@@ -30,10 +30,17 @@ done
 
 # writing to CSV
 
-echo "size, golden, omp, sse, sseomp, avx, avxomp" > stat/$host/$bench-stats.csv
+echo "size, golden, omp, sse, sseomp, avx, avxomp, avx512, avx512omp" > stat/$host/$bench-stats.csv
 
+# A row is printed once all lines for a size have been read, so that a column
+# is left empty rather than the row dropped when the CPU lacks an ISA.
 cat stat/$host/$bench-output.txt | awk '                          \
+  function row() {                            \
+    printf("%s, %s, %s, %s, %s, %s, %s, %s, %s\n", size, golden, omp, sse, sseomp, avx, avxomp, avx512, avx512omp); \
+    golden = omp = sse = sseomp = avx = avxomp = avx512 = avx512omp = ""; \
+  }                                           \
   /build\/src/ {                              \
+    if (size != "") row();                    \
     size = $NF;                               \
   }                                           \
   /Elapsed time golden :/ {                     \
@@ -53,7 +60,15 @@ cat stat/$host/$bench-output.txt | awk '                          \
   }                                           \
   /Elapsed time SIMD AVX\+openmp :/ {                   \
     avxomp = $(NF-1);                            \
-    printf("%s, %s, %s, %s, %s, %s, %s\n", size, golden, omp, sse, sseomp, avx, avxomp); \
+  }                                           \
+  /Elapsed time SIMD AVX512 :/ {                   \
+    avx512 = $(NF-1);                            \
+  }                                           \
+  /Elapsed time SIMD AVX512\+openmp :/ {                   \
+    avx512omp = $(NF-1);                            \
+  }                                           \
+  END {                                       \
+    if (size != "") row();                    \
   }                                           \
 ' >> stat/$host/$bench-stats.csv
 
@@ -77,5 +92,7 @@ echo "                                            \
        \"stat/$host/$bench-stats.csv\" using 1:4 with linespoint,   \
        \"stat/$host/$bench-stats.csv\" using 1:5 with linespoint,   \
        \"stat/$host/$bench-stats.csv\" using 1:6 with linespoint,   \
-       \"stat/$host/$bench-stats.csv\" using 1:7 with linespoint;   \
+       \"stat/$host/$bench-stats.csv\" using 1:7 with linespoint,   \
+       \"stat/$host/$bench-stats.csv\" using 1:8 with linespoint,   \
+       \"stat/$host/$bench-stats.csv\" using 1:9 with linespoint;   \
 " | gnuplot > stat/$host/$bench-performance.png
\ No newline at end of file
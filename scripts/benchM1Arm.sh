@@ -30,7 +30,7 @@ done
 
 # writing to CSV
 
-echo "size, golden, omp, sse, sseomp" > stat/$host/$bench-stats.csv
+echo "size, golden, omp, sse, sseomp, neon, neonomp" > stat/$host/$bench-stats.csv
 
 cat stat/$host/$bench-output.txt | awk '                          \
   /build\/src/ {                              \
@@ -47,7 +47,13 @@ cat stat/$host/$bench-output.txt | awk '                          \
   }                                           \
   /Elapsed time SIMD SSE\+openmp :/ {                   \
     sseomp = $(NF-1);                            \
-    printf("%s, %s, %s, %s, %s\n", size, golden, omp, sse, sseomp); \
+  }                                           \
+  /Elapsed time SIMD NEON :/ {                   \
+    neon = $(NF-1);                            \
+  }                                           \
+  /Elapsed time SIMD NEON\+openmp :/ {                   \
+    neonomp = $(NF-1);                            \
+    printf("%s, %s, %s, %s, %s, %s, %s\n", size, golden, omp, sse, sseomp, neon, neonomp); \
   }                                           \
 ' >> stat/$host/$bench-stats.csv
 
@@ -69,5 +75,7 @@ echo "                                            \
   plot \"stat/$host/$bench-stats.csv\" using 1:2 with linespoint, \
        \"stat/$host/$bench-stats.csv\" using 1:3 with linespoint,  \
        \"stat/$host/$bench-stats.csv\" using 1:4 with linespoint,   \
-       \"stat/$host/$bench-stats.csv\" using 1:5 with linespoint;   \
+       \"stat/$host/$bench-stats.csv\" using 1:5 with linespoint,   \
+       \"stat/$host/$bench-stats.csv\" using 1:6 with linespoint,   \
+       \"stat/$host/$bench-stats.csv\" using 1:7 with linespoint;   \
 " | gnuplot > stat/$host/$bench-performance.png
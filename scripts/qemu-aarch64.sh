@@ -0,0 +1,38 @@
+#!/usr/bin/env bash
+
+# Cross-compiles a benchmark for AArch64 and runs it under qemu-user: with the
+# SSE kernels through sse2neon.h, with the native NEON kernels, and with the
+# native NEON and SVE kernels for each SVE vector length below, so that the
+# opt-in NEON and vector-length-agnostic SVE kernels can be checked on an x86
+# Linux host.
+# Needs an aarch64-linux-gnu g++ cross compiler and qemu-aarch64.
+
+if [[ $# -lt 2 ]]
+then
+  echo "Usage: $0 benchmark_to_run size-exponent"
+  exit 1
+fi
+
+set -e
+set -x
+
+# SVE vector lengths in bits
+SVE_VECTOR_LENGTHS=(128 256 512 2048)
+
+bench=$1
+sz=$2
+
+CROSS=${CROSS:-aarch64-linux-gnu-}
+SYSROOT=${SYSROOT:-/usr/aarch64-linux-gnu}
+
+make CROSS=$CROSS CROSS_ARCHFLAGS="-march=armv8-a+simd" src/$bench
+qemu-aarch64 -L $SYSROOT -cpu max,sve=off ./build/src/$bench $sz
+
+make CROSS=$CROSS CROSS_ARCHFLAGS="-march=armv8-a+simd" EXTRA=-DSIMD_NATIVE_NEON src/$bench
+qemu-aarch64 -L $SYSROOT -cpu max,sve=off ./build/src/$bench $sz
+
+make CROSS=$CROSS CROSS_ARCHFLAGS="-march=armv8.2-a+sve" EXTRA="-DSIMD_NATIVE_NEON -DSIMD_NATIVE_SVE" src/$bench
+for vl in "${SVE_VECTOR_LENGTHS[@]}"
+do
+  qemu-aarch64 -L $SYSROOT -cpu max,sve${vl}=on ./build/src/$bench $sz
+done
@@ -0,0 +1,30 @@
+#!/usr/bin/env bash
+
+# Builds benchmarks with AddressSanitizer and UndefinedBehaviorSanitizer and
+# runs each at small sizes, where the edge cases read and write the ends of
+# the arrays. The executables replace those of `make all`. With no argument,
+# runs every benchmark of the Makefile.
+
+set -e
+set -x
+
+# Small array sizes, below and around the vector widths and block sizes
+SIZE_EXPONENTS=(0 1 3 6 10 13)
+
+SANITIZE="-fsanitize=address,undefined -fno-sanitize-recover=all -g -fno-omit-frame-pointer"
+
+if [[ $# -gt 0 ]]
+then
+  benches=("$@")
+else
+  benches=($(sed -n 's/^all: //p' Makefile | sed 's/src\///g'))
+fi
+
+for bench in "${benches[@]}"
+do
+  make -B DEBUGOPTIONS="$SANITIZE" src/$bench
+  for sz in "${SIZE_EXPONENTS[@]}"
+  do
+    ./build/src/$bench $sz > /dev/null
+  done
+done
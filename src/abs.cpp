@@ -1,4 +1,5 @@
 #include "helpers.hpp"
+#include "reader.h"
 #include "simd.h"
 #include <chrono>
 #include <climits>
@@ -13,14 +14,50 @@ void absGolden(std::vector<int> &arr, std::vector<int> &expected) {
   }
 }
 
+/*
+abs of the ints of the file at path with absSSE, run on a mapping of the
+file instead of a copy, as the mapped min-max in min-max.cpp. Returns errno
+if the file cannot be mapped, else 0.
+*/
+int absMapped(const char *path, bool populate, std::vector<int> &abs_arr) {
+  MappedFile file(path, populate);
+  if (file.error()) {
+    return file.error();
+  }
+  file.willNeedPerThread();
+  abs_arr.resize(file.size() / sizeof(int));
+  absSSE(reinterpret_cast<const int *>(file.data()), abs_arr.size(),
+         abs_arr.data());
+  return 0;
+}
+
 int main(int argc, char **argv) {
-  if (argc < 2) {
+  if (argc < 2 || (std::string(argv[1]) == "--mmap" && argc < 3)) {
     std::cerr << "Usage: " << argv[0] << " size-exponent" << std::endl;
-    std::cerr << "Size of the array generated will be 2^(size-exponent)"
+    std::cerr << "       " << argv[0] << " --mmap input [--populate]"
+              << std::endl;
+    std::cerr << "Size of the array generated will be 2^(size-exponent); "
+                 "with --mmap the abs of the ints of input is computed on a "
+                 "mapping of the file"
               << std::endl;
     return 1;
   }
 
+  if (std::string(argv[1]) == "--mmap") {
+    bool populate = argc > 3 && std::string(argv[3]) == "--populate";
+    std::vector<int> abs_arr;
+    t.start_timer();
+    int error = absMapped(argv[2], populate, abs_arr);
+    t.stop_timer();
+    if (error) {
+      std::cerr << argv[2] << ": " << std::strerror(error) << std::endl;
+      return 1;
+    }
+    std::cout << "Elapsed time SSE mmap" << (populate ? " populate " : " ")
+              << t.time_elapsed() << std::endl;
+    return 0;
+  }
+
   // generate random data vector of size N
   int exponent = std::atoi(argv[1]);
   size_t N = std::pow(2, exponent);
@@ -43,9 +80,83 @@ int main(int argc, char **argv) {
     t.stop_timer();
     std::cout << "Elapsed time SSE " << t.time_elapsed() << std::endl;
 
-    for (size_t i = 0; i < N; i++) {
-      assertInt(expected[i], sse_actual[i], "SSE");
-    }
+    assertArray(expected.data(), sse_actual.data(), N, "SSE");
     std::cout << "Assertion is successful" << std::endl;
   }
-}
\ No newline at end of file
+
+#ifdef __AVX2__
+  // AVX2 Approach
+  {
+    std::vector<int> avx2_actual(N);
+    t.start_timer();
+    absAVX2(inputData.data(), N, avx2_actual.data());
+    t.stop_timer();
+    std::cout << "Elapsed time AVX2 " << t.time_elapsed() << std::endl;
+
+    assertArray(expected.data(), avx2_actual.data(), N, "AVX2");
+    std::cout << "Assertion is successful for AVX2" << std::endl;
+  }
+#endif
+
+#ifdef __AVX512F__
+  // AVX512 Approach
+  {
+    std::vector<int> avx512_actual(N);
+    t.start_timer();
+    absAVX512(inputData.data(), N, avx512_actual.data());
+    t.stop_timer();
+    std::cout << "Elapsed time AVX512 " << t.time_elapsed() << std::endl;
+
+    assertArray(expected.data(), avx512_actual.data(), N, "AVX512");
+    std::cout << "Assertion is successful for AVX512" << std::endl;
+  }
+#endif
+
+#ifdef SIMD_NEON
+  // NEON Approach
+  {
+    std::vector<int> neon_actual(N);
+    t.start_timer();
+    absNEON(inputData.data(), N, neon_actual.data());
+    t.stop_timer();
+    std::cout << "Elapsed time NEON " << t.time_elapsed() << std::endl;
+
+    assertArray(expected.data(), neon_actual.data(), N, "NEON");
+    std::cout << "Assertion is successful for NEON" << std::endl;
+  }
+#endif
+
+#ifdef SIMD_SVE
+  // SVE Approach
+  {
+    std::vector<int> sve_actual(N);
+    t.start_timer();
+    absSVE(inputData.data(), N, sve_actual.data());
+    t.stop_timer();
+    std::cout << "Elapsed time SVE " << t.time_elapsed() << std::endl;
+
+    assertArray(expected.data(), sve_actual.data(), N, "SVE");
+    std::cout << "Assertion is successful for SVE" << std::endl;
+  }
+#endif
+
+  // mmap Approach: the input is written to a file and mapped
+  {
+    std::string path = writeTempFile(inputData.data(), N);
+    for (bool populate : {false, true}) {
+      std::string name = populate ? "SSE mmap populate" : "SSE mmap";
+      std::vector<int> mmap_actual;
+      t.start_timer();
+      int error = absMapped(path.c_str(), populate, mmap_actual);
+      t.stop_timer();
+      std::cout << "Elapsed time " << name << " " << t.time_elapsed()
+                << std::endl;
+
+      assertInt(size_t(0), size_t(error), "mmap error");
+      assertInt(N, mmap_actual.size(), name + " size");
+      assertArray(expected.data(), mmap_actual.data(), N, name);
+    }
+    unlink(path.c_str());
+    std::cout << "Assertion is successful for mmap" << std::endl;
+  }
+}
@@ -0,0 +1,228 @@
+#include "helpers.hpp"
+#include "simd.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+Timer<std::chrono::microseconds> t;
+
+/*
+"Golden" algorithm for the min-max of the fields of records of F floats:
+each field is copied out to a contiguous array, as the callers did before,
+and reduced with minMaxAuto.
+*/
+template <int F, NaNPolicy policy>
+void minMaxAoSGolden(float const *records, size_t n_records, float *min,
+                     float *max, size_t *nans) {
+  std::vector<float> field(n_records);
+  for (int f = 0; f < F; f++) {
+    for (size_t i = 0; i < n_records; i++) {
+      field[i] = records[i * F + f];
+    }
+    minMaxAuto<policy>(field.data(), n_records, &min[f], &max[f], &nans[f]);
+  }
+}
+
+template <int F>
+using MinMaxAoSKernel = void (*)(float const *, size_t, float *, float *,
+                                 size_t *);
+
+// Runs "kernel" and checks the result of every field against the golden one
+template <int F, NaNPolicy policy>
+void checkMinMaxAoS(const std::vector<float> &records,
+                    MinMaxAoSKernel<F> kernel, std::string name,
+                    bool print_time) {
+  size_t n_records = records.size() / F;
+  float minExpected[F], maxExpected[F], minActual[F], maxActual[F];
+  size_t nansExpected[F], nansActual[F];
+  minMaxAoSGolden<F, policy>(records.data(), n_records, minExpected,
+                             maxExpected, nansExpected);
+
+  t.start_timer();
+  kernel(records.data(), n_records, minActual, maxActual, nansActual);
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  // Ignore leaves the sign of a zero result unspecified
+  FloatCheck check = policy == NaNPolicy::Ignore ? FloatCheck::ulps(0)
+                                                 : FloatCheck::exact();
+  for (int f = 0; f < F; f++) {
+    std::string field_name = name + " field " + std::to_string(f);
+    assertFloat(minExpected[f], minActual[f], "min " + field_name, check);
+    assertFloat(maxExpected[f], maxActual[f], "max " + field_name, check);
+    assertInt(nansExpected[f], nansActual[f], "nans " + field_name);
+  }
+}
+
+// Checks every AoS min-max kernel for records of F floats
+template <int F, NaNPolicy policy>
+void checkMinMaxAoSAll(const std::vector<float> &records, std::string type,
+                       bool print_time) {
+  if (print_time) {
+    float min[F], max[F];
+    size_t nans[F];
+    t.start_timer();
+    minMaxAoSGolden<F, policy>(records.data(), records.size() / F, min, max,
+                               nans);
+    t.stop_timer();
+    std::cout << "Elapsed time golden " << type << " : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  checkMinMaxAoS<F, policy>(records, minMaxAoSSSE<F, policy>,
+                            "SIMD SSE " + type, print_time);
+#ifdef __AVX2__
+  checkMinMaxAoS<F, policy>(records, minMaxAoSAVX<F, policy>,
+                            "SIMD AVX " + type, print_time);
+#endif
+#ifdef __AVX512F__
+  checkMinMaxAoS<F, policy>(records, minMaxAoSAVX512<F, policy>,
+                            "SIMD AVX512 " + type, print_time);
+#endif
+#ifdef SIMD_NEON
+  checkMinMaxAoS<F, policy>(records, minMaxAoSNEON<F, policy>,
+                            "SIMD NEON " + type, print_time);
+#endif
+}
+
+typedef void (*AoSToSoAKernel)(float const *, size_t, float *const *);
+typedef void (*SoAToAoSKernel)(float const *const *, size_t, float *);
+
+// The transposes move floats, so they must match bit for bit
+void assertArray(const float *expected, const float *actual, size_t N,
+                 std::string str) {
+  assertArray(expected, actual, N, FloatCheck::exact(), str);
+}
+
+/*
+Transposes records of four floats to four arrays with "to_soa", back with
+"to_aos", and checks both against scalar copies.
+*/
+void checkTranspose(const std::vector<float> &records, AoSToSoAKernel to_soa,
+                    SoAToAoSKernel to_aos, std::string name, bool print_time) {
+  size_t n = records.size() / 4;
+  std::vector<float> expected[4], actual[4];
+  for (int f = 0; f < 4; f++) {
+    expected[f].resize(n);
+    actual[f].resize(n);
+    for (size_t i = 0; i < n; i++) {
+      expected[f][i] = records[4 * i + f];
+    }
+  }
+  float *soa[4] = {actual[0].data(), actual[1].data(), actual[2].data(),
+                   actual[3].data()};
+
+  t.start_timer();
+  to_soa(records.data(), n, soa);
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " AoS to SoA : "
+              << t.time_elapsed() << std::endl;
+  }
+  for (int f = 0; f < 4; f++) {
+    assertArray(expected[f].data(), actual[f].data(), n,
+                name + " AoS to SoA field " + std::to_string(f));
+  }
+
+  std::vector<float> aos(4 * n);
+  t.start_timer();
+  to_aos(soa, n, aos.data());
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " SoA to AoS : "
+              << t.time_elapsed() << std::endl;
+  }
+  assertArray(records.data(), aos.data(), 4 * n, name + " SoA to AoS");
+}
+
+void checkTransposeAll(const std::vector<float> &records, bool print_time) {
+  if (print_time) {
+    size_t n = records.size() / 4;
+    std::vector<float> soa(records.size());
+    t.start_timer();
+    for (size_t i = 0; i < n; i++) {
+      for (int f = 0; f < 4; f++) {
+        soa[f * n + i] = records[4 * i + f];
+      }
+    }
+    t.stop_timer();
+    std::cout << "Elapsed time golden AoS to SoA : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  checkTranspose(records, aosToSoaSSE, soaToAosSSE, "SIMD SSE", print_time);
+#ifdef __AVX2__
+  checkTranspose(records, aosToSoaAVX2, soaToAosAVX2, "SIMD AVX",
+                 print_time);
+#endif
+#ifdef __AVX512F__
+  checkTranspose(records, aosToSoaAVX512, soaToAosAVX512, "SIMD AVX512",
+                 print_time);
+#endif
+#ifdef SIMD_NEON
+  checkTranspose(records, aosToSoaNEON, soaToAosNEON, "SIMD NEON",
+                 print_time);
+#endif
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    std::cerr << "Usage: ./aos size-exponent" << std::endl;
+    std::cerr << "Number of records generated will be 2^(size-exponent)"
+              << std::endl;
+    return 1;
+  }
+
+  int exponent = std::atoi(argv[1]);
+  const size_t N = std::pow(2, exponent);
+
+  // Records {x, y, z, w}, each field over its own range, with NaNs
+  std::vector<float> records =
+      generateRandomData<float>(4 * N, -10000.0, 10000.0, 10);
+  for (size_t i = 0; i < 4 * N; i++) {
+    records[i] = records[i] * (i % 4 + 1) + 100000.0f * (i % 4);
+  }
+  for (size_t i = 0; i < 4 * N; i += 1021) {
+    records[i] = NAN;
+  }
+
+  checkMinMaxAoSAll<4, NaNPolicy::Ignore>(records, "xyzw", true);
+  checkMinMaxAoSAll<3, NaNPolicy::Ignore>(
+      std::vector<float>(records.begin(), records.begin() + 3 * N), "xyz",
+      true);
+  checkMinMaxAoSAll<4, NaNPolicy::Propagate>(records, "xyzw propagate",
+                                             false);
+  checkMinMaxAoSAll<5, NaNPolicy::MinNum>(
+      std::vector<float>(records.begin(), records.begin() + 5 * (N / 2)),
+      "5 fields minnum", false);
+  std::cout << "Assertion is successful for AoS min-max" << std::endl;
+
+  checkTransposeAll(records, true);
+  std::cout << "Assertion is successful for AoS to SoA transposes"
+            << std::endl;
+
+  // Fewer records than one group, signed zeros in one field, and a field
+  // of NaNs
+  {
+    std::vector<float> smallRecords =
+        generateRandomData<float>(4 * 37, -10000.0, 10000.0, 11);
+    for (size_t n = 0; n <= 37; n++) {
+      std::vector<float> small(smallRecords.begin(),
+                               smallRecords.begin() + 4 * n);
+      for (size_t i = 0; i < n; i++) {
+        small[4 * i + 1] = i % 3 ? 0.0f : -0.0f;
+        small[4 * i + 2] = NAN;
+      }
+      checkMinMaxAoSAll<4, NaNPolicy::MinNum>(small, "xyzw minnum", false);
+      checkMinMaxAoSAll<4, NaNPolicy::Propagate>(small, "xyzw propagate",
+                                                 false);
+      checkMinMaxAoSAll<2, NaNPolicy::Ignore>(small, "xy", false);
+      checkTransposeAll(small, false);
+    }
+    std::cout << "Assertion is successful for the edge cases" << std::endl;
+  }
+}
@@ -0,0 +1,131 @@
+#include "helpers.hpp"
+#include "simd.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+/*
+"Golden" algorithm to clamp "arr" to [lo, hi] into "out".
+Returns the number of elements that were clipped.
+*/
+template <typename T>
+size_t clampGolden(const std::vector<T> &arr, T lo, T hi,
+                   std::vector<T> &out) {
+  size_t clipped = 0;
+  for (size_t i = 0; i < arr.size(); i++) {
+    out[i] = std::clamp(arr[i], lo, hi);
+    if (arr[i] < lo || arr[i] > hi) {
+      clipped++;
+    }
+  }
+  return clipped;
+}
+
+template <typename T>
+using ClampKernel = void (*)(T const *, size_t, T, T, T *, size_t *);
+template <typename T>
+using ClampInPlaceKernel = void (*)(T *, size_t, T, T, size_t *);
+
+// Clamped floats, NaNs included, must match bit for bit
+void assertArray(const float *expected, const float *actual, size_t N,
+                 std::string str) {
+  assertArray(expected, actual, N, FloatCheck::exact(), str);
+}
+
+Timer<std::chrono::microseconds> t;
+
+/*
+Runs one clamp kernel out of place with a clipped count, then in place
+without one, and checks both against the golden results.
+*/
+template <typename T>
+void checkClamp(const std::vector<T> &arr, T lo, T hi, ClampKernel<T> kernel,
+                ClampInPlaceKernel<T> kernel_inplace, std::string name) {
+  std::vector<T> expected(arr.size());
+  size_t clippedExpected = clampGolden(arr, lo, hi, expected);
+
+  std::vector<T> actual(arr.size());
+  size_t clippedActual;
+  t.start_timer();
+  kernel(arr.data(), arr.size(), lo, hi, actual.data(), &clippedActual);
+  t.stop_timer();
+  std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+            << std::endl;
+
+  assertArray(expected.data(), actual.data(), arr.size(), name);
+  assertInt(clippedExpected, clippedActual, "clipped " + name);
+
+  std::vector<T> inplace = arr;
+  t.start_timer();
+  kernel_inplace(inplace.data(), inplace.size(), lo, hi, nullptr);
+  t.stop_timer();
+  std::cout << "Elapsed time " << name << " in place : " << t.time_elapsed()
+            << std::endl;
+
+  assertArray(expected.data(), inplace.data(), arr.size(), name + " in place");
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    std::cerr << "Usage: ./clamp size-exponent" << std::endl;
+    std::cerr << "Size of the array generated will be 2^(size-exponent)"
+              << std::endl;
+    return 1;
+  }
+
+  int exponent = std::atoi(argv[1]);
+  const size_t N = std::pow(2, exponent);
+
+  // About a fifth of the elements are clipped at each end
+  std::vector<float> arr = generateRandomData<float>(N, -10000.0, 10000.0, 10);
+  for (size_t i = 0; i < N; i += 1021) {
+    arr[i] = NAN;
+  }
+  const float lo = -6000.0f, hi = 6000.0f;
+
+  {
+    std::vector<float> expected(N);
+    t.start_timer();
+    clampGolden(arr, lo, hi, expected);
+    t.stop_timer();
+    std::cout << "Elapsed time golden : " << t.time_elapsed() << std::endl;
+  }
+
+  checkClamp(arr, lo, hi, clampSSE, clampSSE, "SIMD SSE");
+#ifdef __AVX2__
+  checkClamp(arr, lo, hi, clampAVX2, clampAVX2, "SIMD AVX");
+#endif
+#ifdef __AVX512F__
+  checkClamp(arr, lo, hi, clampAVX512, clampAVX512, "SIMD AVX512");
+#endif
+#ifdef SIMD_NEON
+  checkClamp(arr, lo, hi, clampNEON, clampNEON, "SIMD NEON");
+#endif
+  std::cout << "Assertion is successful for float clamp" << std::endl;
+
+  std::vector<int> arrInt = generateRandomData<int>(N, -10000, 10000, 2);
+  const int loInt = -6000, hiInt = 6000;
+
+  {
+    std::vector<int> expected(N);
+    t.start_timer();
+    clampGolden(arrInt, loInt, hiInt, expected);
+    t.stop_timer();
+    std::cout << "Elapsed time golden int : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  checkClamp(arrInt, loInt, hiInt, clampSSE, clampSSE, "SIMD SSE int");
+#ifdef __AVX2__
+  checkClamp(arrInt, loInt, hiInt, clampAVX2, clampAVX2, "SIMD AVX int");
+#endif
+#ifdef __AVX512F__
+  checkClamp(arrInt, loInt, hiInt, clampAVX512, clampAVX512, "SIMD AVX512 int");
+#endif
+#ifdef SIMD_NEON
+  checkClamp(arrInt, loInt, hiInt, clampNEON, clampNEON, "SIMD NEON int");
+#endif
+  std::cout << "Assertion is successful for int clamp" << std::endl;
+}
@@ -0,0 +1,287 @@
+#include "columnar.h"
+#include "helpers.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#ifdef HAVE_ARROW
+#include <arrow/api.h>
+#include <arrow/c/bridge.h>
+#include <arrow/compute/api.h>
+#endif
+
+Timer<std::chrono::microseconds> t;
+
+/*
+The buffers of an Arrow primitive array, allocated as Arrow allocates them:
+64-byte aligned and padded to a multiple of 64 bytes. "array" exports them
+through the C data interface; releasing it only marks it released, as the
+buffers belong to this struct.
+*/
+template <typename T> struct ArrowBuffers {
+  T *values;
+  uint8_t *validity;
+  const void *buffers[2];
+  ArrowSchema schema;
+  ArrowArray array;
+
+  static size_t padded(size_t bytes) {
+    return std::max(size_t(64), (bytes + 63) / 64 * 64);
+  }
+
+  ArrowBuffers(const std::vector<T> &data, const std::vector<bool> &valid,
+               size_t offset, size_t length) {
+    values = static_cast<T *>(
+        std::aligned_alloc(64, padded(data.size() * sizeof(T))));
+    validity = static_cast<uint8_t *>(
+        std::aligned_alloc(64, padded((data.size() + 7) / 8)));
+    std::memset(validity, 0, padded((data.size() + 7) / 8));
+    std::copy(data.begin(), data.end(), values);
+    int64_t null_count = 0;
+    for (size_t i = 0; i < data.size(); i++) {
+      validity[i / 8] |= valid[i] << (i % 8);
+      null_count += i >= offset && i < offset + length && !valid[i];
+    }
+    buffers[0] = validity;
+    buffers[1] = values;
+
+    schema = {ArrowFormat<T>::value, "", nullptr, ARROW_FLAG_NULLABLE, 0,
+              nullptr, nullptr, release, nullptr};
+    array = {int64_t(length), null_count, int64_t(offset), 2, 0, buffers,
+             nullptr, nullptr, release, nullptr};
+  }
+  ~ArrowBuffers() {
+    std::free(values);
+    std::free(validity);
+  }
+
+  static void release(ArrowSchema *schema) { schema->release = nullptr; }
+  static void release(ArrowArray *array) { array->release = nullptr; }
+};
+
+/*
+"Golden" algorithm: the valid elements of the column are copied to a
+std::vector, as the drivers hold their data, and reduced by the scalar loop
+of minMaxRemainder.
+*/
+template <NaNPolicy policy>
+void minMaxColumnGolden(const std::vector<float> &data,
+                        const std::vector<bool> &valid, size_t offset,
+                        size_t length, float *min, float *max, size_t *nans) {
+  std::vector<float> copy;
+  for (size_t i = offset; i < offset + length; i++) {
+    if (valid[i]) {
+      copy.push_back(data[i]);
+    }
+  }
+  *min = INFINITY;
+  *max = -INFINITY;
+  *nans = 0;
+  minMaxRemainder<policy>(copy.data(), 0, copy.size(), *min, *max, *nans);
+  minMaxZeroSign<policy>(copy.data(), copy.size(), *min, *max);
+  minMaxFinish<policy>(copy.size(), *nans, min, max, nullptr);
+}
+
+// Views the exported array and checks minMaxColumn against the golden one
+template <NaNPolicy policy>
+void checkColumn(const std::vector<float> &data, const std::vector<bool> &valid,
+                 size_t offset, size_t length, std::string name) {
+  ArrowBuffers<float> buffers(data, valid, offset, length);
+  ColumnView<float> view;
+  bool ok = columnView(buffers.schema, buffers.array, &view);
+  assertInt(size_t(1), size_t(ok), "view " + name);
+
+  float minExpected, maxExpected, minActual, maxActual;
+  size_t nansExpected, nansActual;
+  minMaxColumnGolden<policy>(data, valid, offset, length, &minExpected,
+                             &maxExpected, &nansExpected);
+  minMaxColumn<policy>(view, &minActual, &maxActual, &nansActual);
+
+  FloatCheck check = policy == NaNPolicy::Ignore ? FloatCheck::ulps(0)
+                                                 : FloatCheck::exact();
+  assertFloat(minExpected, minActual, "min " + name, check);
+  assertFloat(maxExpected, maxActual, "max " + name, check);
+  assertInt(nansExpected, nansActual, "nans " + name);
+}
+
+#ifdef HAVE_ARROW
+// The same buffers as an arrow::FloatArray, wrapped without copying
+std::shared_ptr<arrow::FloatArray>
+wrapArrow(const ArrowBuffers<float> &buffers) {
+  size_t size = buffers.array.offset + buffers.array.length;
+  auto values = std::make_shared<arrow::Buffer>(
+      reinterpret_cast<const uint8_t *>(buffers.values), size * sizeof(float));
+  auto validity =
+      std::make_shared<arrow::Buffer>(buffers.validity, (size + 7) / 8);
+  return std::make_shared<arrow::FloatArray>(buffers.array.length, values,
+                                             validity, buffers.array.null_count,
+                                             buffers.array.offset);
+}
+
+// Arrow's own min_max kernel. Its handling of NaN is its own, so the
+// benchmark data has none.
+void minMaxArrow(const std::shared_ptr<arrow::FloatArray> &array, float *min,
+                 float *max) {
+  auto result = arrow::compute::MinMax(array);
+  if (!result.ok()) {
+    std::cerr << result.status().ToString() << std::endl;
+    std::exit(1);
+  }
+  const auto &pair = result->scalar_as<arrow::StructScalar>();
+  *min = static_cast<const arrow::FloatScalar &>(*pair.value[0]).value;
+  *max = static_cast<const arrow::FloatScalar &>(*pair.value[1]).value;
+}
+
+// minMaxColumn on the array as Arrow exports it through the C data interface
+void minMaxExported(const arrow::FloatArray &array, float *min, float *max) {
+  ArrowArray exported;
+  ArrowSchema schema;
+  if (!arrow::ExportArray(array, &exported, &schema).ok()) {
+    std::exit(1);
+  }
+  ColumnView<float> view;
+  bool ok = columnView(schema, exported, &view);
+  assertInt(size_t(1), size_t(ok), "view of an exported array");
+  minMaxColumn(view, min, max);
+  exported.release(&exported);
+  schema.release(&schema);
+}
+#endif
+
+/*
+Min-max of a column of 2^exponent floats with nulls, at an offset that is
+not a multiple of 8: copying it out first, viewing it in place, and, when
+built with Arrow, Arrow's compute kernel.
+*/
+void benchmark(size_t N, double null_rate, std::string type) {
+  std::vector<float> data = generateRandomData<float>(N, -10000.0, 10000.0, 10);
+  std::vector<bool> valid(N);
+  std::mt19937 gen(7);
+  std::bernoulli_distribution is_null(null_rate);
+  for (size_t i = 0; i < N; i++) {
+    valid[i] = !is_null(gen);
+  }
+  size_t offset = std::min(N, size_t(3));
+  size_t length = N - offset;
+  ArrowBuffers<float> buffers(data, valid, offset, length);
+
+  float minExpected, maxExpected, min, max;
+  size_t nans;
+  {
+    t.start_timer();
+    std::vector<float> copy;
+    copy.reserve(length);
+    for (size_t i = offset; i < offset + length; i++) {
+      if (buffers.validity[i / 8] >> (i % 8) & 1) {
+        copy.push_back(buffers.values[i]);
+      }
+    }
+    minMaxAuto(copy.data(), copy.size(), &minExpected, &maxExpected);
+    t.stop_timer();
+    std::cout << "Elapsed time SIMD auto copy " << type << " : "
+              << t.time_elapsed() << std::endl;
+  }
+
+  ColumnView<float> view;
+  t.start_timer();
+  columnView(buffers.schema, buffers.array, &view);
+  minMaxColumn(view, &min, &max, &nans);
+  t.stop_timer();
+  std::cout << "Elapsed time SIMD auto column " << type << " : "
+            << t.time_elapsed() << std::endl;
+  assertFloat(minExpected, min, "min column " + type, FloatCheck::ulps(0));
+  assertFloat(maxExpected, max, "max column " + type, FloatCheck::ulps(0));
+
+#ifdef HAVE_ARROW
+  if (length > 0) {
+    std::shared_ptr<arrow::FloatArray> array = wrapArrow(buffers);
+    t.start_timer();
+    minMaxArrow(array, &min, &max);
+    t.stop_timer();
+    std::cout << "Elapsed time arrow min_max " << type << " : "
+              << t.time_elapsed() << std::endl;
+    assertFloat(minExpected, min, "min arrow " + type, FloatCheck::ulps(0));
+    assertFloat(maxExpected, max, "max arrow " + type, FloatCheck::ulps(0));
+
+    minMaxExported(*array, &min, &max);
+    assertFloat(minExpected, min, "min exported " + type, FloatCheck::ulps(0));
+    assertFloat(maxExpected, max, "max exported " + type, FloatCheck::ulps(0));
+  }
+#endif
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    std::cerr << "Usage: ./columnar size-exponent" << std::endl;
+    std::cerr << "Size of the column generated will be 2^(size-exponent)"
+              << std::endl;
+    return 1;
+  }
+
+  int exponent = std::atoi(argv[1]);
+  const size_t N = std::pow(2, exponent);
+
+#ifdef HAVE_ARROW
+#if ARROW_VERSION_MAJOR >= 21
+  if (!arrow::compute::Initialize().ok()) {
+    return 1;
+  }
+#endif
+#endif
+
+  benchmark(N, 0.0, "no nulls");
+  benchmark(N, 0.1, "10% nulls");
+  std::cout << "Assertion is successful for columns" << std::endl;
+
+  // Every offset within two words and every short length, with NaNs and
+  // signed zeros, under every policy
+  {
+    const float values[] = {0.0f, -0.0f, NAN, 1.0f, -1.0f, 5.0f};
+    std::mt19937 gen(8);
+    for (size_t size : {size_t(0), size_t(1), size_t(200)}) {
+      std::vector<float> data(size);
+      std::vector<bool> valid(size);
+      for (size_t i = 0; i < size; i++) {
+        data[i] = values[gen() % 6];
+        valid[i] = gen() % 4 != 0;
+      }
+      for (size_t offset = 0; offset <= std::min(size, size_t(130));
+           offset++) {
+        for (size_t length : {size_t(0), size_t(1), size_t(9), size_t(70),
+                              size - offset}) {
+          length = std::min(length, size - offset);
+          std::string name = "offset " + std::to_string(offset) + " length " +
+                             std::to_string(length);
+          checkColumn<NaNPolicy::Ignore>(data, valid, offset, length, name);
+          checkColumn<NaNPolicy::Propagate>(data, valid, offset, length,
+                                            name + " propagate");
+          checkColumn<NaNPolicy::MinNum>(data, valid, offset, length,
+                                         name + " minnum");
+        }
+      }
+    }
+
+    // Other types and released arrays are not viewed; an int column is
+    std::vector<int> ints(100, 2);
+    ArrowBuffers<int> intBuffers(ints, std::vector<bool>(100, true), 10, 80);
+    ColumnView<float> view;
+    ColumnView<int> intView;
+    assertInt(size_t(0),
+              size_t(columnView(intBuffers.schema, intBuffers.array, &view)),
+              "int array as float");
+    assertInt(size_t(1), size_t(columnView(intBuffers.schema, intBuffers.array,
+                                           &intView)),
+              "int array as int");
+    assertInt(size_t(160), size_t(sumAuto(intView.values, intView.length)),
+              "int column sum");
+    intBuffers.array.release(&intBuffers.array);
+    assertInt(size_t(0), size_t(columnView(intBuffers.schema, intBuffers.array,
+                                           &intView)),
+              "released array");
+    std::cout << "Assertion is successful for the edge cases" << std::endl;
+  }
+}
@@ -0,0 +1,162 @@
+#include "helpers.hpp"
+#include "simd.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/*
+"Golden" algorithm to find the dot product of the floating vectors "a" and
+"b". The products are summed in double, and the sum of their absolute values
+is written to "sumAbs" to scale the error allowed in the SIMD results.
+*/
+double dotGolden(const std::vector<float> &a, const std::vector<float> &b,
+                 double &sumAbs) {
+  double sum = 0;
+  sumAbs = 0;
+  for (size_t i = 0; i < a.size(); i++) {
+    double prod = double(a[i]) * b[i];
+    sum += prod;
+    sumAbs += std::fabs(prod);
+  }
+  return sum;
+}
+
+int64_t dotI8Golden(const std::vector<int8_t> &a,
+                    const std::vector<int8_t> &b) {
+  int64_t sum = 0;
+  for (size_t i = 0; i < a.size(); i++) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+float dotOMP(const std::vector<float> &a, const std::vector<float> &b) {
+  float sum = 0;
+  size_t N = a.size();
+#pragma omp parallel for reduction(+ : sum)
+  for (size_t i = 0; i < N; i++) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+typedef float (*DotKernel)(float const *, float const *, size_t);
+
+Timer<std::chrono::microseconds> t;
+
+/*
+Runs "kernel" on "a" and "b", prints its time and checks it against
+"expected", allowing an error of 0.1% of the sum of the absolute products.
+*/
+void checkDot(const std::vector<float> &a, const std::vector<float> &b,
+              DotKernel kernel, std::string name, double expected,
+              double sumAbs) {
+  t.start_timer();
+  float actual = kernel(a.data(), b.data(), a.size());
+  t.stop_timer();
+  std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+            << std::endl;
+
+  assertFloat(expected, actual, name, FloatCheck::relative(0, 1e-3 * sumAbs));
+}
+
+void checkDotI8(const std::vector<int8_t> &a, const std::vector<int8_t> &b,
+                DotI8Kernel kernel, std::string name, int64_t expected) {
+  t.start_timer();
+  int64_t actual = kernel(a.data(), b.data(), a.size());
+  t.stop_timer();
+  std::cout << "Elapsed time " << name << " int8 : " << t.time_elapsed()
+            << std::endl;
+
+  assertInt(expected, actual, name + " int8");
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    std::cerr << "Usage: ./dot size-exponent" << std::endl;
+    std::cerr << "Size of the arrays generated will be 2^(size-exponent)"
+              << std::endl;
+    return 1;
+  }
+
+  int exponent = std::atoi(argv[1]);
+  const size_t N = std::pow(2, exponent);
+
+  {
+    std::vector<float> a = generateRandomData<float>(N, -1.0, 1.0, 10);
+    std::vector<float> b = generateRandomData<float>(N, -1.0, 1.0, 11);
+
+    double expected, sumAbs;
+    t.start_timer();
+    expected = dotGolden(a, b, sumAbs);
+    t.stop_timer();
+    std::cout << "Elapsed time golden : " << t.time_elapsed() << std::endl;
+
+    t.start_timer();
+    float actual = dotOMP(a, b);
+    t.stop_timer();
+    std::cout << "Elapsed time openmp : " << t.time_elapsed() << std::endl;
+    assertFloat(expected, actual, "openmp",
+                FloatCheck::relative(0, 1e-3 * sumAbs));
+
+    checkDot(a, b, dotSSE, "SIMD SSE", expected, sumAbs);
+    checkDot(a, b, dotSSEOMP, "SIMD SSE+openmp", expected, sumAbs);
+#ifdef __AVX2__
+    checkDot(a, b, dotAVX2, "SIMD AVX", expected, sumAbs);
+    checkDot(a, b, dotAVX2OMP, "SIMD AVX+openmp", expected, sumAbs);
+#endif
+#ifdef __AVX512F__
+    checkDot(a, b, dotAVX512, "SIMD AVX512", expected, sumAbs);
+    checkDot(a, b, dotAVX512OMP, "SIMD AVX512+openmp", expected, sumAbs);
+#endif
+#ifdef SIMD_NEON
+    checkDot(a, b, dotNEON, "SIMD NEON", expected, sumAbs);
+    checkDot(a, b, dotNEONOMP, "SIMD NEON+openmp", expected, sumAbs);
+#endif
+    std::cout << "Assertion is successful for the float dot products"
+              << std::endl;
+  }
+
+  // int8 in [-127, 127], the range the int8 kernels support
+  {
+    std::mt19937 gen(10);
+    std::uniform_int_distribution<int> dist(-127, 127);
+    std::vector<int8_t> a(N), b(N);
+    for (size_t i = 0; i < N; i++) {
+      a[i] = dist(gen);
+      b[i] = dist(gen);
+    }
+
+    t.start_timer();
+    int64_t expected = dotI8Golden(a, b);
+    t.stop_timer();
+    std::cout << "Elapsed time golden int8 : " << t.time_elapsed()
+              << std::endl;
+
+    checkDotI8(a, b, dotSSE, "SIMD SSE", expected);
+    checkDotI8(a, b, dotSSEOMP, "SIMD SSE+openmp", expected);
+#ifdef __AVX2__
+    checkDotI8(a, b, dotAVX2, "SIMD AVX", expected);
+    checkDotI8(a, b, dotAVX2OMP, "SIMD AVX+openmp", expected);
+#endif
+#ifdef __AVX512BW__
+    checkDotI8(a, b, dotAVX512, "SIMD AVX512", expected);
+    checkDotI8(a, b, dotAVX512OMP, "SIMD AVX512+openmp", expected);
+#endif
+#ifdef SIMD_NEON
+    checkDotI8(a, b, dotNEON, "SIMD NEON", expected);
+    checkDotI8(a, b, dotNEONOMP, "SIMD NEON+openmp", expected);
+#endif
+
+    // Extreme values, the worst case for overflow in the 32-bit lanes
+    std::vector<int8_t> ext(N, -127);
+    assertInt(int64_t(N) * 127 * 127, dotAuto(ext.data(), ext.data(), N),
+              "int8 extreme");
+    assertInt(int64_t(N) * 127 * 127, dotAutoOMP(ext.data(), ext.data(), N),
+              "int8 extremeOMP");
+    std::cout << "Assertion is successful for the int8 dot products"
+              << std::endl;
+  }
+}
@@ -0,0 +1,311 @@
+#include "helpers.hpp"
+#include "reader.h"
+#include "simd.h"
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+Timer<std::chrono::microseconds> t;
+
+/*
+Min-max of the floats of fd read through "reader", with the SIMD kernels of
+minMaxAuto working on one chunk while the next ones are read. Trailing bytes
+that do not make a whole float are counted in "rest" and skipped.
+*/
+bool minMaxFile(ChunkReader &reader, float *min, float *max, size_t *nans,
+                size_t *rest) {
+  MinMaxAccumulator<> acc;
+  const char *data;
+  size_t bytes;
+  *rest = 0;
+  while ((bytes = reader.next(&data)) > 0) {
+    acc.update(reinterpret_cast<const float *>(data), bytes / sizeof(float));
+    *rest = bytes % sizeof(float);
+  }
+  acc.result(min, max, nans);
+  return reader.error() == 0;
+}
+
+// abs of the ints of the file behind "reader", written to out_fd
+bool absFile(ChunkReader &reader, int out_fd, size_t *rest) {
+  std::vector<int> out;
+  const char *data;
+  size_t bytes;
+  *rest = 0;
+  while ((bytes = reader.next(&data)) > 0) {
+    size_t n = bytes / sizeof(int);
+    out.resize(std::max(out.size(), n));
+    absAuto(reinterpret_cast<const int *>(data), n, out.data());
+    if (!writeAll(out_fd, out.data(), n * sizeof(int))) {
+      return false;
+    }
+    *rest = bytes % sizeof(int);
+  }
+  return reader.error() == 0;
+}
+
+std::vector<int> readWholeFile(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  std::vector<int> arr(lseek(fd, 0, SEEK_END) / sizeof(int));
+  ptrdiff_t n = readFull(fd, reinterpret_cast<char *>(arr.data()),
+                         arr.size() * sizeof(int), 0);
+  close(fd);
+  assertInt(arr.size() * sizeof(int), size_t(n), "read back " + path);
+  return arr;
+}
+
+// The read methods to compare; Auto on a regular file is IoUring or Pread
+const ReadMethod methods[] = {ReadMethod::IoUring, ReadMethod::Pread,
+                              ReadMethod::Read};
+
+/*
+Scans the float file at path with every read method and checks min, max and
+the NaN count against minMaxAuto on arr.
+*/
+void checkMinMaxFile(const std::string &path, const std::vector<float> &arr,
+                     size_t extra_bytes, size_t chunk, int n_buffers,
+                     bool print_time) {
+  float minExpected, maxExpected;
+  size_t nansExpected;
+  minMaxAuto(arr.data(), arr.size(), &minExpected, &maxExpected,
+             &nansExpected);
+
+  for (ReadMethod method : methods) {
+    int fd = open(path.c_str(), O_RDONLY);
+    float min, max;
+    size_t nans, rest;
+
+    t.start_timer();
+    ChunkReader reader(fd, chunk, n_buffers, method);
+    bool ok = minMaxFile(reader, &min, &max, &nans, &rest);
+    t.stop_timer();
+    close(fd);
+
+    std::string name = std::string("SIMD ") + readMethodName(reader.method());
+    if (print_time) {
+      std::cout << "Elapsed time " << name << " min-max : " << t.time_elapsed()
+                << std::endl;
+    }
+    assertInt(size_t(1), size_t(ok), name + " min-max read");
+    assertFloat(minExpected, min, name + " min", FloatCheck::exact());
+    assertFloat(maxExpected, max, name + " max", FloatCheck::exact());
+    assertInt(nansExpected, nans, name + " NaN count");
+    assertInt(extra_bytes, rest, name + " trailing bytes");
+  }
+}
+
+// Same for abs of the int file at path, written to a temporary file
+void checkAbsFile(const std::string &path, const std::vector<int> &arr,
+                  size_t extra_bytes, size_t chunk, int n_buffers,
+                  bool print_time) {
+  std::vector<int> expected(arr.size());
+  absAuto(arr.data(), arr.size(), expected.data());
+
+  for (ReadMethod method : methods) {
+    int fd = open(path.c_str(), O_RDONLY);
+    std::string out_path;
+    int out_fd = makeTempFile(&out_path);
+    size_t rest;
+
+    t.start_timer();
+    ChunkReader reader(fd, chunk, n_buffers, method);
+    bool ok = absFile(reader, out_fd, &rest);
+    t.stop_timer();
+    close(fd);
+    close(out_fd);
+
+    std::string name = std::string("SIMD ") + readMethodName(reader.method());
+    if (print_time) {
+      std::cout << "Elapsed time " << name << " abs : " << t.time_elapsed()
+                << std::endl;
+    }
+    assertInt(size_t(1), size_t(ok), name + " abs read");
+    assertInt(extra_bytes, rest, name + " trailing bytes");
+    std::vector<int> actual = readWholeFile(out_path);
+    unlink(out_path.c_str());
+    assertInt(expected.size(), actual.size(), name + " abs size");
+    assertArray(expected.data(), actual.data(), expected.size(), name + " abs");
+  }
+}
+
+// Min-max of floats written to a pipe in pieces of odd sizes
+void checkMinMaxPipe(const std::vector<float> &arr, size_t chunk) {
+  int fds[2];
+  assertInt(size_t(0), size_t(pipe(fds) != 0), "pipe");
+  std::thread writer([&] {
+    const char *p = reinterpret_cast<const char *>(arr.data());
+    size_t bytes = arr.size() * sizeof(float);
+    size_t piece = 1;
+    for (size_t i = 0; i < bytes; i += piece) {
+      piece = std::min((piece * 7 + 3) % 100003 + 1, bytes - i);
+      writeAll(fds[1], p + i, piece);
+    }
+    close(fds[1]);
+  });
+
+  float min, max, minExpected, maxExpected;
+  size_t nans, nansExpected, rest;
+  ChunkReader reader(fds[0], chunk, 2);
+  bool ok = minMaxFile(reader, &min, &max, &nans, &rest);
+  writer.join();
+  close(fds[0]);
+
+  minMaxAuto(arr.data(), arr.size(), &minExpected, &maxExpected,
+             &nansExpected);
+  assertInt(size_t(1), size_t(reader.method() == ReadMethod::Read),
+            "pipe read method");
+  assertInt(size_t(1), size_t(ok), "pipe min-max read");
+  assertFloat(minExpected, min, "pipe min", FloatCheck::exact());
+  assertFloat(maxExpected, max, "pipe max", FloatCheck::exact());
+  assertInt(nansExpected, nans, "pipe NaN count");
+}
+
+/*
+Benchmark: writes 2^exponent floats and ints to temporary files, times the
+scan of each with every read method against reading the whole file first,
+and checks the results against the in-memory kernels.
+*/
+int benchmark(size_t N) {
+  const size_t chunk = 16 << 20;
+  const int n_buffers = 3;
+
+  std::vector<float> arr = generateRandomData<float>(N, -10000.0, 10000.0, 10);
+  for (size_t i = 0; i < N; i += 1021) {
+    arr[i] = NAN;
+  }
+  std::string path = writeTempFile(arr.data(), N, 0);
+  {
+    // Golden: read the whole file, then scan it
+    std::vector<float> copy(N);
+    float min, max;
+    t.start_timer();
+    int fd = open(path.c_str(), O_RDONLY);
+    readFull(fd, reinterpret_cast<char *>(copy.data()), N * sizeof(float), 0);
+    close(fd);
+    minMaxAuto(copy.data(), N, &min, &max);
+    t.stop_timer();
+    std::cout << "Elapsed time golden min-max : " << t.time_elapsed()
+              << std::endl;
+  }
+  checkMinMaxFile(path, arr, 0, chunk, n_buffers, true);
+  unlink(path.c_str());
+  std::cout << "Assertion is successful for float min-max" << std::endl;
+
+  std::vector<int> arrInt = generateRandomData<int>(N, -10000, 10000, 2);
+  path = writeTempFile(arrInt.data(), N, 0);
+  checkAbsFile(path, arrInt, 0, chunk, n_buffers, true);
+  unlink(path.c_str());
+  std::cout << "Assertion is successful for int abs" << std::endl;
+
+  // Empty files, files smaller than a chunk, a whole number of chunks and
+  // a remainder with trailing bytes, with two and three buffers, and a pipe
+  {
+    const size_t small = readerAlignment;
+    const size_t floats = small / sizeof(float);
+    for (size_t n : {size_t(0), size_t(1), floats, 5 * floats + 3}) {
+      std::vector<float> part(arr.begin(), arr.begin() + std::min(n, N));
+      part.resize(n, -20000.0f);
+      for (size_t extra : {size_t(0), size_t(3)}) {
+        path = writeTempFile(part.data(), n, extra);
+        checkMinMaxFile(path, part, extra, small, 2, false);
+        checkMinMaxFile(path, part, extra, small, 3, false);
+        unlink(path.c_str());
+
+        std::vector<int> partInt(arrInt.begin(),
+                                 arrInt.begin() + std::min(n, N));
+        partInt.resize(n, INT_MIN);
+        path = writeTempFile(partInt.data(), n, extra);
+        checkAbsFile(path, partInt, extra, small, 2, false);
+        unlink(path.c_str());
+      }
+    }
+    checkMinMaxPipe(arr, small);
+    std::cout << "Assertion is successful for the edge cases" << std::endl;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+
+  std::string mode = argc > 1 ? argv[1] : "";
+  bool is_abs = mode == "abs";
+  if ((mode != "min-max" && !is_abs && argc != 2) ||
+      (mode == "min-max" && argc < 3) || (is_abs && argc < 4)) {
+    std::cerr << "Usage: ./file-scan size-exponent" << std::endl;
+    std::cerr << "       ./file-scan min-max input [chunk-MiB [buffers]]"
+              << std::endl;
+    std::cerr << "       ./file-scan abs input output [chunk-MiB [buffers]]"
+              << std::endl;
+    std::cerr << "The first form benchmarks a file of 2^(size-exponent) "
+                 "elements; the others read raw float (min-max) or int "
+                 "(abs) files"
+              << std::endl;
+    return 1;
+  }
+
+  if (mode != "min-max" && !is_abs) {
+    int exponent = std::atoi(argv[1]);
+    return benchmark(std::pow(2, exponent));
+  }
+
+  int first_option = is_abs ? 4 : 3;
+  size_t chunk_mib = argc > first_option ? std::atoi(argv[first_option]) : 64;
+  int n_buffers = argc > first_option + 1 ? std::atoi(argv[first_option + 1])
+                                          : 3;
+
+  // "-" reads stdin, e.g. the output of a decompressor
+  int fd = std::string(argv[2]) == "-" ? 0 : open(argv[2], O_RDONLY);
+  if (fd < 0) {
+    std::perror(argv[2]);
+    return 1;
+  }
+  int out_fd = -1;
+  if (is_abs) {
+    out_fd = open(argv[3], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0) {
+      std::perror(argv[3]);
+      return 1;
+    }
+  }
+
+  // The file is read once, so its pages are dropped behind the scan
+  ChunkReader reader(fd, chunk_mib << 20, n_buffers, ReadMethod::Auto, true);
+  size_t rest;
+  t.start_timer();
+  bool ok;
+  if (is_abs) {
+    ok = absFile(reader, out_fd, &rest);
+  } else {
+    float min, max;
+    size_t nans;
+    ok = minMaxFile(reader, &min, &max, &nans, &rest);
+    if (ok) {
+      std::cout << "min " << min << " max " << max << " NaNs " << nans
+                << std::endl;
+    }
+  }
+  t.stop_timer();
+  if (out_fd >= 0) {
+    close(out_fd);
+  }
+
+  if (!ok) {
+    std::cerr << argv[2] << ": "
+              << std::strerror(reader.error() ? reader.error() : errno)
+              << std::endl;
+    return 1;
+  }
+  if (rest > 0) {
+    std::cerr << "Ignored " << rest << " trailing bytes" << std::endl;
+  }
+  std::cout << "Elapsed time SIMD " << readMethodName(reader.method()) << " "
+            << mode << " : " << t.time_elapsed() << std::endl;
+  return 0;
+}
@@ -0,0 +1,158 @@
+#include "helpers.hpp"
+#include "simd.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <iostream>
+#include <vector>
+
+/*
+"Golden" algorithm for stream compaction: copies the elements of "arr" for
+which "pred" is true to "out" and returns their number.
+*/
+template <typename T, typename Pred>
+size_t filterGolden(const std::vector<T> &arr, std::vector<T> &out,
+                    Pred pred) {
+  size_t count = 0;
+  for (size_t i = 0; i < arr.size(); i++) {
+    if (pred(arr[i])) {
+      out[count++] = arr[i];
+    }
+  }
+  return count;
+}
+
+template <typename T, typename Pred>
+using FilterKernel = size_t (*)(T const *, size_t, T *, Pred);
+
+// Filtered floats are copies, so they must match bit for bit
+void assertArray(const float *expected, const float *actual, size_t N,
+                 std::string str) {
+  assertArray(expected, actual, N, FloatCheck::exact(), str);
+}
+
+Timer<std::chrono::microseconds> t;
+
+/*
+Runs "kernel" out of place and checks the count and the selected elements;
+the single threaded kernels are also run in place.
+*/
+template <typename T, typename Pred>
+void checkFilter(const std::vector<T> &arr, const std::vector<T> &expected,
+                 size_t countExpected, Pred pred, FilterKernel<T, Pred> kernel,
+                 std::string name, bool in_place, bool print_time) {
+  std::vector<T> actual(arr.size());
+
+  t.start_timer();
+  size_t countActual = kernel(arr.data(), arr.size(), actual.data(), pred);
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  assertInt(countExpected, countActual, "count " + name);
+  assertArray(expected.data(), actual.data(), countExpected, name);
+
+  if (in_place) {
+    std::vector<T> inplace = arr;
+    countActual = kernel(inplace.data(), inplace.size(), inplace.data(), pred);
+    assertInt(countExpected, countActual, "count " + name + " in place");
+    assertArray(expected.data(), inplace.data(), countExpected,
+                name + " in place");
+  }
+}
+
+// Checks every filter kernel against the golden algorithm
+template <typename T, typename Pred>
+void checkFilterAll(const std::vector<T> &arr, Pred pred, std::string type,
+                    bool print_time) {
+  std::vector<T> expected(arr.size());
+  size_t countExpected = filterGolden(arr, expected, pred);
+
+  if (print_time) {
+    std::vector<T> out(arr.size());
+    t.start_timer();
+    filterGolden(arr, out, pred);
+    t.stop_timer();
+    std::cout << "Elapsed time golden " << type << " : " << t.time_elapsed()
+              << std::endl;
+
+    t.start_timer();
+    std::copy_if(arr.begin(), arr.end(), out.begin(), pred);
+    t.stop_timer();
+    std::cout << "Elapsed time std " << type << " : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  // Each single threaded kernel is followed by its threaded version
+  FilterKernel<T, Pred> kernels[] = {
+      filterSSE,    filterSSEOMP,
+#ifdef __AVX2__
+      filterAVX2,   filterAVX2OMP,
+#endif
+#ifdef __AVX512F__
+      filterAVX512, filterAVX512OMP,
+#endif
+#ifdef SIMD_NEON
+      filterNEON,   filterNEONOMP,
+#endif
+  };
+  std::string names[] = {
+      "SIMD SSE",    "SIMD SSE+openmp",
+#ifdef __AVX2__
+      "SIMD AVX",    "SIMD AVX+openmp",
+#endif
+#ifdef __AVX512F__
+      "SIMD AVX512", "SIMD AVX512+openmp",
+#endif
+#ifdef SIMD_NEON
+      "SIMD NEON",   "SIMD NEON+openmp",
+#endif
+  };
+
+  for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+    checkFilter(arr, expected, countExpected, pred, kernels[k],
+                names[k] + " " + type, k % 2 == 0, print_time);
+  }
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    std::cerr << "Usage: ./filter size-exponent" << std::endl;
+    std::cerr << "Size of the array generated will be 2^(size-exponent)"
+              << std::endl;
+    return 1;
+  }
+
+  int exponent = std::atoi(argv[1]);
+  const size_t N = std::pow(2, exponent);
+
+  // Selectivities of about 50%, 1% and 99%
+  std::vector<int> arrInt = generateRandomData<int>(N, -10000, 10000, 2);
+  checkFilterAll(arrInt, AbsGreater{5000}, "int", true);
+  checkFilterAll(arrInt, AbsGreater{9900}, "int 1%", true);
+  checkFilterAll(arrInt, AbsGreater{100}, "int 99%", true);
+  std::cout << "Assertion is successful for int filter" << std::endl;
+
+  std::vector<float> arr = generateRandomData<float>(N, -10000.0, 10000.0, 10);
+  for (size_t i = 0; i < N; i += 1021) {
+    arr[i] = NAN;
+  }
+  checkFilterAll(arr, Greater<float>{0.0f}, "float", true);
+  std::cout << "Assertion is successful for float filter" << std::endl;
+
+  // Fewer elements than one vector, INT_MIN, nothing and everything selected,
+  // and more than one block with a remainder
+  checkFilterAll<int>({3, -7, 1}, AbsGreater{2}, "int", false);
+  checkFilterAll<int>({INT_MIN, 5, -5, INT_MAX}, AbsGreater{4}, "int", false);
+  checkFilterAll(arrInt, AbsGreater{10000}, "int", false);
+  checkFilterAll(arrInt, AbsGreater{-1}, "int", false);
+  std::vector<int> blocks(3 * filterBlock + 37);
+  for (size_t i = 0; i < blocks.size(); i++) {
+    blocks[i] = i % 3 == 0 || i / filterBlock == 1 ? 1 : 0;
+  }
+  checkFilterAll(blocks, Greater<int>{0}, "int", false);
+  std::cout << "Assertion is successful for the edge cases" << std::endl;
+}
@@ -0,0 +1,181 @@
+#include "helpers.hpp"
+#include "simd.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+Timer<std::chrono::microseconds> t;
+
+/*
+"Golden" algorithm for the min-max of the selected rows arr[indices[i]]: one
+scalar load and compare per row, in the order of the indices.
+*/
+template <NaNPolicy policy>
+void minMaxGatherGolden(const std::vector<float> &arr,
+                        const std::vector<int> &indices, float *min,
+                        float *max, size_t *nans) {
+  std::vector<float> selected(indices.size());
+  for (size_t i = 0; i < indices.size(); i++) {
+    selected[i] = arr[indices[i]];
+  }
+  *min = INFINITY;
+  *max = -INFINITY;
+  *nans = 0;
+  minMaxRemainder<policy>(selected.data(), 0, selected.size(), *min, *max,
+                          *nans);
+  minMaxZeroSign<policy>(selected.data(), selected.size(), *min, *max);
+  minMaxFinish<policy>(selected.size(), *nans, min, max, nullptr);
+}
+
+typedef void (*MinMaxGatherKernel)(float const *, int const *, size_t, float *,
+                                   float *, size_t *);
+
+template <NaNPolicy policy>
+void checkGather(const std::vector<float> &arr,
+                 const std::vector<int> &indices, MinMaxGatherKernel kernel,
+                 std::string name, bool print_time) {
+  float minExpected, maxExpected, minActual, maxActual;
+  size_t nansExpected, nansActual;
+  minMaxGatherGolden<policy>(arr, indices, &minExpected, &maxExpected,
+                             &nansExpected);
+
+  t.start_timer();
+  kernel(arr.data(), indices.data(), indices.size(), &minActual, &maxActual,
+         &nansActual);
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  // Ignore leaves the sign of a zero result unspecified
+  FloatCheck check = policy == NaNPolicy::Ignore ? FloatCheck::ulps(0)
+                                                 : FloatCheck::exact();
+  assertFloat(minExpected, minActual, "min " + name, check);
+  assertFloat(maxExpected, maxActual, "max " + name, check);
+  assertInt(nansExpected, nansActual, "nans " + name);
+}
+
+/*
+Times the strategies for the rows selected by "indices": scalar loads,
+sorting the indices first for locality, and the gather and prefetch kernels.
+*/
+template <NaNPolicy policy>
+void checkGatherAll(const std::vector<float> &arr,
+                    const std::vector<int> &indices, std::string type,
+                    bool print_time) {
+  if (print_time) {
+    float min = INFINITY, max = -INFINITY;
+    size_t nans = 0;
+    t.start_timer();
+    for (size_t i = 0; i < indices.size(); i++) {
+      float x = arr[indices[i]];
+      if (std::isnan(x)) {
+        nans++;
+        continue;
+      }
+      min = x < min ? x : min;
+      max = x > max ? x : max;
+    }
+    t.stop_timer();
+    std::cout << "Elapsed time golden " << type << " : " << t.time_elapsed()
+              << std::endl;
+
+    std::vector<int> sorted = indices;
+    t.start_timer();
+    std::sort(sorted.begin(), sorted.end());
+    minMaxGatherAuto(arr.data(), sorted.data(), sorted.size(), &min, &max);
+    t.stop_timer();
+    std::cout << "Elapsed time sort first " << type << " : "
+              << t.time_elapsed() << std::endl;
+  }
+
+  checkGather<policy>(arr, indices,
+                      minMaxGatherSSE<GatherMode::Hardware, policy>,
+                      "SIMD SSE gather " + type, print_time);
+  checkGather<policy>(arr, indices,
+                      minMaxGatherSSE<GatherMode::Prefetch, policy>,
+                      "SIMD SSE prefetch " + type, print_time);
+#ifdef __AVX2__
+  checkGather<policy>(arr, indices,
+                      minMaxGatherAVX2<GatherMode::Hardware, policy>,
+                      "SIMD AVX gather " + type, print_time);
+  checkGather<policy>(arr, indices,
+                      minMaxGatherAVX2<GatherMode::Prefetch, policy>,
+                      "SIMD AVX prefetch " + type, print_time);
+#endif
+#ifdef __AVX512F__
+  checkGather<policy>(arr, indices,
+                      minMaxGatherAVX512<GatherMode::Hardware, policy>,
+                      "SIMD AVX512 gather " + type, print_time);
+  checkGather<policy>(arr, indices,
+                      minMaxGatherAVX512<GatherMode::Prefetch, policy>,
+                      "SIMD AVX512 prefetch " + type, print_time);
+#endif
+#ifdef SIMD_NEON
+  checkGather<policy>(arr, indices,
+                      minMaxGatherNEON<GatherMode::Hardware, policy>,
+                      "SIMD NEON gather " + type, print_time);
+  checkGather<policy>(arr, indices,
+                      minMaxGatherNEON<GatherMode::Prefetch, policy>,
+                      "SIMD NEON prefetch " + type, print_time);
+#endif
+}
+
+// "count" distinct rows of [0, N) in random order
+std::vector<int> selectRows(size_t N, size_t count, uint32_t seed) {
+  std::vector<int> rows(N);
+  std::iota(rows.begin(), rows.end(), 0);
+  std::shuffle(rows.begin(), rows.end(), std::mt19937(seed));
+  rows.resize(count);
+  return rows;
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    std::cerr << "Usage: ./gather size-exponent" << std::endl;
+    std::cerr << "Size of the array generated will be 2^(size-exponent)"
+              << std::endl;
+    return 1;
+  }
+
+  int exponent = std::atoi(argv[1]);
+  const size_t N = std::pow(2, exponent);
+
+  std::vector<float> arr = generateRandomData<float>(N, -10000.0, 10000.0, 10);
+  for (size_t i = 0; i < N; i += 1021) {
+    arr[i] = NAN;
+  }
+
+  // Selectivities of 1%, 10%, 50% and 100% of the rows
+  for (size_t percent : {1, 10, 50, 100}) {
+    std::vector<int> indices = selectRows(N, N * percent / 100, percent);
+    checkGatherAll<NaNPolicy::Ignore>(arr, indices,
+                                      std::to_string(percent) + "%", true);
+  }
+  std::cout << "Assertion is successful for gather min-max" << std::endl;
+
+  // Every length up to a few vectors and repeated rows, with signed zeros,
+  // under every policy
+  {
+    std::vector<float> zeros = {0.0f, -0.0f, NAN, 1.0f, -1.0f};
+    std::mt19937 gen(3);
+    for (size_t n = 0; n <= 70; n++) {
+      std::vector<int> indices(n);
+      for (size_t i = 0; i < n; i++) {
+        indices[i] = gen() % (i % 2 ? zeros.size() - 2 : zeros.size());
+      }
+      checkGatherAll<NaNPolicy::Ignore>(zeros, indices, "ignore", false);
+      checkGatherAll<NaNPolicy::Propagate>(zeros, indices, "propagate",
+                                           false);
+      checkGatherAll<NaNPolicy::MinNum>(zeros, indices, "minnum", false);
+      checkGatherAll<NaNPolicy::MinNum>(arr, selectRows(N, std::min(n, N), n),
+                                        "minnum", false);
+    }
+    std::cout << "Assertion is successful for the edge cases" << std::endl;
+  }
+}
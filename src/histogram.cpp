@@ -0,0 +1,143 @@
+#include "helpers.hpp"
+#include "simd.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+/*
+"Golden" algorithm to find the histogram of "arr" with "bins" bins over
+[min, max] of the array. NaNs are skipped. The bin of each element is found
+with the same arithmetic as the SIMD kernels (histogramBin in simd.h).
+*/
+void histogramGolden(const std::vector<float> &arr, size_t bins,
+                     std::vector<size_t> &hist, float &min, float &max) {
+  min = INFINITY;
+  max = -INFINITY;
+  for (size_t i = 0; i < arr.size(); i++) {
+    if (arr[i] < min) {
+      min = arr[i];
+    }
+    if (arr[i] > max) {
+      max = arr[i];
+    }
+  }
+  // No numbers at all, as in the min-max kernels
+  if (min > max) {
+    min = max = NAN;
+  }
+
+  float scale = histogramScale(min, max, bins);
+  std::fill(hist.begin(), hist.end(), 0);
+  for (size_t i = 0; i < arr.size(); i++) {
+    size_t b = histogramBin(arr[i], min, scale, bins);
+    if (b < bins) {
+      hist[b]++;
+    }
+  }
+}
+
+typedef void (*HistogramKernel)(float const *, size_t, size_t, size_t *,
+                                float *, float *);
+
+Timer<std::chrono::microseconds> t;
+
+// Runs "kernel" and checks the counts and the range against the golden ones
+void checkHistogram(const std::vector<float> &arr, size_t bins,
+                    HistogramKernel kernel, std::string name,
+                    bool print_time) {
+  std::vector<size_t> expected(bins);
+  float minExpected, maxExpected;
+  histogramGolden(arr, bins, expected, minExpected, maxExpected);
+
+  std::vector<size_t> actual(bins);
+  float minActual, maxActual;
+  t.start_timer();
+  kernel(arr.data(), arr.size(), bins, actual.data(), &minActual, &maxActual);
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  assertFloat(minExpected, minActual, "min" + name, FloatCheck::exact());
+  assertFloat(maxExpected, maxActual, "max" + name, FloatCheck::exact());
+  for (size_t b = 0; b < bins; b++) {
+    assertInt(expected[b], actual[b], name + " bin " + std::to_string(b));
+  }
+}
+
+// Checks every histogram kernel with the given number of bins
+void checkHistogramAll(const std::vector<float> &arr, size_t bins,
+                       bool print_time) {
+  std::string suffix = print_time ? "" : " " + std::to_string(bins);
+  checkHistogram(arr, bins, histogramSSE, "SIMD SSE" + suffix, print_time);
+  checkHistogram(arr, bins, histogramSSEOMP, "SIMD SSE+openmp" + suffix,
+                 print_time);
+#ifdef __AVX2__
+  checkHistogram(arr, bins, histogramAVX, "SIMD AVX" + suffix, print_time);
+  checkHistogram(arr, bins, histogramAVXOMP, "SIMD AVX+openmp" + suffix,
+                 print_time);
+#endif
+#ifdef __AVX512F__
+  checkHistogram(arr, bins, histogramAVX512, "SIMD AVX512" + suffix,
+                 print_time);
+  checkHistogram(arr, bins, histogramAVX512OMP, "SIMD AVX512+openmp" + suffix,
+                 print_time);
+#endif
+#if defined(__AVX512CD__) && defined(__AVX512VPOPCNTDQ__)
+  checkHistogram(arr, bins, histogramAVX512CD, "SIMD AVX512CD" + suffix,
+                 print_time);
+  checkHistogram(arr, bins, histogramAVX512CDOMP,
+                 "SIMD AVX512CD+openmp" + suffix, print_time);
+#endif
+#ifdef SIMD_NEON
+  checkHistogram(arr, bins, histogramNEON, "SIMD NEON" + suffix, print_time);
+  checkHistogram(arr, bins, histogramNEONOMP, "SIMD NEON+openmp" + suffix,
+                 print_time);
+#endif
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    std::cerr << "Usage: ./histogram size-exponent [bins]" << std::endl;
+    std::cerr << "Size of the array generated will be 2^(size-exponent)"
+              << std::endl;
+    return 1;
+  }
+
+  int exponent = std::atoi(argv[1]);
+  const size_t N = std::pow(2, exponent);
+  const size_t bins = argc > 2 ? std::atoi(argv[2]) : 256;
+
+  std::vector<float> arr = generateRandomData<float>(N, -10000.0, 10000.0, 10);
+  for (size_t i = 0; i < N; i += 1021) {
+    arr[i] = NAN;
+  }
+
+  {
+    std::vector<size_t> hist(bins);
+    float min, max;
+    t.start_timer();
+    histogramGolden(arr, bins, hist, min, max);
+    t.stop_timer();
+    std::cout << "Elapsed time golden : " << t.time_elapsed() << std::endl;
+  }
+
+  checkHistogramAll(arr, bins, true);
+  std::cout << "Assertion is successful for histogram" << std::endl;
+
+  // Skewed data, where many lanes of a vector share a bin, a single bin and
+  // a constant array
+  {
+    std::vector<float> skewed = arr;
+    for (size_t i = 0; i < N; i++) {
+      skewed[i] = float(i % 7 == 0) * skewed[i];
+    }
+    checkHistogramAll(skewed, 16, false);
+    checkHistogramAll(arr, 1, false);
+    checkHistogramAll(std::vector<float>(37, 5.0f), 8, false);
+    checkHistogramAll({NAN, 3.0f, -2.0f, 7.0f}, 3, false);
+    std::cout << "Assertion is successful for the edge cases" << std::endl;
+  }
+}
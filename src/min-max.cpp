@@ -1,8 +1,10 @@
 #include "helpers.hpp"
+#include "reader.h"
 #include "simd.h"
 #include <cfloat>
 #include <chrono>
 #include <iostream>
+#include <random>
 #include <vector>
 
 /*
@@ -10,20 +12,34 @@
 Takes a floating vector "arr" as input.
 Writes the minimum and maximum value in the "min" and "max" variables
 respectively, which are passed as reference.
+NaNs and signed zeros are treated according to "policy" (see simd.h) and the
+number of NaNs found is written to "nans".
 */
-void minMaxGolden(const std::vector<float> &arr, float &min, float &max) {
-  min = max = arr[0];
-  for (size_t i = 1; i < arr.size(); i++) {
-    if (min > arr[i]) {
+template <NaNPolicy policy = NaNPolicy::Ignore>
+void minMaxGolden(const std::vector<float> &arr, float &min, float &max,
+                  size_t &nans) {
+  min = INFINITY;
+  max = -INFINITY;
+  nans = 0;
+  for (size_t i = 0; i < arr.size(); i++) {
+    if (std::isnan(arr[i])) {
+      nans++;
+      continue;
+    }
+    if (min > arr[i] || (policy != NaNPolicy::Ignore && min == arr[i] &&
+                         std::signbit(arr[i]))) {
       min = arr[i];
     }
-    if (max < arr[i]) {
+    if (max < arr[i] || (policy != NaNPolicy::Ignore && max == arr[i] &&
+                         !std::signbit(arr[i]))) {
       max = arr[i];
     }
   }
+  if (nans == arr.size() || (policy == NaNPolicy::Propagate && nans > 0)) {
+    min = max = NAN;
+  }
 }
 
-
 void minMaxOMP(const std::vector<float> &arr, float &min, float &max) {
   min = max = arr[0];
   size_t N = arr.size();
@@ -53,15 +69,420 @@ void minMaxOMP(const std::vector<float> &arr, float &min, float &max) {
   }
 }
 
+typedef void (*MinMaxKernel)(float const *, size_t, float *, float *,
+                             size_t *);
+
+// Feeds arr[begin, end) to "acc" in chunks of varying, mostly unaligned sizes
+template <typename Accumulator>
+void minMaxStreamChunks(Accumulator &acc, float const *arr, size_t begin,
+                        size_t end) {
+  size_t chunk = 1;
+  for (size_t i = begin; i < end; i += chunk) {
+    chunk = std::min((chunk * 7 + 3) % 4099 + 1, end - i);
+    acc.update(arr + i, chunk);
+  }
+}
+
+/*
+Min-max through MinMaxAccumulator, with the same signature as the kernels:
+two accumulators take one half of the array each, in chunks, and are merged.
+*/
+template <int W, NaNPolicy policy>
+void minMaxStream(float const *arr, size_t N, float *min, float *max,
+                  size_t *nans) {
+  MinMaxAccumulator<W, policy> first, second;
+  minMaxStreamChunks(first, arr, 0, N / 2);
+  minMaxStreamChunks(second, arr, N / 2, N);
+  first.merge(second);
+  first.result(min, max, nans);
+}
+
+/*
+Runs "kernel" with the given NaN policy on "arr" and checks its min, max and
+NaN count against the golden algorithm, which must agree bit for bit.
+*/
+template <NaNPolicy policy>
+void checkNaNPolicy(const std::vector<float> &arr, MinMaxKernel kernel,
+                    std::string name, bool print_time) {
+  float minExpected, maxExpected;
+  size_t nansExpected;
+  minMaxGolden<policy>(arr, minExpected, maxExpected, nansExpected);
+
+  float minActual, maxActual;
+  size_t nansActual;
+  Timer<std::chrono::microseconds> t;
+
+  t.start_timer();
+  kernel(arr.data(), arr.size(), &minActual, &maxActual, &nansActual);
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  // Ignore leaves the sign of a zero result unspecified, and 0 ULPs treats
+  // -0 and +0 as equal
+  FloatCheck check = policy == NaNPolicy::Ignore ? FloatCheck::ulps(0)
+                                                 : FloatCheck::exact();
+  assertFloat(minExpected, minActual, "min" + name, check);
+  assertFloat(maxExpected, maxActual, "max" + name, check);
+  assertInt(nansExpected, nansActual, "nans" + name);
+}
+
+// Checks every min-max kernel with the given NaN policy
+template <NaNPolicy policy>
+void checkNaNPolicyAll(const std::vector<float> &arr, std::string policy_name,
+                       bool print_time) {
+  checkNaNPolicy<policy>(arr, minMaxSSE<policy>, "SIMD SSE " + policy_name,
+                         print_time);
+  checkNaNPolicy<policy>(arr, minMaxSSEOMP<policy>,
+                         "SIMD SSE+openmp " + policy_name, print_time);
+#ifdef __AVX2__
+  checkNaNPolicy<policy>(arr, minMaxAVX<policy>, "SIMD AVX " + policy_name,
+                         print_time);
+  checkNaNPolicy<policy>(arr, minMaxAVXOMP<policy>,
+                         "SIMD AVX+openmp " + policy_name, print_time);
+#endif
+#ifdef __AVX512F__
+  checkNaNPolicy<policy>(arr, minMaxAVX512<policy>,
+                         "SIMD AVX512 " + policy_name, print_time);
+  checkNaNPolicy<policy>(arr, minMaxAVX512OMP<policy>,
+                         "SIMD AVX512+openmp " + policy_name, print_time);
+#endif
+#ifdef SIMD_NEON
+  checkNaNPolicy<policy>(arr, minMaxNEON<policy>, "SIMD NEON " + policy_name,
+                         print_time);
+  checkNaNPolicy<policy>(arr, minMaxNEONOMP<policy>,
+                         "SIMD NEON+openmp " + policy_name, print_time);
+#endif
+#ifdef SIMD_SVE
+  checkNaNPolicy<policy>(arr, minMaxSVE<policy>, "SIMD SVE " + policy_name,
+                         print_time);
+  checkNaNPolicy<policy>(arr, minMaxSVEOMP<policy>,
+                         "SIMD SVE+openmp " + policy_name, print_time);
+#endif
+  checkNaNPolicy<policy>(arr, minMaxStream<4, policy>,
+                         "SIMD SSE stream " + policy_name, print_time);
+#ifdef __AVX2__
+  checkNaNPolicy<policy>(arr, minMaxStream<8, policy>,
+                         "SIMD AVX stream " + policy_name, print_time);
+#endif
+#ifdef __AVX512F__
+  checkNaNPolicy<policy>(arr, minMaxStream<16, policy>,
+                         "SIMD AVX512 stream " + policy_name, print_time);
+#endif
+  checkNaNPolicy<policy>(arr, minMaxAuto<policy>, "SIMD auto " + policy_name,
+                         false);
+  checkNaNPolicy<policy>(arr, minMaxAutoOMP<policy>,
+                         "SIMD auto+openmp " + policy_name, false);
+}
+
+// The threaded kernel run on mapped files
+#ifdef __AVX2__
+const MinMaxKernel minMaxMappedKernel = minMaxAVXOMP<>;
+const char *const minMaxMappedName = "SIMD AVX+openmp mmap";
+#else
+const MinMaxKernel minMaxMappedKernel = minMaxSSEOMP<>;
+const char *const minMaxMappedName = "SIMD SSE+openmp mmap";
+#endif
+
+/*
+Min-max of the floats of the file at path, run on a mapping of the file
+instead of a copy. Every thread first asks for the share of the file it
+scans to be read ahead, so the kernel starts on the first pages at once.
+Returns errno if the file cannot be mapped, else 0.
+*/
+int minMaxMapped(const char *path, bool populate, float *min, float *max,
+                 size_t *nans) {
+  MappedFile file(path, populate);
+  if (file.error()) {
+    return file.error();
+  }
+  file.willNeedPerThread();
+  minMaxMappedKernel(reinterpret_cast<const float *>(file.data()),
+                     file.size() / sizeof(float), min, max, nans);
+  return 0;
+}
+
+// Writes arr to a file and checks min-max on its mapping against the golden
+void checkMapped(const std::vector<float> &arr, bool populate,
+                 bool print_time) {
+  float minExpected, maxExpected;
+  size_t nansExpected;
+  minMaxGolden(arr, minExpected, maxExpected, nansExpected);
+
+  // Two trailing bytes that do not make a float
+  std::string path = writeTempFile(arr.data(), arr.size(), 2);
+  std::string name =
+      std::string(minMaxMappedName) + (populate ? " populate" : "");
+  float minActual, maxActual;
+  size_t nansActual;
+  Timer<std::chrono::microseconds> t;
+
+  t.start_timer();
+  int error = minMaxMapped(path.c_str(), populate, &minActual, &maxActual,
+                           &nansActual);
+  t.stop_timer();
+  unlink(path.c_str());
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  assertInt(size_t(0), size_t(error), "mmap error " + name);
+  assertFloat(minExpected, minActual, "min" + name, FloatCheck::ulps(0));
+  assertFloat(maxExpected, maxActual, "max" + name, FloatCheck::ulps(0));
+  assertInt(nansExpected, nansActual, "nans" + name);
+}
+
+typedef void (*MinMaxBatchKernel)(float const *const *, size_t const *,
+                                  size_t, float *, float *, size_t *);
+
+/*
+Runs the batch "kernel" on the columns and checks every column against the
+golden algorithm.
+*/
+template <NaNPolicy policy>
+void checkBatch(const std::vector<const float *> &columns,
+                const std::vector<size_t> &lengths, MinMaxBatchKernel kernel,
+                std::string name, bool print_time) {
+  size_t n_columns = columns.size();
+  std::vector<float> minActual(n_columns), maxActual(n_columns);
+  std::vector<size_t> nansActual(n_columns);
+  Timer<std::chrono::microseconds> t;
+
+  t.start_timer();
+  kernel(columns.data(), lengths.data(), n_columns, minActual.data(),
+         maxActual.data(), nansActual.data());
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  FloatCheck check = policy == NaNPolicy::Ignore ? FloatCheck::ulps(0)
+                                                 : FloatCheck::exact();
+  for (size_t c = 0; c < n_columns; c++) {
+    std::vector<float> column(columns[c], columns[c] + lengths[c]);
+    float minExpected, maxExpected;
+    size_t nansExpected;
+    minMaxGolden<policy>(column, minExpected, maxExpected, nansExpected);
+
+    std::string column_name = name + " column " + std::to_string(c);
+    assertFloat(minExpected, minActual[c], "min" + column_name, check);
+    assertFloat(maxExpected, maxActual[c], "max" + column_name, check);
+    assertInt(nansExpected, nansActual[c], "nans" + column_name);
+  }
+}
+
+/*
+Min-max of columns of many different lengths, slices of arr: one call per
+column to the threaded kernel against one call to the batch kernels.
+*/
+void checkBatchAll(const std::vector<float> &arr, bool print_time) {
+  const size_t N = arr.size();
+  std::vector<const float *> columns;
+  std::vector<size_t> lengths;
+  for (size_t c = 0; c < 64; c++) {
+    size_t begin = c * 7919 % N;
+    columns.push_back(arr.data() + begin);
+    lengths.push_back(std::min(N - begin, (N >> (c % 12)) + c % 5));
+  }
+  // An empty column and a column of NaNs
+  std::vector<float> nans(100, NAN);
+  columns.push_back(arr.data());
+  lengths.push_back(0);
+  columns.push_back(nans.data());
+  lengths.push_back(nans.size());
+
+  if (print_time) {
+    Timer<std::chrono::microseconds> t;
+    float min, max;
+    t.start_timer();
+    for (size_t c = 0; c < columns.size(); c++) {
+      minMaxAutoOMP(columns[c], lengths[c], &min, &max);
+    }
+    t.stop_timer();
+    std::cout << "Elapsed time SIMD auto+openmp per column : "
+              << t.time_elapsed() << std::endl;
+  }
+
+  checkBatch<NaNPolicy::Ignore>(columns, lengths, minMaxBatchSSE<>,
+                                "SIMD SSE batch", print_time);
+#ifdef __AVX2__
+  checkBatch<NaNPolicy::Ignore>(columns, lengths, minMaxBatchAVX<>,
+                                "SIMD AVX batch", print_time);
+#endif
+#ifdef __AVX512F__
+  checkBatch<NaNPolicy::Ignore>(columns, lengths, minMaxBatchAVX512<>,
+                                "SIMD AVX512 batch", print_time);
+#endif
+#ifdef SIMD_NEON
+  checkBatch<NaNPolicy::Ignore>(columns, lengths, minMaxBatchNEON<>,
+                                "SIMD NEON batch", print_time);
+#endif
+  checkBatch<NaNPolicy::Propagate>(columns, lengths,
+                                   minMaxBatchAuto<NaNPolicy::Propagate>,
+                                   "SIMD auto batch propagate", false);
+  checkBatch<NaNPolicy::MinNum>(columns, lengths,
+                                minMaxBatchAuto<NaNPolicy::MinNum>,
+                                "SIMD auto batch minnum", false);
+}
+
+typedef void (*MinMaxMaskedKernel)(float const *, uint8_t const *, size_t,
+                                   float *, float *, size_t *);
+
+/*
+Runs the masked "kernel" on arr with the validity bitmap and checks it
+against the golden algorithm on a copy of the valid elements.
+*/
+template <NaNPolicy policy>
+void checkMasked(const std::vector<float> &arr,
+                 const std::vector<uint8_t> &validity,
+                 MinMaxMaskedKernel kernel, std::string name,
+                 bool print_time) {
+  std::vector<float> valid;
+  for (size_t i = 0; i < arr.size(); i++) {
+    if (validity[i / 8] >> (i % 8) & 1) {
+      valid.push_back(arr[i]);
+    }
+  }
+  float minExpected, maxExpected;
+  size_t nansExpected;
+  minMaxGolden<policy>(valid, minExpected, maxExpected, nansExpected);
+
+  float minActual, maxActual;
+  size_t nansActual;
+  Timer<std::chrono::microseconds> t;
+
+  t.start_timer();
+  kernel(arr.data(), validity.data(), arr.size(), &minActual, &maxActual,
+         &nansActual);
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  FloatCheck check = policy == NaNPolicy::Ignore ? FloatCheck::ulps(0)
+                                                 : FloatCheck::exact();
+  assertFloat(minExpected, minActual, "min" + name, check);
+  assertFloat(maxExpected, maxActual, "max" + name, check);
+  assertInt(nansExpected, nansActual, "nans" + name);
+}
+
+/*
+Checks every masked kernel, and times them against copying the valid
+elements out and calling minMaxAuto, which is what a caller had to do.
+*/
+template <NaNPolicy policy>
+void checkMaskedAll(const std::vector<float> &arr,
+                    const std::vector<uint8_t> &validity, std::string type,
+                    bool print_time) {
+  if (print_time) {
+    Timer<std::chrono::microseconds> t;
+    std::vector<float> valid(arr.size());
+    float min, max;
+    t.start_timer();
+    size_t n = 0;
+    for (size_t i = 0; i < arr.size(); i++) {
+      valid[n] = arr[i];
+      n += validity[i / 8] >> (i % 8) & 1;
+    }
+    minMaxAuto<policy>(valid.data(), n, &min, &max);
+    t.stop_timer();
+    std::cout << "Elapsed time SIMD auto copy valid " << type << " : "
+              << t.time_elapsed() << std::endl;
+  }
+
+  checkMasked<policy>(arr, validity, minMaxMaskedSSE<policy>,
+                      "SIMD SSE masked " + type, print_time);
+#ifdef __AVX2__
+  checkMasked<policy>(arr, validity, minMaxMaskedAVX<policy>,
+                      "SIMD AVX masked " + type, print_time);
+#endif
+#ifdef __AVX512F__
+  checkMasked<policy>(arr, validity, minMaxMaskedAVX512<policy>,
+                      "SIMD AVX512 masked " + type, print_time);
+#endif
+#ifdef SIMD_NEON
+  checkMasked<policy>(arr, validity, minMaxMaskedNEON<policy>,
+                      "SIMD NEON masked " + type, print_time);
+#endif
+}
+
+/*
+A validity bitmap for N elements: each element is null with probability
+null_rate, or with whole_words each 64-element word is.
+*/
+std::vector<uint8_t> makeValidity(size_t N, double null_rate,
+                                  bool whole_words, uint32_t seed) {
+  std::mt19937 gen(seed);
+  std::bernoulli_distribution is_null(null_rate);
+  std::vector<uint8_t> validity((N + 7) / 8, 0);
+  bool word_null = false;
+  for (size_t i = 0; i < N; i++) {
+    if (i % 64 == 0) {
+      word_null = is_null(gen);
+    }
+    if (!(whole_words ? word_null : is_null(gen))) {
+      validity[i / 8] |= 1 << (i % 8);
+    }
+  }
+  return validity;
+}
+
+template <NaNPolicy policy>
+void checkNaNPolicyEdgeCases(std::string policy_name) {
+  // Signed zeros only, with a length that leaves a scalar remainder
+  std::vector<float> zeros(37, 0.0f);
+  for (size_t i = 0; i < zeros.size(); i += 3) {
+    zeros[i] = -0.0f;
+  }
+  checkNaNPolicyAll<policy>(zeros, policy_name, false);
+
+  // Nothing but NaNs
+  std::vector<float> nans(37, NAN);
+  checkNaNPolicyAll<policy>(nans, policy_name, false);
+
+  // Fewer elements than one vector
+  std::vector<float> tiny = {NAN, 3.0f, -2.0f};
+  checkNaNPolicyAll<policy>(tiny, policy_name, false);
+}
+
 int main(int argc, char **argv) {
 
-  if (argc < 2) {
+  if (argc < 2 || (std::string(argv[1]) == "--mmap" && argc < 3)) {
     std::cerr << "Usage: ./min-max size-exponent" << std::endl;
-    std::cerr << "Size of the array generated will be 2^(size-exponent)"
+    std::cerr << "       ./min-max --mmap input [--populate]" << std::endl;
+    std::cerr << "Size of the array generated will be 2^(size-exponent); "
+                 "with --mmap the min-max of the floats of input is computed "
+                 "on a mapping of the file"
               << std::endl;
     return 1;
   }
 
+  if (std::string(argv[1]) == "--mmap") {
+    bool populate = argc > 3 && std::string(argv[3]) == "--populate";
+    float min, max;
+    size_t nans;
+    Timer<std::chrono::microseconds> t;
+
+    t.start_timer();
+    int error = minMaxMapped(argv[2], populate, &min, &max, &nans);
+    t.stop_timer();
+    if (error) {
+      std::cerr << argv[2] << ": " << std::strerror(error) << std::endl;
+      return 1;
+    }
+    std::cout << "min " << min << " max " << max << " NaNs " << nans
+              << std::endl;
+    std::cout << "Elapsed time " << minMaxMappedName
+              << (populate ? " populate" : "") << " : " << t.time_elapsed()
+              << std::endl;
+    return 0;
+  }
+
   int exponent = std::atoi(argv[1]);
   const size_t N = std::pow(2, exponent);
 
@@ -71,8 +492,9 @@ int main(int argc, char **argv) {
 
   float minExpected = FLT_MAX, maxExpected = FLT_MIN;
   {
+    size_t nans;
     t.start_timer();
-    minMaxGolden(arr, minExpected, maxExpected);
+    minMaxGolden(arr, minExpected, maxExpected, nans);
     t.stop_timer();
     std::cout << "Elapsed time golden : " << t.time_elapsed() << std::endl;
   }
@@ -85,8 +507,8 @@ int main(int argc, char **argv) {
     t.stop_timer();
     std::cout << "Elapsed time openmp : " << t.time_elapsed() << std::endl;
 
-    assertFloat(maxExpected, maxActual, "maxopenmp");
-    assertFloat(minExpected, minActual, "minopenmp");
+    assertFloat(maxExpected, maxActual, "maxopenmp", FloatCheck::exact());
+    assertFloat(minExpected, minActual, "minopenmp", FloatCheck::exact());
     std::cout << "Assertion is successful for openmp" << std::endl;
   }
 
@@ -98,8 +520,8 @@ int main(int argc, char **argv) {
     t.stop_timer();
     std::cout << "Elapsed time SIMD SSE : " << t.time_elapsed() << std::endl;
 
-    assertFloat(maxExpected, maxActual, "maxSSE");
-    assertFloat(minExpected, minActual, "minSSE");
+    assertFloat(maxExpected, maxActual, "maxSSE", FloatCheck::exact());
+    assertFloat(minExpected, minActual, "minSSE", FloatCheck::exact());
     std::cout << "Assertion is successful for SSE" << std::endl;
   }
 
@@ -111,12 +533,12 @@ int main(int argc, char **argv) {
     t.stop_timer();
     std::cout << "Elapsed time SIMD SSE+openmp : " << t.time_elapsed() << std::endl;
 
-    assertFloat(maxExpected, maxActual, "maxSSEOMP");
-    assertFloat(minExpected, minActual, "minSSEOMP");
+    assertFloat(maxExpected, maxActual, "maxSSEOMP", FloatCheck::exact());
+    assertFloat(minExpected, minActual, "minSSEOMP", FloatCheck::exact());
     std::cout << "Assertion is successful for SSE+openmp" << std::endl;
   }
 
-#ifdef __AVX__
+#ifdef __AVX2__
   {
     float minActual = FLT_MAX, maxActual = FLT_MIN;
 
@@ -125,8 +547,8 @@ int main(int argc, char **argv) {
     t.stop_timer();
     std::cout << "Elapsed time SIMD AVX : " << t.time_elapsed() << std::endl;
 
-    assertFloat(maxExpected, maxActual, "maxAVX");
-    assertFloat(minExpected, minActual, "minAVX");
+    assertFloat(maxExpected, maxActual, "maxAVX", FloatCheck::exact());
+    assertFloat(minExpected, minActual, "minAVX", FloatCheck::exact());
     std::cout << "Assertion is successful for AVX" << std::endl;
   }
 
@@ -138,9 +560,181 @@ int main(int argc, char **argv) {
     t.stop_timer();
     std::cout << "Elapsed time SIMD AVX+openmp : " << t.time_elapsed() << std::endl;
 
-    assertFloat(maxExpected, maxActual, "maxAVXOMP");
-    assertFloat(minExpected, minActual, "minAVXOMP");
+    assertFloat(maxExpected, maxActual, "maxAVXOMP", FloatCheck::exact());
+    assertFloat(minExpected, minActual, "minAVXOMP", FloatCheck::exact());
     std::cout << "Assertion is successful for AVX+openmp" << std::endl;
   }
 #endif
-}
+
+#ifdef __AVX512F__
+  {
+    float minActual = FLT_MAX, maxActual = FLT_MIN;
+
+    t.start_timer();
+    minMaxAVX512(arr.data(), N, &minActual, &maxActual);
+    t.stop_timer();
+    std::cout << "Elapsed time SIMD AVX512 : " << t.time_elapsed() << std::endl;
+
+    assertFloat(maxExpected, maxActual, "maxAVX512", FloatCheck::exact());
+    assertFloat(minExpected, minActual, "minAVX512", FloatCheck::exact());
+    std::cout << "Assertion is successful for AVX512" << std::endl;
+  }
+
+  {
+    float minActual = FLT_MAX, maxActual = FLT_MIN;
+
+    t.start_timer();
+    minMaxAVX512OMP(arr.data(), N, &minActual, &maxActual);
+    t.stop_timer();
+    std::cout << "Elapsed time SIMD AVX512+openmp : " << t.time_elapsed()
+              << std::endl;
+
+    assertFloat(maxExpected, maxActual, "maxAVX512OMP", FloatCheck::exact());
+    assertFloat(minExpected, minActual, "minAVX512OMP", FloatCheck::exact());
+    std::cout << "Assertion is successful for AVX512+openmp" << std::endl;
+  }
+#endif
+
+#ifdef SIMD_NEON
+  {
+    float minActual = FLT_MAX, maxActual = FLT_MIN;
+
+    t.start_timer();
+    minMaxNEON(arr.data(), N, &minActual, &maxActual);
+    t.stop_timer();
+    std::cout << "Elapsed time SIMD NEON : " << t.time_elapsed() << std::endl;
+
+    assertFloat(maxExpected, maxActual, "maxNEON", FloatCheck::exact());
+    assertFloat(minExpected, minActual, "minNEON", FloatCheck::exact());
+    std::cout << "Assertion is successful for NEON" << std::endl;
+  }
+
+  {
+    float minActual = FLT_MAX, maxActual = FLT_MIN;
+
+    t.start_timer();
+    minMaxNEONOMP(arr.data(), N, &minActual, &maxActual);
+    t.stop_timer();
+    std::cout << "Elapsed time SIMD NEON+openmp : " << t.time_elapsed()
+              << std::endl;
+
+    assertFloat(maxExpected, maxActual, "maxNEONOMP", FloatCheck::exact());
+    assertFloat(minExpected, minActual, "minNEONOMP", FloatCheck::exact());
+    std::cout << "Assertion is successful for NEON+openmp" << std::endl;
+  }
+#endif
+
+#ifdef SIMD_SVE
+  {
+    float minActual = FLT_MAX, maxActual = FLT_MIN;
+
+    t.start_timer();
+    minMaxSVE(arr.data(), N, &minActual, &maxActual);
+    t.stop_timer();
+    std::cout << "Elapsed time SIMD SVE : " << t.time_elapsed() << std::endl;
+
+    assertFloat(maxExpected, maxActual, "maxSVE", FloatCheck::exact());
+    assertFloat(minExpected, minActual, "minSVE", FloatCheck::exact());
+    std::cout << "Assertion is successful for SVE" << std::endl;
+  }
+
+  {
+    float minActual = FLT_MAX, maxActual = FLT_MIN;
+
+    t.start_timer();
+    minMaxSVEOMP(arr.data(), N, &minActual, &maxActual);
+    t.stop_timer();
+    std::cout << "Elapsed time SIMD SVE+openmp : " << t.time_elapsed()
+              << std::endl;
+
+    assertFloat(maxExpected, maxActual, "maxSVEOMP", FloatCheck::exact());
+    assertFloat(minExpected, minActual, "minSVEOMP", FloatCheck::exact());
+    std::cout << "Assertion is successful for SVE+openmp" << std::endl;
+  }
+#endif
+
+  // NaN sentinels, including one in the very first element
+  {
+    std::vector<float> arrNaN = arr;
+    for (size_t i = 0; i < N; i += 1021) {
+      arrNaN[i] = NAN;
+    }
+
+    checkNaNPolicyAll<NaNPolicy::Ignore>(arrNaN, "ignore", true);
+    checkNaNPolicyAll<NaNPolicy::Propagate>(arrNaN, "propagate", true);
+    checkNaNPolicyAll<NaNPolicy::MinNum>(arrNaN, "minnum", true);
+
+    checkNaNPolicyEdgeCases<NaNPolicy::Ignore>("ignore");
+    checkNaNPolicyEdgeCases<NaNPolicy::Propagate>("propagate");
+    checkNaNPolicyEdgeCases<NaNPolicy::MinNum>("minnum");
+    std::cout << "Assertion is successful for NaN policies" << std::endl;
+  }
+
+  // Many columns of different lengths, with NaNs
+  {
+    std::vector<float> arrNaN = arr;
+    for (size_t i = 0; i < N; i += 1021) {
+      arrNaN[i] = NAN;
+    }
+    checkBatchAll(arrNaN, true);
+    std::cout << "Assertion is successful for batches" << std::endl;
+  }
+
+  // Validity bitmaps with scattered nulls and with whole words of nulls;
+  // the nulls hold values beyond the range of the valid elements
+  {
+    std::vector<float> arrNull = arr;
+    for (size_t i = 0; i < N; i += 1021) {
+      arrNull[i] = NAN;
+    }
+    for (size_t i = 1; i < N; i += 97) {
+      arrNull[i] = i % 2 ? 1e30f : -1e30f;
+    }
+    std::vector<uint8_t> validity = makeValidity(N, 0.0, false, 1);
+    for (size_t i = 1; i < N; i += 97) {
+      validity[i / 8] &= ~(1 << (i % 8));
+    }
+    checkMaskedAll<NaNPolicy::Ignore>(arrNull, validity, "1% nulls", true);
+    validity = makeValidity(N, 0.5, false, 2);
+    checkMaskedAll<NaNPolicy::Ignore>(arrNull, validity, "50% nulls", true);
+    validity = makeValidity(N, 0.9, true, 3);
+    checkMaskedAll<NaNPolicy::Ignore>(arrNull, validity, "90% null words",
+                                      true);
+
+    // Every length around a word, with signed zeros, all nulls and no
+    // bitmap at all
+    const float values[] = {0.0f, -0.0f, NAN, 1.0f, -1.0f};
+    std::mt19937 gen(4);
+    for (size_t n = 0; n <= 200; n++) {
+      std::vector<float> small(n);
+      for (size_t i = 0; i < n; i++) {
+        small[i] = values[gen() % 5];
+      }
+      for (double null_rate : {0.0, 0.3, 1.0}) {
+        validity = makeValidity(n, null_rate, false, n);
+        checkMaskedAll<NaNPolicy::Ignore>(small, validity, "ignore", false);
+        checkMaskedAll<NaNPolicy::Propagate>(small, validity, "propagate",
+                                             false);
+        checkMaskedAll<NaNPolicy::MinNum>(small, validity, "minnum", false);
+      }
+    }
+    float min, max, minExpected, maxExpected;
+    size_t nans, nansExpected;
+    minMaxMaskedAuto<NaNPolicy::MinNum>(arrNull.data(), nullptr, N, &min, &max,
+                                        &nans);
+    minMaxAuto<NaNPolicy::MinNum>(arrNull.data(), N, &minExpected,
+                                  &maxExpected, &nansExpected);
+    assertFloat(minExpected, min, "min no bitmap", FloatCheck::exact());
+    assertFloat(maxExpected, max, "max no bitmap", FloatCheck::exact());
+    assertInt(nansExpected, nans, "nans no bitmap");
+    std::cout << "Assertion is successful for validity bitmaps" << std::endl;
+  }
+
+  // The same array read from a file mapping, and an empty file
+  {
+    checkMapped(arr, false, true);
+    checkMapped(arr, true, true);
+    checkMapped({}, false, false);
+    std::cout << "Assertion is successful for mmap" << std::endl;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "helpers.hpp"
+#include "simd.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+/*
+"Golden" algorithm for min-max normalization: a scalar min-max pass followed
+by a scalar rescale of "arr" to [0, 1] into "out", computed exactly like the
+SIMD kernels so that the results agree bit for bit.
+*/
+void normalizeGolden(const std::vector<float> &arr, std::vector<float> &out) {
+  float min = INFINITY, max = -INFINITY;
+  for (size_t i = 0; i < arr.size(); i++) {
+    if (arr[i] < min) {
+      min = arr[i];
+    }
+    if (arr[i] > max) {
+      max = arr[i];
+    }
+  }
+
+  float inv_range = normalizeScale(min, max);
+  for (size_t i = 0; i < arr.size(); i++) {
+    float x = (arr[i] - min) * inv_range;
+    out[i] = x > 1.0f ? 1.0f : x;
+  }
+}
+
+typedef void (*NormalizeKernel)(float const *, size_t, float *);
+
+Timer<std::chrono::microseconds> t;
+
+// Runs "kernel" on "arr", prints its time and checks it against "expected"
+void checkNormalize(const std::vector<float> &arr,
+                    const std::vector<float> &expected,
+                    NormalizeKernel kernel, std::string name) {
+  std::vector<float> actual(arr.size());
+
+  t.start_timer();
+  kernel(arr.data(), arr.size(), actual.data());
+  t.stop_timer();
+  std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+            << std::endl;
+
+  assertArray(expected.data(), actual.data(), arr.size(), FloatCheck::exact(),
+              name);
+}
+
+// Checks every normalization kernel against the golden algorithm
+void checkNormalizeAll(const std::vector<float> &arr, bool print_time) {
+  std::vector<float> expected(arr.size());
+  normalizeGolden(arr, expected);
+
+  NormalizeKernel kernels[] = {
+      normalizeSSE,        normalizeSSEBlocked,    normalizeSSEOMP,
+#ifdef __AVX2__
+      normalizeAVX,        normalizeAVXBlocked,    normalizeAVXOMP,
+#endif
+#ifdef __AVX512F__
+      normalizeAVX512,     normalizeAVX512Blocked, normalizeAVX512OMP,
+#endif
+#ifdef SIMD_NEON
+      normalizeNEON,       normalizeNEONBlocked,   normalizeNEONOMP,
+#endif
+  };
+  std::string names[] = {
+      "SIMD SSE",    "SIMD SSE blocked",    "SIMD SSE+openmp",
+#ifdef __AVX2__
+      "SIMD AVX",    "SIMD AVX blocked",    "SIMD AVX+openmp",
+#endif
+#ifdef __AVX512F__
+      "SIMD AVX512", "SIMD AVX512 blocked", "SIMD AVX512+openmp",
+#endif
+#ifdef SIMD_NEON
+      "SIMD NEON",   "SIMD NEON blocked",   "SIMD NEON+openmp",
+#endif
+  };
+
+  for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+    if (print_time) {
+      checkNormalize(arr, expected, kernels[k], names[k]);
+    } else {
+      std::vector<float> actual(arr.size());
+      kernels[k](arr.data(), arr.size(), actual.data());
+      assertArray(expected.data(), actual.data(), arr.size(),
+                  FloatCheck::exact(), names[k]);
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    std::cerr << "Usage: ./normalize size-exponent" << std::endl;
+    std::cerr << "Size of the array generated will be 2^(size-exponent)"
+              << std::endl;
+    return 1;
+  }
+
+  int exponent = std::atoi(argv[1]);
+  const size_t N = std::pow(2, exponent);
+
+  std::vector<float> arr = generateRandomData<float>(N, -10000.0, 10000.0, 10);
+
+  {
+    std::vector<float> expected(N);
+    t.start_timer();
+    normalizeGolden(arr, expected);
+    t.stop_timer();
+    std::cout << "Elapsed time golden : " << t.time_elapsed() << std::endl;
+  }
+
+  // The usual sequence: min-max with SIMD, then a scalar rescale
+  {
+    std::vector<float> out(N);
+    t.start_timer();
+    float min, max;
+    minMaxAuto(arr.data(), N, &min, &max);
+    float inv_range = normalizeScale(min, max);
+    for (size_t i = 0; i < N; i++) {
+      out[i] = (arr[i] - min) * inv_range;
+    }
+    t.stop_timer();
+    std::cout << "Elapsed time SIMD min-max + scalar rescale : "
+              << t.time_elapsed() << std::endl;
+  }
+
+  checkNormalizeAll(arr, true);
+  std::cout << "Assertion is successful for normalize" << std::endl;
+
+  // In place
+  {
+    std::vector<float> expected(N);
+    normalizeGolden(arr, expected);
+    std::vector<float> inplace = arr;
+    normalizeAutoOMP(inplace.data(), N, inplace.data());
+    assertArray(expected.data(), inplace.data(), N, FloatCheck::exact(),
+                "in place");
+  }
+
+  // NaNs, a constant array and fewer elements than one vector
+  {
+    std::vector<float> arrNaN = arr;
+    for (size_t i = 0; i < N; i += 1021) {
+      arrNaN[i] = NAN;
+    }
+    checkNormalizeAll(arrNaN, false);
+    checkNormalizeAll(std::vector<float>(37, 5.0f), false);
+    checkNormalizeAll({3.0f, -2.0f, 7.0f}, false);
+    std::cout << "Assertion is successful for the edge cases" << std::endl;
+  }
+}
@@ -0,0 +1,168 @@
+#include "helpers.hpp"
+#include "simd.h"
+#include <chrono>
+#include <climits>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+/*
+"Golden" algorithm for the inclusive (or exclusive) prefix sum of "arr".
+The float sums are accumulated in double, the int sums in int64_t and
+truncated to int, which wraps them around on overflow as the kernels do.
+*/
+template <typename T, typename Acc>
+void scanGolden(const std::vector<T> &arr, std::vector<T> &out,
+                bool exclusive) {
+  Acc sum = 0;
+  for (size_t i = 0; i < arr.size(); i++) {
+    if (exclusive) {
+      out[i] = T(sum);
+      sum += arr[i];
+    } else {
+      sum += arr[i];
+      out[i] = T(sum);
+    }
+  }
+}
+
+template <typename T>
+using ScanKernel = void (*)(T const *, size_t, T *);
+
+Timer<std::chrono::microseconds> t;
+
+void assertScan(const std::vector<int> &expected,
+                const std::vector<int> &actual, std::string name) {
+  assertArray(expected.data(), actual.data(), expected.size(), name);
+}
+
+/*
+Prefix sums of floats lose precision as the sum grows, whatever the order of
+the additions, so the float results are compared with a relative error.
+*/
+void assertScan(const std::vector<float> &expected,
+                const std::vector<float> &actual, std::string name) {
+  assertArray(expected.data(), actual.data(), expected.size(),
+              FloatCheck::relative(1e-3f, 1e-3f), name);
+}
+
+template <typename T>
+void checkScan(const std::vector<T> &arr, const std::vector<T> &expected,
+               ScanKernel<T> kernel, std::string name, bool print_time) {
+  std::vector<T> actual(arr.size());
+
+  t.start_timer();
+  kernel(arr.data(), arr.size(), actual.data());
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  assertScan(expected, actual, name);
+
+  // In place
+  std::vector<T> inplace = arr;
+  kernel(inplace.data(), inplace.size(), inplace.data());
+  assertScan(expected, inplace, name + " in place");
+}
+
+// Checks every inclusive or exclusive scan kernel against the golden one
+template <typename T, typename Acc>
+void checkScanAll(const std::vector<T> &arr, bool exclusive, std::string type,
+                  bool print_time) {
+  std::vector<T> expected(arr.size());
+  scanGolden<T, Acc>(arr, expected, exclusive);
+
+  if (print_time) {
+    std::vector<T> out(arr.size());
+    t.start_timer();
+    scanGolden<T, Acc>(arr, out, exclusive);
+    t.stop_timer();
+    std::cout << "Elapsed time golden " << type << " : " << t.time_elapsed()
+              << std::endl;
+
+    t.start_timer();
+    // With the wrapping int sum of the kernels
+    auto add = [](T a, T b) { return scanAdd(a, b); };
+    if (exclusive) {
+      std::exclusive_scan(arr.begin(), arr.end(), out.begin(), T(0), add);
+    } else {
+      std::inclusive_scan(arr.begin(), arr.end(), out.begin(), add);
+    }
+    t.stop_timer();
+    std::cout << "Elapsed time std " << type << " : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  ScanKernel<T> kernels[] = {
+      exclusive ? exclusiveScanSSE<T> : inclusiveScanSSE<T>,
+      exclusive ? exclusiveScanSSEOMP<T> : inclusiveScanSSEOMP<T>,
+#ifdef __AVX2__
+      exclusive ? exclusiveScanAVX2<T> : inclusiveScanAVX2<T>,
+      exclusive ? exclusiveScanAVX2OMP<T> : inclusiveScanAVX2OMP<T>,
+#endif
+#ifdef __AVX512F__
+      exclusive ? exclusiveScanAVX512<T> : inclusiveScanAVX512<T>,
+      exclusive ? exclusiveScanAVX512OMP<T> : inclusiveScanAVX512OMP<T>,
+#endif
+#ifdef SIMD_NEON
+      exclusive ? exclusiveScanNEON<T> : inclusiveScanNEON<T>,
+      exclusive ? exclusiveScanNEONOMP<T> : inclusiveScanNEONOMP<T>,
+#endif
+  };
+  std::string names[] = {
+      "SIMD SSE",    "SIMD SSE+openmp",
+#ifdef __AVX2__
+      "SIMD AVX",    "SIMD AVX+openmp",
+#endif
+#ifdef __AVX512F__
+      "SIMD AVX512", "SIMD AVX512+openmp",
+#endif
+#ifdef SIMD_NEON
+      "SIMD NEON",   "SIMD NEON+openmp",
+#endif
+  };
+
+  for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+    checkScan(arr, expected, kernels[k], names[k] + " " + type, print_time);
+  }
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    std::cerr << "Usage: ./scan size-exponent" << std::endl;
+    std::cerr << "Size of the array generated will be 2^(size-exponent)"
+              << std::endl;
+    return 1;
+  }
+
+  int exponent = std::atoi(argv[1]);
+  const size_t N = std::pow(2, exponent);
+
+  // Offsets: small non-negative counts
+  std::vector<int> arrInt = generateRandomData<int>(N, 0, 100, 2);
+  checkScanAll<int, int64_t>(arrInt, false, "inclusive int", true);
+  checkScanAll<int, int64_t>(arrInt, true, "exclusive int", true);
+  std::cout << "Assertion is successful for int scans" << std::endl;
+
+  std::vector<float> arr = generateRandomData<float>(N, 0.0, 1.0, 10);
+  checkScanAll<float, double>(arr, false, "inclusive", true);
+  checkScanAll<float, double>(arr, true, "exclusive", true);
+  std::cout << "Assertion is successful for float scans" << std::endl;
+
+  // Fewer elements than one vector, and a length that leaves a remainder
+  checkScanAll<int, int64_t>({3, -2, 7}, false, "inclusive int", false);
+  checkScanAll<int, int64_t>(std::vector<int>(scanBlock + 37, 1), true,
+                             "exclusive int", false);
+  // Sums past INT_MAX, in the remainder, within blocks and across them
+  checkScanAll<int, int64_t>({1, 1, 1, 1, INT_MAX}, false, "inclusive int",
+                             false);
+  const size_t n = 2 * scanBlock + 5;
+  checkScanAll<int, int64_t>(std::vector<int>(n, INT_MAX / 1000), false,
+                             "inclusive int", false);
+  checkScanAll<int, int64_t>(std::vector<int>(n, INT_MIN / 999), true,
+                             "exclusive int", false);
+  std::cout << "Assertion is successful for the edge cases" << std::endl;
+}
@@ -0,0 +1,241 @@
+#include "helpers.hpp"
+#include "simd.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+Timer<std::chrono::microseconds> t;
+
+template <typename T>
+using FindKernel = size_t (*)(T const *, size_t, Greater<T>);
+template <typename T> using CountKernel = size_t (*)(T const *, size_t, T);
+template <typename T> using LowerBoundKernel = size_t (*)(T const *, size_t, T);
+
+// Runs "kernel" for the first element above threshold and checks it
+template <typename T>
+void checkFindFirst(const std::vector<T> &arr, T threshold,
+                    FindKernel<T> kernel, std::string name, bool print_time) {
+  size_t expected =
+      std::find_if(arr.begin(), arr.end(), [=](T x) { return x > threshold; }) -
+      arr.begin();
+
+  t.start_timer();
+  size_t actual = kernel(arr.data(), arr.size(), Greater<T>{threshold});
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+              << std::endl;
+  }
+  assertInt(expected, actual, name);
+}
+
+template <typename T>
+void checkCountEq(const std::vector<T> &arr, T x, CountKernel<T> kernel,
+                  std::string name, bool print_time) {
+  size_t expected = std::count(arr.begin(), arr.end(), x);
+
+  t.start_timer();
+  size_t actual = kernel(arr.data(), arr.size(), x);
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+              << std::endl;
+  }
+  assertInt(expected, actual, name);
+}
+
+// Looks up every query in the sorted array with "kernel"
+template <typename T>
+void checkLowerBound(const std::vector<T> &sorted,
+                     const std::vector<T> &queries,
+                     const std::vector<size_t> &expected,
+                     LowerBoundKernel<T> kernel, std::string name,
+                     bool print_time) {
+  std::vector<size_t> actual(queries.size());
+  t.start_timer();
+  for (size_t q = 0; q < queries.size(); q++) {
+    actual[q] = kernel(sorted.data(), sorted.size(), queries[q]);
+  }
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+              << std::endl;
+  }
+  for (size_t q = 0; q < queries.size(); q++) {
+    assertInt(expected[q], actual[q], name + " query " + std::to_string(q));
+  }
+}
+
+template <typename Tree, typename T>
+void checkSearchTree(const std::vector<T> &sorted,
+                     const std::vector<T> &queries,
+                     const std::vector<size_t> &expected, std::string name,
+                     bool print_time) {
+  t.start_timer();
+  Tree tree(sorted.data(), sorted.size());
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " build : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  std::vector<size_t> actual(queries.size());
+  t.start_timer();
+  for (size_t q = 0; q < queries.size(); q++) {
+    actual[q] = tree.lowerBound(queries[q]);
+  }
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+              << std::endl;
+  }
+  for (size_t q = 0; q < queries.size(); q++) {
+    assertInt(expected[q], actual[q], name + " query " + std::to_string(q));
+  }
+}
+
+/*
+Checks the lower_bound kernels and search trees on "arr", once sorted,
+against std::lower_bound, for queries within and beyond its range.
+*/
+template <typename T>
+void checkLowerBoundAll(std::vector<T> arr, std::string type,
+                        bool print_time) {
+  std::sort(arr.begin(), arr.end());
+  std::vector<T> queries(1 << 16);
+  std::mt19937 gen(5);
+  std::uniform_int_distribution<int> dist(-11000, 11000);
+  // Half of the queries are elements of the array
+  for (size_t q = 0; q < queries.size(); q++) {
+    queries[q] = q % 2 && !arr.empty() ? arr[gen() % arr.size()] : dist(gen);
+  }
+
+  std::vector<size_t> expected(queries.size());
+  t.start_timer();
+  for (size_t q = 0; q < queries.size(); q++) {
+    expected[q] =
+        std::lower_bound(arr.begin(), arr.end(), queries[q]) - arr.begin();
+  }
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time std::lower_bound " << type << " : "
+              << t.time_elapsed() << std::endl;
+  }
+
+  checkLowerBound(arr, queries, expected, lowerBoundSSE<T>,
+                  "SIMD SSE lower_bound " + type, print_time);
+  checkSearchTree<SearchTreeSSE<T>>(arr, queries, expected,
+                                    "SIMD SSE tree " + type, print_time);
+#ifdef __AVX2__
+  checkLowerBound(arr, queries, expected, lowerBoundAVX2<T>,
+                  "SIMD AVX lower_bound " + type, print_time);
+  checkSearchTree<SearchTreeAVX2<T>>(arr, queries, expected,
+                                     "SIMD AVX tree " + type, print_time);
+#endif
+#ifdef __AVX512F__
+  checkLowerBound(arr, queries, expected, lowerBoundAVX512<T>,
+                  "SIMD AVX512 lower_bound " + type, print_time);
+  checkSearchTree<SearchTreeAVX512<T>>(arr, queries, expected,
+                                       "SIMD AVX512 tree " + type, print_time);
+#endif
+#ifdef SIMD_NEON
+  checkLowerBound(arr, queries, expected, lowerBoundNEON<T>,
+                  "SIMD NEON lower_bound " + type, print_time);
+  checkSearchTree<SearchTreeNEON<T>>(arr, queries, expected,
+                                     "SIMD NEON tree " + type, print_time);
+#endif
+}
+
+// Checks the find-first and count kernels
+template <typename T>
+void checkFindCountAll(const std::vector<T> &arr, T threshold, T x,
+                       std::string type, bool print_time) {
+  if (print_time) {
+    t.start_timer();
+    size_t first =
+        std::find_if(arr.begin(), arr.end(),
+                     [=](T y) { return y > threshold; }) -
+        arr.begin();
+    t.stop_timer();
+    std::cout << "Elapsed time golden find first " << type << " : "
+              << t.time_elapsed() << " (index " << first << ")" << std::endl;
+
+    t.start_timer();
+    size_t count = std::count(arr.begin(), arr.end(), x);
+    t.stop_timer();
+    std::cout << "Elapsed time golden count " << type << " : "
+              << t.time_elapsed() << " (count " << count << ")" << std::endl;
+  }
+
+  checkFindFirst(arr, threshold, findFirstSSE<T, Greater<T>>,
+                 "SIMD SSE find first " + type, print_time);
+  checkCountEq(arr, x, countEqSSE<T>, "SIMD SSE count " + type, print_time);
+  checkCountEq(arr, x, countEqSSEOMP<T>, "SIMD SSE+openmp count " + type,
+               print_time);
+#ifdef __AVX2__
+  checkFindFirst(arr, threshold, findFirstAVX2<T, Greater<T>>,
+                 "SIMD AVX find first " + type, print_time);
+  checkCountEq(arr, x, countEqAVX2<T>, "SIMD AVX count " + type, print_time);
+  checkCountEq(arr, x, countEqAVX2OMP<T>, "SIMD AVX+openmp count " + type,
+               print_time);
+#endif
+#ifdef __AVX512F__
+  checkFindFirst(arr, threshold, findFirstAVX512<T, Greater<T>>,
+                 "SIMD AVX512 find first " + type, print_time);
+  checkCountEq(arr, x, countEqAVX512<T>, "SIMD AVX512 count " + type,
+               print_time);
+  checkCountEq(arr, x, countEqAVX512OMP<T>, "SIMD AVX512+openmp count " + type,
+               print_time);
+#endif
+#ifdef SIMD_NEON
+  checkFindFirst(arr, threshold, findFirstNEON<T, Greater<T>>,
+                 "SIMD NEON find first " + type, print_time);
+  checkCountEq(arr, x, countEqNEON<T>, "SIMD NEON count " + type, print_time);
+  checkCountEq(arr, x, countEqNEONOMP<T>, "SIMD NEON+openmp count " + type,
+               print_time);
+#endif
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    std::cerr << "Usage: ./search size-exponent" << std::endl;
+    std::cerr << "Size of the array generated will be 2^(size-exponent)"
+              << std::endl;
+    return 1;
+  }
+
+  int exponent = std::atoi(argv[1]);
+  const size_t N = std::pow(2, exponent);
+
+  // The first element above the threshold is three quarters of the way in
+  std::vector<int> arrInt = generateRandomData<int>(N, -10000, 10000, 2);
+  arrInt[N * 3 / 4] = 20000;
+  checkFindCountAll(arrInt, 15000, 42, "int", true);
+  checkLowerBoundAll(arrInt, "int", true);
+  std::cout << "Assertion is successful for int search" << std::endl;
+
+  std::vector<float> arr = generateRandomData<float>(N, -10000.0, 10000.0, 10);
+  arr[N * 3 / 4] = 20000.0f;
+  checkFindCountAll(arr, 15000.0f, arr[N / 2], "float", true);
+  checkLowerBoundAll(arr, "float", true);
+  std::cout << "Assertion is successful for float search" << std::endl;
+
+  // Nothing found, every size up to a few vectors, and duplicates
+  {
+    checkFindCountAll(arrInt, 30000, 30000, "int", false);
+    std::mt19937 gen(6);
+    std::uniform_int_distribution<int> dist(-3, 3);
+    for (size_t n = 0; n <= 70; n++) {
+      std::vector<int> small(n);
+      for (size_t i = 0; i < n; i++) {
+        small[i] = dist(gen);
+      }
+      checkFindCountAll(small, 2, 1, "int " + std::to_string(n), false);
+      checkLowerBoundAll(small, "int " + std::to_string(n), false);
+    }
+    std::cout << "Assertion is successful for the edge cases" << std::endl;
+  }
+}
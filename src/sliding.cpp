@@ -0,0 +1,163 @@
+#include "helpers.hpp"
+#include "simd.h"
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <vector>
+
+Timer<std::chrono::microseconds> t;
+
+/*
+"Golden" algorithm: the monotonic deque. It holds the indices of the window
+whose elements are below (above) every later one, so the front is the min
+(max) of the window; each index is pushed and popped once.
+*/
+template <bool is_max, typename T>
+void slidingGolden(const std::vector<T> &arr, size_t w, std::vector<T> &out) {
+  std::deque<size_t> window;
+  for (size_t i = 0; i < arr.size(); i++) {
+    while (!window.empty() && (is_max ? arr[window.back()] <= arr[i]
+                                      : arr[window.back()] >= arr[i])) {
+      window.pop_back();
+    }
+    window.push_back(i);
+    if (window.front() + w <= i) {
+      window.pop_front();
+    }
+    if (i + 1 >= w) {
+      out[i + 1 - w] = arr[window.front()];
+    }
+  }
+}
+
+// The windows must match bit for bit
+void assertArray(const float *expected, const float *actual, size_t N,
+                 std::string str) {
+  assertArray(expected, actual, N, FloatCheck::exact(), str);
+}
+
+template <typename T>
+using SlidingKernel = void (*)(T const *, size_t, size_t, T *);
+
+// Runs "kernel" for windows of w elements and checks it against the deque
+template <bool is_max, typename T>
+void checkSliding(const std::vector<T> &arr, size_t w,
+                  const std::vector<T> &expected, SlidingKernel<T> kernel,
+                  std::string name, bool print_time) {
+  size_t windows = w == 0 || w > arr.size() ? 0 : arr.size() - w + 1;
+  // One more element, which no kernel may write
+  std::vector<T> actual(windows + 1, T(42));
+
+  t.start_timer();
+  kernel(arr.data(), arr.size(), w, actual.data());
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+              << std::endl;
+  }
+  assertArray(expected.data(), actual.data(), windows, name);
+  assertInt(size_t(1), size_t(actual[windows] == T(42)), name + " end");
+}
+
+template <bool is_max, typename T>
+void checkSlidingAll(const std::vector<T> &arr, size_t w, std::string type,
+                     bool print_time) {
+  std::string kind = std::string(is_max ? " max " : " min ") + type + " w=" +
+                     std::to_string(w);
+  size_t windows = w == 0 || w > arr.size() ? 0 : arr.size() - w + 1;
+  std::vector<T> expected(windows);
+  t.start_timer();
+  if (w > 0) {
+    slidingGolden<is_max>(arr, w, expected);
+  }
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time deque" << kind << " : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  checkSliding<is_max, T>(
+      arr, w, expected, is_max ? slidingMaxSSE<T> : slidingMinSSE<T>,
+      "SIMD SSE" + kind, print_time);
+  checkSliding<is_max, T>(
+      arr, w, expected, is_max ? slidingMaxSSEOMP<T> : slidingMinSSEOMP<T>,
+      "SIMD SSE+openmp" + kind, print_time);
+#ifdef __AVX2__
+  checkSliding<is_max, T>(
+      arr, w, expected, is_max ? slidingMaxAVX2<T> : slidingMinAVX2<T>,
+      "SIMD AVX" + kind, print_time);
+  checkSliding<is_max, T>(
+      arr, w, expected, is_max ? slidingMaxAVX2OMP<T> : slidingMinAVX2OMP<T>,
+      "SIMD AVX+openmp" + kind, print_time);
+#endif
+#ifdef __AVX512F__
+  checkSliding<is_max, T>(
+      arr, w, expected, is_max ? slidingMaxAVX512<T> : slidingMinAVX512<T>,
+      "SIMD AVX512" + kind, print_time);
+  checkSliding<is_max, T>(
+      arr, w, expected,
+      is_max ? slidingMaxAVX512OMP<T> : slidingMinAVX512OMP<T>,
+      "SIMD AVX512+openmp" + kind, print_time);
+#endif
+#ifdef SIMD_NEON
+  checkSliding<is_max, T>(
+      arr, w, expected, is_max ? slidingMaxNEON<T> : slidingMinNEON<T>,
+      "SIMD NEON" + kind, print_time);
+  checkSliding<is_max, T>(
+      arr, w, expected, is_max ? slidingMaxNEONOMP<T> : slidingMinNEONOMP<T>,
+      "SIMD NEON+openmp" + kind, print_time);
+#endif
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    std::cerr << "Usage: ./sliding size-exponent" << std::endl;
+    std::cerr << "Size of the array generated will be 2^(size-exponent)"
+              << std::endl;
+    return 1;
+  }
+
+  int exponent = std::atoi(argv[1]);
+  const size_t N = std::pow(2, exponent);
+
+  std::vector<float> arr = generateRandomData<float>(N, -10000.0, 10000.0, 10);
+  std::vector<int> arrInt = generateRandomData<int>(N, -10000, 10000, 2);
+
+  for (size_t w : {4, 16, 64, 256, 4096, 65536}) {
+    checkSlidingAll<false>(arr, w, "float", true);
+    checkSlidingAll<true>(arr, w, "float", false);
+    checkSlidingAll<false>(arrInt, w, "int", true);
+    checkSlidingAll<true>(arrInt, w, "int", false);
+  }
+  std::cout << "Assertion is successful for sliding windows" << std::endl;
+
+  // Every window length of short arrays, around the vector widths and the
+  // direct loop, with runs of equal elements
+  {
+    std::mt19937 gen(9);
+    for (size_t n : {size_t(0), size_t(1), size_t(5), size_t(37), size_t(70),
+                     size_t(300)}) {
+      std::vector<int> small(n);
+      for (size_t i = 0; i < n; i++) {
+        small[i] = int(gen() % 7) - 3;
+      }
+      std::vector<float> smallFloat(small.begin(), small.end());
+      for (size_t w = 0; w <= std::min(n + 1, size_t(80)); w++) {
+        checkSlidingAll<false>(small, w, "int", false);
+        checkSlidingAll<true>(small, w, "int", false);
+        checkSlidingAll<false>(smallFloat, w, "float", false);
+        checkSlidingAll<true>(smallFloat, w, "float", false);
+      }
+    }
+    // Windows of several chunks
+    std::vector<int> part(arrInt.begin(),
+                          arrInt.begin() + std::min(N, size_t(100000)));
+    for (size_t w : {size_t(9), size_t(1000), size_t(20000)}) {
+      checkSlidingAll<false>(part, w, "int", false);
+      checkSlidingAll<true>(part, w, "int", false);
+    }
+    std::cout << "Assertion is successful for the edge cases" << std::endl;
+  }
+}
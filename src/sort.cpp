@@ -0,0 +1,152 @@
+#include "helpers.hpp"
+#include "simd.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <iostream>
+#include <random>
+#include <vector>
+#ifdef HAVE_TBB
+#include <execution>
+#endif
+
+template <typename T> using SortKernel = void (*)(T *, size_t);
+
+// Sorted floats are the same numbers, so they must match bit for bit
+void assertArray(const float *expected, const float *actual, size_t N,
+                 std::string str) {
+  assertArray(expected, actual, N, FloatCheck::exact(), str);
+}
+
+Timer<std::chrono::microseconds> t;
+
+// Checks every sort kernel against std::sort, timing them if print_time
+template <typename T>
+void checkSortAll(const std::vector<T> &arr, std::string type,
+                  bool print_time) {
+  std::vector<T> expected = arr;
+  t.start_timer();
+  std::sort(expected.begin(), expected.end());
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time std::sort " << type << " : "
+              << t.time_elapsed() << std::endl;
+  }
+
+#ifdef HAVE_TBB
+  if (print_time) {
+    std::vector<T> actual = arr;
+    t.start_timer();
+    std::sort(std::execution::par, actual.begin(), actual.end());
+    t.stop_timer();
+    std::cout << "Elapsed time std::sort par " << type << " : "
+              << t.time_elapsed() << std::endl;
+  }
+#endif
+
+  SortKernel<T> kernels[] = {
+      sortSSE<T>,    sortSSEOMP<T>,
+#ifdef __AVX2__
+      sortAVX2<T>,   sortAVX2OMP<T>,
+#endif
+#ifdef __AVX512F__
+      sortAVX512<T>, sortAVX512OMP<T>,
+#endif
+#ifdef SIMD_NEON
+      sortNEON<T>,   sortNEONOMP<T>,
+#endif
+  };
+  std::string names[] = {
+      "SIMD SSE",    "SIMD SSE+openmp",
+#ifdef __AVX2__
+      "SIMD AVX",    "SIMD AVX+openmp",
+#endif
+#ifdef __AVX512F__
+      "SIMD AVX512", "SIMD AVX512+openmp",
+#endif
+#ifdef SIMD_NEON
+      "SIMD NEON",   "SIMD NEON+openmp",
+#endif
+  };
+
+  for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+    std::vector<T> actual = arr;
+    t.start_timer();
+    kernels[k](actual.data(), actual.size());
+    t.stop_timer();
+    if (print_time) {
+      std::cout << "Elapsed time " << names[k] << " " << type << " : "
+                << t.time_elapsed() << std::endl;
+    }
+    assertArray(expected.data(), actual.data(), arr.size(),
+                names[k] + " " + type);
+  }
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    std::cerr << "Usage: ./sort size-exponent" << std::endl;
+    std::cerr << "Size of the array generated will be 2^(size-exponent)"
+              << std::endl;
+    return 1;
+  }
+
+  int exponent = std::atoi(argv[1]);
+  const size_t N = std::pow(2, exponent);
+
+  std::vector<float> arr = generateRandomData<float>(N, -10000.0, 10000.0, 10);
+  checkSortAll(arr, "float", true);
+  std::cout << "Assertion is successful for float sort" << std::endl;
+
+  // Few distinct values, then the full int range
+  std::vector<int> arrInt = generateRandomData<int>(N, -10000, 10000, 2);
+  checkSortAll(arrInt, "int", true);
+  {
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> dist(INT_MIN, INT_MAX);
+    for (size_t i = 0; i < N; i++) {
+      arrInt[i] = dist(gen);
+    }
+  }
+  checkSortAll(arrInt, "int full range", true);
+  std::cout << "Assertion is successful for int sort" << std::endl;
+
+  // Every size up to a few vectors, sorted, reversed and constant arrays,
+  // the extreme values, and infinities
+  {
+    std::mt19937 gen(4);
+    std::uniform_int_distribution<int> dist(-5, 5);
+    for (size_t n = 0; n <= 100; n++) {
+      std::vector<int> small(n);
+      for (size_t i = 0; i < n; i++) {
+        small[i] = dist(gen);
+      }
+      checkSortAll(small, "int " + std::to_string(n), false);
+    }
+
+    std::vector<int> sorted(3 * sortBlock + 37);
+    for (size_t i = 0; i < sorted.size(); i++) {
+      sorted[i] = i;
+    }
+    checkSortAll(sorted, "int sorted", false);
+    std::reverse(sorted.begin(), sorted.end());
+    checkSortAll(sorted, "int reversed", false);
+    checkSortAll(std::vector<int>(1000, 7), "int constant", false);
+
+    std::vector<int> extremes(1000);
+    for (size_t i = 0; i < extremes.size(); i++) {
+      extremes[i] = i % 3 == 0 ? INT_MIN : i % 3 == 1 ? INT_MAX : 0;
+    }
+    checkSortAll(extremes, "int extremes", false);
+
+    std::vector<float> infinities(arr.begin(),
+                                  arr.begin() + std::min(N, size_t(999)));
+    for (size_t i = 0; i < infinities.size(); i += 3) {
+      infinities[i] = i % 2 ? INFINITY : -INFINITY;
+    }
+    checkSortAll(infinities, "float infinities", false);
+    checkSortAll(std::vector<float>(100, INFINITY), "float infinity", false);
+    std::cout << "Assertion is successful for the edge cases" << std::endl;
+  }
+}
@@ -0,0 +1,232 @@
+#include "helpers.hpp"
+#include "simd.h"
+#include <chrono>
+#include <iostream>
+#include <omp.h>
+#include <random>
+#include <vector>
+
+/*
+"Golden" algorithm to find the sum of the floating vector "arr".
+The sum is accumulated in double, and the sum of the absolute values is
+written to "sumAbs" to scale the error allowed in the SIMD results.
+*/
+double sumGolden(const std::vector<float> &arr, double &sumAbs) {
+  double sum = 0;
+  sumAbs = 0;
+  for (size_t i = 0; i < arr.size(); i++) {
+    sum += arr[i];
+    sumAbs += std::fabs(arr[i]);
+  }
+  return sum;
+}
+
+int64_t sumIntGolden(const std::vector<int> &arr) {
+  int64_t sum = 0;
+  for (size_t i = 0; i < arr.size(); i++) {
+    sum += arr[i];
+  }
+  return sum;
+}
+
+float sumOMP(const std::vector<float> &arr) {
+  float sum = 0;
+  size_t N = arr.size();
+#pragma omp parallel for reduction(+ : sum)
+  for (size_t i = 0; i < N; i++) {
+    sum += arr[i];
+  }
+  return sum;
+}
+
+typedef float (*SumKernel)(float const *, size_t);
+typedef int64_t (*SumIntKernel)(int const *, size_t);
+
+Timer<std::chrono::microseconds> t;
+
+/*
+Runs "kernel" on "arr", prints its time and checks it against "expected".
+The error of a float sum grows with the magnitude of the terms, so it is
+compared against 0.1% of the sum of their absolute values.
+*/
+float checkSum(const std::vector<float> &arr, SumKernel kernel,
+               std::string name, double expected, double sumAbs) {
+  t.start_timer();
+  float actual = kernel(arr.data(), arr.size());
+  t.stop_timer();
+  std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+            << std::endl;
+
+  assertFloat(expected, actual, name, FloatCheck::relative(0, 1e-3 * sumAbs));
+  return actual;
+}
+
+void checkSumInt(const std::vector<int> &arr, SumIntKernel kernel,
+                 std::string name, int64_t expected) {
+  t.start_timer();
+  int64_t actual = kernel(arr.data(), arr.size());
+  t.stop_timer();
+  std::cout << "Elapsed time " << name << " int : " << t.time_elapsed()
+            << std::endl;
+
+  assertInt(expected, actual, name + " int");
+}
+
+// Every reproducible kernel must give the same bits as "reference"
+void checkReproducible(const std::vector<float> &arr, SumKernel kernel,
+                       std::string name, float reference) {
+  float actual = kernel(arr.data(), arr.size());
+  assertFloat(reference, actual, name + " reproducible", FloatCheck::exact());
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    std::cerr << "Usage: ./sum size-exponent" << std::endl;
+    std::cerr << "Size of the array generated will be 2^(size-exponent)"
+              << std::endl;
+    return 1;
+  }
+
+  int exponent = std::atoi(argv[1]);
+  const size_t N = std::pow(2, exponent);
+
+  std::vector<float> arr = generateRandomData<float>(N, -10000.0, 10000.0, 10);
+
+  double expected, sumAbs;
+  {
+    t.start_timer();
+    expected = sumGolden(arr, sumAbs);
+    t.stop_timer();
+    std::cout << "Elapsed time golden : " << t.time_elapsed() << std::endl;
+  }
+
+  {
+    t.start_timer();
+    float actual = sumOMP(arr);
+    t.stop_timer();
+    std::cout << "Elapsed time openmp : " << t.time_elapsed() << std::endl;
+
+    assertFloat(expected, actual, "openmp",
+                FloatCheck::relative(0, 1e-3 * sumAbs));
+    std::cout << "Assertion is successful for openmp" << std::endl;
+  }
+
+  checkSum(arr, sumSSE<>, "SIMD SSE", expected, sumAbs);
+  checkSum(arr, sumSSEOMP<>, "SIMD SSE+openmp", expected, sumAbs);
+#ifdef __AVX2__
+  checkSum(arr, sumAVX2<>, "SIMD AVX", expected, sumAbs);
+  checkSum(arr, sumAVX2OMP<>, "SIMD AVX+openmp", expected, sumAbs);
+#endif
+#ifdef __AVX512F__
+  checkSum(arr, sumAVX512<>, "SIMD AVX512", expected, sumAbs);
+  checkSum(arr, sumAVX512OMP<>, "SIMD AVX512+openmp", expected, sumAbs);
+#endif
+#ifdef SIMD_NEON
+  checkSum(arr, sumNEON<>, "SIMD NEON", expected, sumAbs);
+  checkSum(arr, sumNEONOMP<>, "SIMD NEON+openmp", expected, sumAbs);
+#endif
+  std::cout << "Assertion is successful for the fast sums" << std::endl;
+
+  // Reproducible sums, compared bit for bit across ISAs and thread counts
+  {
+    const SumMode R = SumMode::Reproducible;
+    float reference = checkSum(arr, sumSSE<R>, "SIMD SSE reproducible",
+                               expected, sumAbs);
+    checkSum(arr, sumSSEOMP<R>, "SIMD SSE+openmp reproducible", expected,
+             sumAbs);
+#ifdef __AVX2__
+    checkSum(arr, sumAVX2<R>, "SIMD AVX reproducible", expected, sumAbs);
+    checkSum(arr, sumAVX2OMP<R>, "SIMD AVX+openmp reproducible", expected,
+             sumAbs);
+#endif
+#ifdef __AVX512F__
+    checkSum(arr, sumAVX512<R>, "SIMD AVX512 reproducible", expected, sumAbs);
+    checkSum(arr, sumAVX512OMP<R>, "SIMD AVX512+openmp reproducible",
+             expected, sumAbs);
+#endif
+
+    const int max_threads = omp_get_max_threads();
+    for (int threads : {1, 2, 3, 8, max_threads}) {
+      omp_set_num_threads(threads);
+      std::string suffix = " with " + std::to_string(threads) + " threads";
+
+      checkReproducible(arr, sumSSE<R>, "SSE" + suffix, reference);
+      checkReproducible(arr, sumSSEOMP<R>, "SSEOMP" + suffix, reference);
+#ifdef __AVX2__
+      checkReproducible(arr, sumAVX2<R>, "AVX2" + suffix, reference);
+      checkReproducible(arr, sumAVX2OMP<R>, "AVX2OMP" + suffix, reference);
+#endif
+#ifdef __AVX512F__
+      checkReproducible(arr, sumAVX512<R>, "AVX512" + suffix, reference);
+      checkReproducible(arr, sumAVX512OMP<R>, "AVX512OMP" + suffix,
+                        reference);
+#endif
+#ifdef SIMD_NEON
+      checkReproducible(arr, sumNEON<R>, "NEON" + suffix, reference);
+      checkReproducible(arr, sumNEONOMP<R>, "NEONOMP" + suffix, reference);
+#endif
+      checkReproducible(arr, sumAuto<R>, "auto" + suffix, reference);
+      checkReproducible(arr, sumAutoOMP<R>, "autoOMP" + suffix, reference);
+    }
+    omp_set_num_threads(max_threads);
+    std::cout << "Assertion is successful for the reproducible sums"
+              << std::endl;
+  }
+
+  // int32 sums over the whole int range, which overflow without widening
+  {
+    std::mt19937 gen(10);
+    std::vector<int> arrInt(N);
+    for (size_t i = 0; i < N; i++) {
+      arrInt[i] = static_cast<int>(gen());
+    }
+
+    t.start_timer();
+    int64_t expectedInt = sumIntGolden(arrInt);
+    t.stop_timer();
+    std::cout << "Elapsed time golden int : " << t.time_elapsed()
+              << std::endl;
+
+    checkSumInt(arrInt, sumSSE, "SIMD SSE", expectedInt);
+    checkSumInt(arrInt, sumSSEOMP, "SIMD SSE+openmp", expectedInt);
+#ifdef __AVX2__
+    checkSumInt(arrInt, sumAVX2, "SIMD AVX", expectedInt);
+    checkSumInt(arrInt, sumAVX2OMP, "SIMD AVX+openmp", expectedInt);
+#endif
+#ifdef __AVX512F__
+    checkSumInt(arrInt, sumAVX512, "SIMD AVX512", expectedInt);
+    checkSumInt(arrInt, sumAVX512OMP, "SIMD AVX512+openmp", expectedInt);
+#endif
+#ifdef SIMD_NEON
+    checkSumInt(arrInt, sumNEON, "SIMD NEON", expectedInt);
+    checkSumInt(arrInt, sumNEONOMP, "SIMD NEON+openmp", expectedInt);
+#endif
+    assertFloat(double(expectedInt) / N, meanAuto(arrInt.data(), N),
+                "mean int", FloatCheck::exact());
+    assertFloat(double(expectedInt) / N, meanAutoOMP(arrInt.data(), N),
+                "meanOMP int", FloatCheck::exact());
+    std::cout << "Assertion is successful for the int sums" << std::endl;
+  }
+
+  // The relative check the sums are verified with: an infinity matches only
+  // itself, whatever the tolerance
+  {
+    const float inf = INFINITY;
+    const float expected[] = {inf, inf, -inf, inf, 1.0f, NAN};
+    const float actual[] = {1.0f, -inf, inf, inf, 1.0005f, NAN};
+    const size_t matches[] = {0, 0, 0, 1, 1, 1};
+    for (FloatCheck check : {FloatCheck::relative(1e-3f),
+                             FloatCheck::relative(1e-3f, 1e30f),
+                             FloatCheck::relative(INFINITY)}) {
+      for (size_t i = 0; i < 6; i++) {
+        // One element: 1 when it matches, 0 when it is the mismatch
+        assertInt(matches[i],
+                  findFirstMismatch(expected + i, actual + i, 1, check),
+                  "relative check " + std::to_string(i));
+      }
+    }
+    std::cout << "Assertion is successful for the relative check"
+              << std::endl;
+  }
+}
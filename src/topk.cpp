@@ -0,0 +1,146 @@
+#include "helpers.hpp"
+#include "simd.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+/*
+"Golden" algorithm for top-k: std::nth_element on a copy of "arr" without
+its NaNs, then a sort of the first k elements, best first.
+*/
+template <TopKOrder order, typename T>
+std::vector<T> topKGolden(const std::vector<T> &arr, size_t k) {
+  std::vector<T> copy;
+  copy.reserve(arr.size());
+  std::copy_if(arr.begin(), arr.end(), std::back_inserter(copy),
+               [](T x) { return !std::isnan(x); });
+  k = std::min(k, copy.size());
+
+  auto better = TopKHeap<T, order>::better;
+  std::nth_element(copy.begin(), copy.begin() + k, copy.end(), better);
+  std::sort(copy.begin(), copy.begin() + k, better);
+  copy.resize(k);
+  return copy;
+}
+
+template <typename T>
+using TopKKernel = size_t (*)(T const *, size_t, size_t, T *);
+
+// Selected floats are copies, so they must match bit for bit
+void assertArray(const float *expected, const float *actual, size_t N,
+                 std::string str) {
+  assertArray(expected, actual, N, FloatCheck::exact(), str);
+}
+
+Timer<std::chrono::microseconds> t;
+
+template <typename T>
+void checkTopK(const std::vector<T> &arr, size_t k,
+               const std::vector<T> &expected, TopKKernel<T> kernel,
+               std::string name, bool print_time) {
+  std::vector<T> actual(k);
+
+  t.start_timer();
+  size_t count = kernel(arr.data(), arr.size(), k, actual.data());
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  assertInt(expected.size(), count, "count " + name);
+  assertArray(expected.data(), actual.data(), count, name);
+}
+
+// Checks every top-k kernel for the given order against the golden algorithm
+template <TopKOrder order, typename T>
+void checkTopKAll(const std::vector<T> &arr, size_t k, std::string type,
+                  bool print_time) {
+  std::vector<T> expected = topKGolden<order>(arr, k);
+
+  if (print_time) {
+    t.start_timer();
+    topKGolden<order>(arr, k);
+    t.stop_timer();
+    std::cout << "Elapsed time std::nth_element " << type << " : "
+              << t.time_elapsed() << std::endl;
+  }
+
+  TopKKernel<T> kernels[] = {
+      topKSSE<order>,    topKSSEOMP<order>,
+#ifdef __AVX2__
+      topKAVX2<order>,   topKAVX2OMP<order>,
+#endif
+#ifdef __AVX512F__
+      topKAVX512<order>, topKAVX512OMP<order>,
+#endif
+#ifdef SIMD_NEON
+      topKNEON<order>,   topKNEONOMP<order>,
+#endif
+  };
+  std::string names[] = {
+      "SIMD SSE",    "SIMD SSE+openmp",
+#ifdef __AVX2__
+      "SIMD AVX",    "SIMD AVX+openmp",
+#endif
+#ifdef __AVX512F__
+      "SIMD AVX512", "SIMD AVX512+openmp",
+#endif
+#ifdef SIMD_NEON
+      "SIMD NEON",   "SIMD NEON+openmp",
+#endif
+  };
+
+  for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+    checkTopK(arr, k, expected, kernels[i], names[i] + " " + type,
+              print_time);
+  }
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    std::cerr << "Usage: ./topk size-exponent [k]" << std::endl;
+    std::cerr << "Size of the array generated will be 2^(size-exponent)"
+              << std::endl;
+    return 1;
+  }
+
+  int exponent = std::atoi(argv[1]);
+  const size_t N = std::pow(2, exponent);
+  const size_t k = argc > 2 ? std::atoi(argv[2]) : 64;
+
+  std::vector<float> arr = generateRandomData<float>(N, -10000.0, 10000.0, 10);
+  for (size_t i = 0; i < N; i += 1021) {
+    arr[i] = NAN;
+  }
+  checkTopKAll<TopKOrder::Largest>(arr, k, "largest", true);
+  checkTopKAll<TopKOrder::Smallest>(arr, k, "smallest", true);
+  std::cout << "Assertion is successful for float top-k" << std::endl;
+
+  std::vector<int> arrInt = generateRandomData<int>(N, -10000, 10000, 2);
+  checkTopKAll<TopKOrder::Largest>(arrInt, k, "largest int", true);
+  checkTopKAll<TopKOrder::Smallest>(arrInt, k, "smallest int", true);
+  std::cout << "Assertion is successful for int top-k" << std::endl;
+
+  // k of 0 and 1, more than the array holds, ties, ascending data where
+  // every element beats the threshold, and an array of NaNs
+  {
+    checkTopKAll<TopKOrder::Largest>(arr, 0, "largest", false);
+    checkTopKAll<TopKOrder::Largest>(arr, 1, "largest", false);
+    checkTopKAll<TopKOrder::Largest>(std::vector<float>{3.0f, NAN, -2.0f}, 8,
+                                     "largest", false);
+    checkTopKAll<TopKOrder::Smallest>(std::vector<int>(1000, 7), 5,
+                                      "smallest int", false);
+    std::vector<int> ascending(3 * topKBlock + 37);
+    for (size_t i = 0; i < ascending.size(); i++) {
+      ascending[i] = i;
+    }
+    checkTopKAll<TopKOrder::Largest>(ascending, 64, "largest int", false);
+    checkTopKAll<TopKOrder::Smallest>(std::vector<float>(37, NAN), 4,
+                                      "smallest", false);
+    std::cout << "Assertion is successful for the edge cases" << std::endl;
+  }
+}
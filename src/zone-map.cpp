@@ -0,0 +1,239 @@
+#include "helpers.hpp"
+#include "simd.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+Timer<std::chrono::microseconds> t;
+
+/*
+"Golden" algorithm for the zone map: a scalar min and max per block, NaNs
+skipped, and the empty range [+inf, -inf] for blocks without a number.
+*/
+void zoneMapGolden(const std::vector<float> &arr, size_t block,
+                   std::vector<float> &mins, std::vector<float> &maxs) {
+  size_t blocks = (arr.size() + block - 1) / block;
+  mins.assign(blocks, INFINITY);
+  maxs.assign(blocks, -INFINITY);
+  for (size_t i = 0; i < arr.size(); i++) {
+    if (!std::isnan(arr[i])) {
+      mins[i / block] = std::min(mins[i / block], arr[i]);
+      maxs[i / block] = std::max(maxs[i / block], arr[i]);
+    }
+  }
+}
+
+typedef void (*ZoneMapKernel)(float const *, size_t, float *, float *,
+                              size_t);
+typedef size_t (*ZoneMapQueryKernel)(float const *, float const *, size_t,
+                                     float, float, int *);
+
+struct Range {
+  float lo, hi;
+};
+
+// Runs the build "kernel" and checks every block against the golden one
+void checkZoneMap(const std::vector<float> &arr, size_t block,
+                  ZoneMapKernel kernel, std::string name, bool print_time) {
+  std::vector<float> minsExpected, maxsExpected;
+  zoneMapGolden(arr, block, minsExpected, maxsExpected);
+
+  std::vector<float> mins(minsExpected.size()), maxs(maxsExpected.size());
+  t.start_timer();
+  kernel(arr.data(), arr.size(), mins.data(), maxs.data(), block);
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  // The zone map may hold either zero when a block's min or max is one
+  assertArray(minsExpected.data(), mins.data(), mins.size(),
+              FloatCheck::ulps(0), name + " mins");
+  assertArray(maxsExpected.data(), maxs.data(), maxs.size(),
+              FloatCheck::ulps(0), name + " maxs");
+}
+
+// Runs every query with "kernel" and checks the blocks it returns
+void checkQuery(const std::vector<float> &mins, const std::vector<float> &maxs,
+                const std::vector<Range> &queries,
+                const std::vector<std::vector<int>> &expected,
+                ZoneMapQueryKernel kernel, std::string name,
+                bool print_time) {
+  std::vector<int> out(mins.size());
+  std::vector<std::vector<int>> actual(queries.size());
+  size_t total = 0;
+
+  t.start_timer();
+  for (size_t q = 0; q < queries.size(); q++) {
+    size_t count = kernel(mins.data(), maxs.data(), mins.size(), queries[q].lo,
+                          queries[q].hi, out.data());
+    total += count;
+    if (!print_time) {
+      actual[q].assign(out.begin(), out.begin() + count);
+    }
+  }
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time " << name << " : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  size_t total_expected = 0;
+  for (size_t q = 0; q < queries.size(); q++) {
+    total_expected += expected[q].size();
+    if (!print_time) {
+      std::string query_name = name + " query " + std::to_string(q);
+      assertInt(expected[q].size(), actual[q].size(), query_name + " count");
+      assertArray(expected[q].data(), actual[q].data(), expected[q].size(),
+                  query_name);
+    }
+  }
+  assertInt(total_expected, total, name + " blocks found");
+}
+
+/*
+Builds the zone map of arr with every kernel, then answers the queries with
+every query kernel against a scalar loop over the blocks. Every element of
+[lo, hi] must lie in a block the query returns.
+*/
+void checkZoneMapAll(const std::vector<float> &arr, size_t block,
+                     const std::vector<Range> &queries, bool print_time) {
+  std::vector<float> mins, maxs;
+  if (print_time) {
+    t.start_timer();
+  }
+  zoneMapGolden(arr, block, mins, maxs);
+  if (print_time) {
+    t.stop_timer();
+    std::cout << "Elapsed time golden build : " << t.time_elapsed()
+              << std::endl;
+  }
+
+  checkZoneMap(arr, block, zoneMapSSE, "SIMD SSE build", print_time);
+  checkZoneMap(arr, block, zoneMapSSEOMP, "SIMD SSE+openmp build",
+               print_time);
+#ifdef __AVX2__
+  checkZoneMap(arr, block, zoneMapAVX, "SIMD AVX build", print_time);
+  checkZoneMap(arr, block, zoneMapAVXOMP, "SIMD AVX+openmp build",
+               print_time);
+#endif
+#ifdef __AVX512F__
+  checkZoneMap(arr, block, zoneMapAVX512, "SIMD AVX512 build", print_time);
+  checkZoneMap(arr, block, zoneMapAVX512OMP, "SIMD AVX512+openmp build",
+               print_time);
+#endif
+#ifdef SIMD_NEON
+  checkZoneMap(arr, block, zoneMapNEON, "SIMD NEON build", print_time);
+  checkZoneMap(arr, block, zoneMapNEONOMP, "SIMD NEON+openmp build",
+               print_time);
+#endif
+
+  std::vector<std::vector<int>> expected(queries.size());
+  t.start_timer();
+  for (size_t q = 0; q < queries.size(); q++) {
+    for (size_t b = 0; b < mins.size(); b++) {
+      if (maxs[b] >= queries[q].lo && mins[b] <= queries[q].hi) {
+        expected[q].push_back(b);
+      }
+    }
+  }
+  t.stop_timer();
+  if (print_time) {
+    std::cout << "Elapsed time golden queries : " << t.time_elapsed()
+              << std::endl;
+  } else {
+    for (size_t q = 0; q < queries.size(); q++) {
+      for (size_t i = 0; i < arr.size(); i++) {
+        if (arr[i] >= queries[q].lo && arr[i] <= queries[q].hi) {
+          assertInt(size_t(1),
+                    size_t(std::binary_search(expected[q].begin(),
+                                              expected[q].end(), i / block)),
+                    "block of element " + std::to_string(i));
+        }
+      }
+    }
+  }
+
+  checkQuery(mins, maxs, queries, expected, zoneMapQuerySSE,
+             "SIMD SSE queries", print_time);
+#ifdef __AVX2__
+  checkQuery(mins, maxs, queries, expected, zoneMapQueryAVX,
+             "SIMD AVX queries", print_time);
+#endif
+#ifdef __AVX512F__
+  checkQuery(mins, maxs, queries, expected, zoneMapQueryAVX512,
+             "SIMD AVX512 queries", print_time);
+#endif
+#ifdef SIMD_NEON
+  checkQuery(mins, maxs, queries, expected, zoneMapQueryNEON,
+             "SIMD NEON queries", print_time);
+#endif
+}
+
+// Ranges of random width within [-11000, 11000]
+std::vector<Range> randomRanges(size_t n, uint32_t seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> start(-11000.0f, 11000.0f);
+  std::exponential_distribution<float> width(1.0f / 200.0f);
+  std::vector<Range> ranges(n);
+  for (Range &r : ranges) {
+    r.lo = start(gen);
+    r.hi = r.lo + width(gen);
+  }
+  return ranges;
+}
+
+int main(int argc, char **argv) {
+
+  if (argc < 2) {
+    std::cerr << "Usage: ./zone-map size-exponent" << std::endl;
+    std::cerr << "Size of the array generated will be 2^(size-exponent)"
+              << std::endl;
+    return 1;
+  }
+
+  int exponent = std::atoi(argv[1]);
+  const size_t N = std::pow(2, exponent);
+
+  // A column that grows along the array with some noise, like timestamps or
+  // the keys of data loaded in order, where zone maps skip most blocks
+  std::vector<float> arr = generateRandomData<float>(N, -100.0, 100.0, 10);
+  for (size_t i = 0; i < N; i++) {
+    arr[i] += -10000.0f + 20000.0f * i / N;
+  }
+  for (size_t i = 0; i < N; i += 1021) {
+    arr[i] = NAN;
+  }
+  // One block of NaNs
+  for (size_t i = 2 * zoneMapBlock; i < std::min(N, 3 * zoneMapBlock); i++) {
+    arr[i] = NAN;
+  }
+
+  checkZoneMapAll(arr, zoneMapBlock, randomRanges(10000, 1), true);
+  std::cout << "Assertion is successful for zone maps" << std::endl;
+
+  // Blocks of a few elements, partial last blocks, signed zeros, and empty
+  // and inverted ranges
+  {
+    std::vector<Range> queries = randomRanges(20, 2);
+    queries.push_back({0.0f, 0.0f});
+    queries.push_back({-0.0f, -0.0f});
+    queries.push_back({5.0f, -5.0f});
+    queries.push_back({-INFINITY, INFINITY});
+    std::vector<float> small(arr.begin(), arr.begin() + std::min(N, size_t(300)));
+    for (size_t i = 0; i < small.size(); i += 7) {
+      small[i] = i % 2 ? 0.0f : -0.0f;
+    }
+    for (size_t block : {1, 3, 16, 64, 100}) {
+      for (size_t n : {size_t(0), size_t(1), size_t(37), small.size()}) {
+        n = std::min(n, small.size());
+        checkZoneMapAll(std::vector<float>(small.begin(), small.begin() + n),
+                        block, queries, false);
+      }
+    }
+    std::cout << "Assertion is successful for the edge cases" << std::endl;
+  }
+}